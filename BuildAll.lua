@@ -32,6 +32,7 @@ workspace "VulkanCraft"
         "Engine/EngineDependencies.lua",
         "VulkanCraft/BuildVulkanCraft.lua",
         "VulkanCraft/VulkanCraftDependencies.lua",
+        "VulkanCraftBenchmark/BuildVulkanCraftBenchmark.lua",
 
         -- Dependency Project Build Scripts
         "Engine/Dependencies/glfw-3.4/BuildGLFW.lua",
@@ -56,3 +57,4 @@ group "Dependencies"
 group ""
 include "Engine/BuildEngine.lua"
 include "VulkanCraft/BuildVulkanCraft.lua"
+include "VulkanCraftBenchmark/BuildVulkanCraftBenchmark.lua"
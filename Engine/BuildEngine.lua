@@ -53,6 +53,7 @@ project "Engine"
             "ENG_ENABLE_CONSOLE",
             "ENG_ENABLE_VERIFYS",
             "ENG_ENABLE_ASSERTS",
+            "ENG_ENABLE_PROFILING",
         }
 
         links {
@@ -71,6 +72,7 @@ project "Engine"
             "ENG_CONFIG_RELEASE",
             "ENG_ENABLE_CONSOLE",
             "ENG_ENABLE_VERIFYS",
+            "ENG_ENABLE_PROFILING",
         }
 
         links {
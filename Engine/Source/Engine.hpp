@@ -22,9 +22,12 @@
 #include <Engine/Input/Event/MouseEvents.hpp>
 #include <Engine/Input/Event/WindowEvents.hpp>
 #include <Engine/IO/FileIO.hpp>
+#include <Engine/IO/FileIOService.hpp>
+#include <Engine/IO/MappedFile.hpp>
 #include <Engine/Rendering/BufferUtils.hpp>
 #include <Engine/Rendering/Framebuffer.hpp>
 #include <Engine/Rendering/FramebufferAttachment.hpp>
+#include <Engine/Rendering/GPUProfiler.hpp>
 #include <Engine/Rendering/Image.hpp>
 #include <Engine/Rendering/ImageUtils.hpp>
 #include <Engine/Rendering/IndirectBuffer.hpp>
@@ -38,9 +41,13 @@
 #include <Engine/Rendering/Texture2DArray.hpp>
 #include <Engine/Rendering/UniformBuffer.hpp>
 #include <Engine/Rendering/VertexBuffer.hpp>
+#include <Engine/Threading/BoundedQueue.hpp>
 #include <Engine/Threading/DynamicResource.hpp>
 #include <Engine/Threading/ThreadPool.hpp>
 #include <Engine/Threading/ThreadTracer.hpp>
+#include <Engine/Util/LZ.hpp>
+#include <Engine/Util/Metrics.hpp>
+#include <Engine/Util/Profiler.hpp>
 #include <Engine/Util/Timer.hpp>
 
 // Include glm
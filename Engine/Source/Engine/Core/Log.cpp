@@ -42,4 +42,14 @@ namespace eng
         s_ClientLogger.reset();
         spdlog::shutdown();
     }
+
+    LogScope::LogScope(LogInfo const& info)
+    {
+        Log::Initialize(info);
+    }
+
+    LogScope::~LogScope()
+    {
+        Log::Shutdown();
+    }
 }
@@ -25,9 +25,20 @@ namespace eng
         inline static std::shared_ptr<spdlog::logger> s_ClientLogger;
     private:
         friend int Main(int argc, char** argv);
+        friend class LogScope;
         static void Initialize(LogInfo const& info);
         static void Shutdown();
     };
+
+    // Initializes logging for as long as it's alive.
+    // Only for executables that don't use the engine's entrypoint, e.g. headless tools.
+    class LogScope
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(LogScope);
+    public:
+        LogScope(LogInfo const& info);
+        ~LogScope();
+    };
 }
 
 #if ENG_ENGINE
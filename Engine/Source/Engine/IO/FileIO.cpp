@@ -76,7 +76,7 @@ namespace eng
         }
     }
 
-    bool WriteBinaryFile(path const& filepath, std::vector<u8> const& contents) noexcept
+    bool WriteBinaryFile(path const& filepath, std::span<u8 const> contents) noexcept
     {
         try
         {
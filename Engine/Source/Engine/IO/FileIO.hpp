@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Engine/Core/DataTypes.hpp"
+#include <span>
 #include <vector>
 
 namespace eng
@@ -17,5 +18,5 @@ namespace eng
     bool ReadBinaryFile(path const& filepath, std::vector<u8>& contents) noexcept;
 
     // Writes bytes to a file; returns true if the file was written, or false if not.
-    bool WriteBinaryFile(path const& filepath, std::vector<u8> const& contents) noexcept;
+    bool WriteBinaryFile(path const& filepath, std::span<u8 const> contents) noexcept;
 }
@@ -0,0 +1,195 @@
+#include "FileIOService.hpp"
+#include "Engine/Core/Log.hpp"
+#include "Engine/IO/FileIO.hpp"
+#include "Engine/Util/Profiler.hpp"
+#include <utility>
+
+namespace eng
+{
+    // Buffers given back by FileBuffers, reused by later requests.
+    // Only a few small enough buffers are kept, so one huge file doesn't stay allocated.
+    struct FileBufferPool
+    {
+        static constexpr u64 s_MaxBufferCount = 16;
+        static constexpr u64 s_MaxBufferCapacity = 16 * 1024 * 1024;
+
+        std::mutex Mutex;
+        std::vector<std::vector<u8>> Buffers;
+    };
+
+    FileBuffer& FileBuffer::operator=(FileBuffer&& buffer) noexcept
+    {
+        if (this != std::addressof(buffer))
+        {
+            Release();
+            m_Bytes = std::move(buffer.m_Bytes);
+            m_Pool = std::move(buffer.m_Pool);
+        }
+        return *this;
+    }
+
+    FileBuffer::~FileBuffer()
+    {
+        Release();
+    }
+
+    void FileBuffer::Release() noexcept
+    {
+        if (not m_Pool)
+            return;
+
+        if (m_Bytes.capacity() != 0 and m_Bytes.capacity() <= FileBufferPool::s_MaxBufferCapacity)
+        {
+            m_Bytes.clear();
+            std::unique_lock lock(m_Pool->Mutex);
+            if (m_Pool->Buffers.size() < FileBufferPool::s_MaxBufferCount)
+                m_Pool->Buffers.push_back(std::move(m_Bytes));
+        }
+        m_Bytes = {};
+        m_Pool = nullptr;
+    }
+
+    FileIOService::FileIOService(u8 threadCount)
+        : m_BufferPool(std::make_shared<FileBufferPool>())
+        , m_ThreadPool(threadCount, true)
+    {
+    }
+
+    FileIOService::~FileIOService()
+    {
+        ENG_LOG_TRACE("Finishing {} pending file requests.", m_PendingRequestGauge.Get());
+    }
+
+    FileBuffer FileIOService::AcquireBuffer()
+    {
+        FileBuffer buffer;
+        buffer.m_Pool = m_BufferPool;
+
+        std::unique_lock lock(m_BufferPool->Mutex);
+        if (not m_BufferPool->Buffers.empty())
+        {
+            buffer.m_Bytes = std::move(m_BufferPool->Buffers.back());
+            m_BufferPool->Buffers.pop_back();
+        }
+        return buffer;
+    }
+
+    void FileIOService::ReadFile(path const& filepath, ReadCallback callback)
+    {
+        Submit([this, filepath, callback = std::move(callback)]
+        {
+            ENG_PROFILE_ZONE("FileIOService::ReadFile");
+
+            FileBuffer buffer = AcquireBuffer();
+            if (not ReadBinaryFile(filepath, buffer.GetBytes()))
+                return callback(std::nullopt);
+
+            m_ReadByteCounter.Add(buffer.GetBytes().size());
+            callback(std::move(buffer));
+        });
+    }
+
+    std::future<std::optional<FileBuffer>> FileIOService::ReadFile(path const& filepath)
+    {
+        // std::function needs a copyable callable, so the promise is shared.
+        auto promise = std::make_shared<std::promise<std::optional<FileBuffer>>>();
+        auto future = promise->get_future();
+        ReadFile(filepath, [promise](std::optional<FileBuffer>&& contents) { promise->set_value(std::move(contents)); });
+        return future;
+    }
+
+    void FileIOService::ReadFile(path const& filepath, std::vector<u8>& contents, CompletionCallback callback)
+    {
+        Submit([this, filepath, &contents, callback = std::move(callback)]
+        {
+            ENG_PROFILE_ZONE("FileIOService::ReadFile");
+
+            bool read = ReadBinaryFile(filepath, contents);
+            if (read)
+                m_ReadByteCounter.Add(contents.size());
+            callback(read);
+        });
+    }
+
+    std::future<bool> FileIOService::ReadFile(path const& filepath, std::vector<u8>& contents)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto future = promise->get_future();
+        ReadFile(filepath, contents, [promise](bool read) { promise->set_value(read); });
+        return future;
+    }
+
+    void FileIOService::WriteFile(path const& filepath, FileBuffer&& contents, CompletionCallback callback)
+    {
+        // The buffer is shared so the request stays copyable, and goes back to the pool with the request.
+        auto buffer = std::make_shared<FileBuffer>(std::move(contents));
+        Submit([this, filepath, buffer, callback = std::move(callback)]
+        {
+            ENG_PROFILE_ZONE("FileIOService::WriteFile");
+
+            bool written = WriteBinaryFile(filepath, buffer->GetBytes());
+            if (written)
+                m_WrittenByteCounter.Add(buffer->GetBytes().size());
+            callback(written);
+        });
+    }
+
+    std::future<bool> FileIOService::WriteFile(path const& filepath, FileBuffer&& contents)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto future = promise->get_future();
+        WriteFile(filepath, std::move(contents), [promise](bool written) { promise->set_value(written); });
+        return future;
+    }
+
+    void FileIOService::WriteFile(path const& filepath, std::span<u8 const> contents, CompletionCallback callback)
+    {
+        Submit([this, filepath, contents, callback = std::move(callback)]
+        {
+            ENG_PROFILE_ZONE("FileIOService::WriteFile");
+
+            bool written = WriteBinaryFile(filepath, contents);
+            if (written)
+                m_WrittenByteCounter.Add(contents.size());
+            callback(written);
+        });
+    }
+
+    std::future<bool> FileIOService::WriteFile(path const& filepath, std::span<u8 const> contents)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        auto future = promise->get_future();
+        WriteFile(filepath, contents, [promise](bool written) { promise->set_value(written); });
+        return future;
+    }
+
+    std::shared_ptr<MappedFile const> FileIOService::MapFile(path const& filepath)
+    {
+        ENG_PROFILE_FUNCTION();
+
+        std::unique_lock lock(m_MappedFileMutex);
+
+        auto& weakMapping = m_MappedFiles[filepath];
+        if (auto mapping = weakMapping.lock())
+            return mapping;
+
+        auto mapping = std::make_shared<MappedFile>();
+        if (not mapping->Open(filepath))
+        {
+            m_MappedFiles.erase(filepath);
+            return nullptr;
+        }
+        weakMapping = mapping;
+        return mapping;
+    }
+
+    void FileIOService::Submit(std::function<void()>&& request)
+    {
+        m_PendingRequestGauge.Add(1);
+        m_ThreadPool.SubmitTask([this, request = std::move(request)]
+        {
+            request();
+            m_PendingRequestGauge.Add(-1);
+        });
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Engine/Core/ClassTypes.hpp"
+#include "Engine/Core/DataTypes.hpp"
+#include "Engine/IO/MappedFile.hpp"
+#include "Engine/Threading/ThreadPool.hpp"
+#include "Engine/Util/Metrics.hpp"
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace eng
+{
+    struct FileBufferPool;
+
+    // Bytes from a FileIOService's pool of buffers, given back to the pool when destroyed,
+    // so repeated reads and writes reuse their allocations.
+    class FileBuffer
+    {
+    public:
+        FileBuffer() = default;
+        FileBuffer(FileBuffer&& buffer) noexcept = default;
+        FileBuffer& operator=(FileBuffer&& buffer) noexcept;
+        ~FileBuffer();
+
+        std::vector<u8>& GetBytes() noexcept { return m_Bytes; }
+        std::vector<u8> const& GetBytes() const noexcept { return m_Bytes; }
+    private:
+        friend class FileIOService;
+        void Release() noexcept;
+    private:
+        std::vector<u8> m_Bytes;
+        std::shared_ptr<FileBufferPool> m_Pool;
+    };
+
+    // Reads and writes whole files on a pool of IO threads, so the update and render threads never wait on the disk.
+    // Results are handed back either to a callback, which runs on an IO thread, or through a future.
+    // Large immutable files, e.g. assets, can instead be memory mapped without copying them.
+    // Can be used from any thread.
+    class FileIOService
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(FileIOService);
+    public:
+        using ReadCallback = std::function<void(std::optional<FileBuffer>&& contents)>; // nullopt if the file wasn't read.
+        using CompletionCallback = std::function<void(bool succeeded)>;
+    public:
+        FileIOService(u8 threadCount);
+        // Finishes every queued request.
+        ~FileIOService();
+
+        // Returns an empty buffer from the pool, e.g. to fill and write.
+        ENG_NO_DISCARD FileBuffer AcquireBuffer();
+
+        // Reads a file into a pooled buffer.
+        void ReadFile(path const& filepath, ReadCallback callback);
+        ENG_NO_DISCARD std::future<std::optional<FileBuffer>> ReadFile(path const& filepath);
+        // Reads a file into a caller-provided buffer, which must stay alive until the read completes.
+        // If it wasn't read, contents is unmodified.
+        void ReadFile(path const& filepath, std::vector<u8>& contents, CompletionCallback callback);
+        ENG_NO_DISCARD std::future<bool> ReadFile(path const& filepath, std::vector<u8>& contents);
+
+        // Writes a pooled buffer to a file, giving the buffer back to the pool once written.
+        void WriteFile(path const& filepath, FileBuffer&& contents, CompletionCallback callback);
+        ENG_NO_DISCARD std::future<bool> WriteFile(path const& filepath, FileBuffer&& contents);
+        // Writes caller-provided bytes to a file, which must stay alive until the write completes.
+        void WriteFile(path const& filepath, std::span<u8 const> contents, CompletionCallback callback);
+        ENG_NO_DISCARD std::future<bool> WriteFile(path const& filepath, std::span<u8 const> contents);
+
+        // Maps a file that won't change, sharing the mapping with everyone else who maps it;
+        // returns nullptr if it can't be mapped. Pages are only read when first touched.
+        ENG_NO_DISCARD std::shared_ptr<MappedFile const> MapFile(path const& filepath);
+    private:
+        void Submit(std::function<void()>&& request);
+    private:
+        std::shared_ptr<FileBufferPool> m_BufferPool;
+
+        std::unordered_map<path, std::weak_ptr<MappedFile const>> m_MappedFiles;
+        std::mutex m_MappedFileMutex;
+
+        MetricCounter& m_ReadByteCounter = Metrics::GetCounter("file_io.read_bytes");
+        MetricCounter& m_WrittenByteCounter = Metrics::GetCounter("file_io.written_bytes");
+        MetricGauge& m_PendingRequestGauge = Metrics::GetGauge("file_io.pending_requests");
+
+        // Declared last, so it finishes every request before anything they use is destroyed.
+        ThreadPool m_ThreadPool;
+    };
+}
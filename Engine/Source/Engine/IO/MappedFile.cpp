@@ -0,0 +1,99 @@
+#include "MappedFile.hpp"
+#if ENG_SYSTEM_WINDOWS
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace eng
+{
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    bool MappedFile::Open(path const& filepath) noexcept
+    {
+        Close();
+
+#if ENG_SYSTEM_WINDOWS
+        // Share writes, so the file can still be written while it's mapped.
+        HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize{};
+        if (not GetFileSizeEx(file, &fileSize))
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        // Empty files can't be mapped, but are still open.
+        void* data = nullptr;
+        if (fileSize.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping)
+            {
+                data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                // The view keeps the mapping and file alive.
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+        if (fileSize.QuadPart > 0 and not data)
+            return false;
+
+        m_Data = static_cast<u8 const*>(data);
+        m_Size = u64(fileSize.QuadPart);
+#else
+        int file = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+            return false;
+
+        struct stat fileStat{};
+        if (fstat(file, &fileStat) != 0)
+        {
+            close(file);
+            return false;
+        }
+
+        // Empty files can't be mapped, but are still open.
+        void* data = nullptr;
+        if (fileStat.st_size > 0)
+        {
+            data = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_SHARED, file, 0);
+            if (data == MAP_FAILED)
+                data = nullptr;
+        }
+        // The mapping keeps the file alive.
+        close(file);
+        if (fileStat.st_size > 0 and not data)
+            return false;
+
+        m_Data = static_cast<u8 const*>(data);
+        m_Size = u64(fileStat.st_size);
+#endif
+        m_Open = true;
+        return true;
+    }
+
+    void MappedFile::Close() noexcept
+    {
+        if (m_Data)
+        {
+#if ENG_SYSTEM_WINDOWS
+            UnmapViewOfFile(m_Data);
+#else
+            munmap(const_cast<u8*>(m_Data), m_Size);
+#endif
+        }
+        m_Data = nullptr;
+        m_Size = 0;
+        m_Open = false;
+    }
+}
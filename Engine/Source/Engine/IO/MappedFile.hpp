@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Engine/Core/ClassTypes.hpp"
+#include "Engine/Core/DataTypes.hpp"
+#include <span>
+
+namespace eng
+{
+    // Read-only memory mapping of a whole file.
+    // Pages are read in by the OS on first access, so nothing is copied up front.
+    class MappedFile
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(MappedFile);
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        // Maps a file, unmapping any previous one; returns true if it was mapped, or false if not.
+        // Writes to the file are visible through the mapping, but growth isn't, so reopen it to see appended data.
+        bool Open(path const& filepath) noexcept;
+        void Close() noexcept;
+
+        bool IsOpen() const noexcept { return m_Open; }
+        std::span<u8 const> GetData() const noexcept { return {m_Data, m_Size}; }
+    private:
+        u8 const* m_Data = nullptr;
+        u64 m_Size = 0;
+        bool m_Open = false;
+    };
+}
@@ -1,5 +1,6 @@
 #include "LayerStack.hpp"
 #include "Engine/Core/AssertOrVerify.hpp"
+#include "Engine/Util/Profiler.hpp"
 
 namespace eng::detail
 {
@@ -60,6 +61,7 @@ namespace eng::detail
 
     void LayerStack::OnEvent(Event& event)
     {
+        ENG_PROFILE_ZONE("LayerStack::OnEvent");
         for (auto it = m_Layers.rbegin(); it != m_Layers.rend() and !event.IsHandled(); ++it)
             (*it)->OnEvent(event);
     }
@@ -5,6 +5,8 @@
 #include "Engine/Input/Event/WindowEvents.hpp"
 #include "Engine/Input/Event/MouseEvents.hpp"
 #include "Engine/Input/Event/KeyEvents.hpp"
+#include "Engine/Util/Metrics.hpp"
+#include "Engine/Util/Profiler.hpp"
 #include <glfw/glfw3.h>
 #include <array>
 
@@ -74,15 +76,22 @@ namespace eng
 
     void Window::OnUpdate()
     {
+        ENG_PROFILE_ZONE("Window::OnUpdate");
+
         f64 currentTime = glfwGetTime();
         Timestep timestep = f32(currentTime - m_LastUpdateTime);
         m_LastUpdateTime = currentTime;
 
+        static auto& s_UpdateTime = Metrics::GetHistogram("frame.update_time_us");
+        s_UpdateTime.Record(u64(timestep.Micros()));
+
         m_LayerStack.OnUpdate(timestep);
     }
 
     void Window::OnRender()
     {
+        ENG_PROFILE_ZONE("Window::OnRender");
+
         if (m_Minimized or m_ZeroSize)
             return;
 
@@ -92,6 +101,9 @@ namespace eng
             Timestep timestep = f32(currentTime - m_LastRenderTime);
             m_LastRenderTime = currentTime;
 
+            static auto& s_RenderTime = Metrics::GetHistogram("frame.render_time_us");
+            s_RenderTime.Record(u64(timestep.Micros()));
+
             m_LayerStack.OnRender(timestep);
             m_RenderContext.EndFrame();
         }
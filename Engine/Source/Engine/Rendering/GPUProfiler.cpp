@@ -0,0 +1,166 @@
+#include "GPUProfiler.hpp"
+#include "Engine/Core/Log.hpp"
+#include "Engine/Rendering/RenderContext.hpp"
+#include "Engine/Util/Profiler.hpp"
+#include <array>
+
+namespace eng
+{
+    GPUProfiler::GPUProfiler(RenderContext& context)
+        : m_Context(context)
+    {
+        // Timestamps are only usable if the graphics queue has valid bits and the period is known.
+        u32 count;
+        vkGetPhysicalDeviceQueueFamilyProperties(RenderContext::GetPhysicalDevice(), &count, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(count);
+        vkGetPhysicalDeviceQueueFamilyProperties(RenderContext::GetPhysicalDevice(), &count, queueFamilyProperties.data());
+
+        u32 validBits = queueFamilyProperties[m_Context.GetGraphicsFamily()].timestampValidBits;
+        f32 timestampPeriod = RenderContext::GetPhysicalDeviceProperties().limits.timestampPeriod;
+
+        m_Supported = validBits > 0 and timestampPeriod > 0.0f;
+        if (not m_Supported)
+        {
+            ENG_LOG_WARN("GPU timestamps aren't supported by the graphics queue, GPU profiling is disabled.");
+            return;
+        }
+
+        m_NanosecondsPerTimestamp = f64(timestampPeriod);
+        m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    }
+
+    GPUProfiler::~GPUProfiler()
+    {
+        VkDevice device = m_Context.GetDevice();
+        for (auto& frame : m_Frames)
+            vkDestroyQueryPool(device, frame.QueryPool, nullptr);
+    }
+
+    bool GPUProfiler::IsSupported() const
+    {
+        return m_Supported;
+    }
+
+    u32 GPUProfiler::BeginZone(VkCommandBuffer commandBuffer, string_view name)
+    {
+        if (not m_Supported or m_Frames.empty())
+            return None;
+
+        Frame& frame = m_Frames[m_FrameIndex];
+        if (frame.QueryCount + 2 > s_MaxZoneCount * 2)
+            return None;
+
+        u32 queryIndex = frame.QueryCount;
+        frame.QueryCount += 2;
+        frame.ZoneNames.push_back(name);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.QueryPool, queryIndex);
+        return queryIndex;
+    }
+
+    void GPUProfiler::EndZone(VkCommandBuffer commandBuffer, u32 queryIndex)
+    {
+        if (queryIndex == None)
+            return;
+
+        Frame& frame = m_Frames[m_FrameIndex];
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.QueryPool, queryIndex + 1);
+    }
+
+    auto GPUProfiler::GetResults() const -> std::span<ZoneResult const>
+    {
+        return m_Results;
+    }
+
+    void GPUProfiler::BeginFrame(VkCommandBuffer commandBuffer, u32 frameIndex)
+    {
+        if (not m_Supported)
+            return;
+
+        // Swapchain recreation can add frames in flight.
+        while (m_Frames.size() <= frameIndex)
+        {
+            VkQueryPoolCreateInfo info
+            {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = s_MaxZoneCount * 2,
+            };
+            VkQueryPool queryPool;
+            VkResult result = vkCreateQueryPool(m_Context.GetDevice(), &info, nullptr, &queryPool);
+            ENG_ASSERT(result == VK_SUCCESS, "Failed to create timestamp query pool.");
+            m_Frames.push_back({.QueryPool = queryPool});
+            m_Frames.back().ZoneNames.reserve(s_MaxZoneCount);
+        }
+
+        // This frame's fence has already been waited on, so its previous results are available.
+        if (m_Frames[frameIndex].Pending)
+            ReadResults(frameIndex);
+
+        m_FrameIndex = frameIndex;
+        Frame& frame = m_Frames[frameIndex];
+        frame.QueryCount = 0;
+        frame.ZoneNames.clear();
+        vkCmdResetQueryPool(commandBuffer, frame.QueryPool, 0, s_MaxZoneCount * 2);
+
+        m_FrameZoneQueryIndex = BeginZone(commandBuffer, "Frame");
+    }
+
+    void GPUProfiler::EndFrame(VkCommandBuffer commandBuffer)
+    {
+        if (not m_Supported)
+            return;
+
+        EndZone(commandBuffer, m_FrameZoneQueryIndex);
+        m_FrameZoneQueryIndex = None;
+
+        Frame& frame = m_Frames[m_FrameIndex];
+        frame.Pending = true;
+#if ENG_ENABLE_PROFILING
+        frame.SubmitTicks = Profiler::Now();
+#endif
+    }
+
+    void GPUProfiler::ReadResults(u32 frameIndex)
+    {
+        Frame& frame = m_Frames[frameIndex];
+        frame.Pending = false;
+        if (frame.QueryCount == 0)
+            return;
+
+        std::array<u64, s_MaxZoneCount * 2> timestamps{};
+        VkResult result = vkGetQueryPoolResults(
+            m_Context.GetDevice(), frame.QueryPool, 0, frame.QueryCount,
+            frame.QueryCount * sizeof(u64), timestamps.data(), sizeof(u64),
+            VK_QUERY_RESULT_64_BIT
+        );
+        // Keep the last results rather than showing partial ones.
+        if (result != VK_SUCCESS)
+            return;
+
+        m_Results.clear();
+        for (u32 i = 0; i < frame.QueryCount; i += 2)
+        {
+            u64 begin = timestamps[i] & m_TimestampMask;
+            u64 end = timestamps[i + 1] & m_TimestampMask;
+            // Masking handles the counter wrapping around between the two timestamps.
+            f64 nanoseconds = f64((end - begin) & m_TimestampMask) * m_NanosecondsPerTimestamp;
+            m_Results.push_back({frame.ZoneNames[i / 2], nanoseconds * 1e-6});
+        }
+
+#if ENG_ENABLE_PROFILING
+        // The GPU clock isn't calibrated against the CPU's, so start the
+        // frame where it was submitted. The zones' lengths are exact.
+        f64 ticksPerNanosecond = Profiler::GetTicksPerNanosecond();
+        u64 frameBegin = timestamps[0] & m_TimestampMask;
+        for (u32 i = 0; i < frame.QueryCount; i += 2)
+        {
+            auto toTicks = [&](u64 timestamp)
+            {
+                f64 nanoseconds = f64((timestamp - frameBegin) & m_TimestampMask) * m_NanosecondsPerTimestamp;
+                return frame.SubmitTicks + i64(nanoseconds * ticksPerNanosecond);
+            };
+            Profiler::RecordGPUZone(frame.ZoneNames[i / 2], toTicks(timestamps[i]), toTicks(timestamps[i + 1]));
+        }
+#endif
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Engine/Core/ClassTypes.hpp"
+#include "Engine/Core/DataTypes.hpp"
+#include <vulkan/vulkan.h>
+#include <span>
+#include <vector>
+
+namespace eng
+{
+    class RenderContext;
+
+    // Times scoped zones of a frame's command buffer with timestamp queries.
+    // Each frame in flight has its own query pool, whose results are read back once the
+    // frame's fence has been waited on, so nothing ever stalls on the GPU.
+    // Does nothing on devices without timestamp support.
+    class GPUProfiler
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(GPUProfiler);
+    public:
+        struct ZoneResult
+        {
+            string_view Name;
+            f64 Milliseconds = 0.0;
+        };
+    public:
+        GPUProfiler(RenderContext& context);
+        ~GPUProfiler();
+
+        bool IsSupported() const;
+
+        // Returns the query index to pass to EndZone, or None if the zone won't be timed.
+        // The name isn't copied, so it must be static, e.g. a string literal.
+        u32 BeginZone(VkCommandBuffer commandBuffer, string_view name);
+        void EndZone(VkCommandBuffer commandBuffer, u32 queryIndex);
+
+        // The zones of the most recent frame whose results are available, the whole frame first.
+        // Only valid on the render thread until the next frame begins.
+        std::span<ZoneResult const> GetResults() const;
+    public:
+        inline static constexpr u32 None = ~0u;
+    private:
+        friend class RenderContext;
+
+        void BeginFrame(VkCommandBuffer commandBuffer, u32 frameIndex);
+        void EndFrame(VkCommandBuffer commandBuffer);
+        void ReadResults(u32 frameIndex);
+    private:
+        inline static constexpr u32 s_MaxZoneCount = 32;
+
+        struct Frame
+        {
+            VkQueryPool QueryPool = nullptr;
+            std::vector<string_view> ZoneNames;
+            u32 QueryCount = 0;
+            // Profiler ticks when the frame was submitted, used to line it up with the CPU trace.
+            i64 SubmitTicks = 0;
+            bool Pending = false;
+        };
+    private:
+        RenderContext& m_Context; // non-owning
+        bool m_Supported = false;
+        f64 m_NanosecondsPerTimestamp = 0.0;
+        u64 m_TimestampMask = 0;
+
+        std::vector<Frame> m_Frames;
+        u32 m_FrameIndex = 0;
+        u32 m_FrameZoneQueryIndex = None;
+        std::vector<ZoneResult> m_Results;
+    };
+
+    // Times the rest of the enclosing scope on the GPU.
+    class GPUProfileZone
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(GPUProfileZone);
+    public:
+        GPUProfileZone(GPUProfiler& profiler, VkCommandBuffer commandBuffer, string_view name)
+            : m_Profiler(profiler)
+            , m_CommandBuffer(commandBuffer)
+            , m_QueryIndex(profiler.BeginZone(commandBuffer, name))
+        {
+        }
+
+        ~GPUProfileZone()
+        {
+            m_Profiler.EndZone(m_CommandBuffer, m_QueryIndex);
+        }
+    private:
+        GPUProfiler& m_Profiler; // non-owning
+        VkCommandBuffer m_CommandBuffer;
+        u32 m_QueryIndex;
+    };
+}
+
+#define _ENG_PROFILE_GPU_CONCAT_IMPL(a, b) a##b
+#define _ENG_PROFILE_GPU_CONCAT(a, b) _ENG_PROFILE_GPU_CONCAT_IMPL(a, b)
+
+// Times the rest of the enclosing scope on the GPU under the given static name.
+#define ENG_PROFILE_GPU_ZONE(context, commandBuffer, name) \
+    ::eng::GPUProfileZone _ENG_PROFILE_GPU_CONCAT(_engGPUProfileZone, __LINE__)((context).GetGPUProfiler(), commandBuffer, name)
@@ -34,6 +34,13 @@ namespace eng
         m_Pixels.reset(stbi_load(filepath.string().c_str(), (i32*)&m_Width, (i32*)&m_Height, nullptr, STBI_rgb_alpha));
     }
 
+    LocalTexture::LocalTexture(std::span<u8 const> fileContents)
+        : m_Depth(1)
+    {
+        m_PixelSize = 4; // TODO
+        m_Pixels.reset(stbi_load_from_memory(fileContents.data(), i32(fileContents.size()), (i32*)&m_Width, (i32*)&m_Height, nullptr, STBI_rgb_alpha));
+    }
+
     LocalTexture::LocalTexture(u32 width, u32 height)
         : m_PixelSize(4) // TODO
         , m_Width(width)
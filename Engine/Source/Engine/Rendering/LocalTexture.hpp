@@ -4,6 +4,7 @@
 #include <filesystem>
 #include <memory>
 #include <mdspan>
+#include <span>
 
 namespace eng
 {
@@ -19,6 +20,8 @@ namespace eng
         LocalTexture(LocalTexture&& texture) noexcept;
         LocalTexture& operator=(LocalTexture&& texture) noexcept;
         LocalTexture(path const& filepath);
+        // Decodes an image file that was already read, e.g. by a FileIOService.
+        LocalTexture(std::span<u8 const> fileContents);
         LocalTexture(u32 width, u32 height);
         LocalTexture(u32 width, u32 height, u32 depth);
 
@@ -1,5 +1,7 @@
 #include "RenderContext.hpp"
 #include "Engine/Core/Log.hpp"
+#include "Engine/Rendering/GPUProfiler.hpp"
+#include "Engine/Util/Profiler.hpp"
 #include <glfw/glfw3.h>
 #include <array>
 #include <optional>
@@ -175,6 +177,11 @@ namespace eng
         return m_FrameCommandBuffers[m_FrameIndex];
     }
 
+    GPUProfiler& RenderContext::GetGPUProfiler()
+    {
+        return *m_GPUProfiler;
+    }
+
     VkSurfaceKHR RenderContext::GetSurface() const
     {
         return m_Surface;
@@ -201,11 +208,14 @@ namespace eng
         CreateCommandPool();
         CreateCommandBuffers();
         CreateFencesAndSemaphores();
+
+        m_GPUProfiler = std::make_unique<GPUProfiler>(*this);
     }
 
     RenderContext::~RenderContext()
     {
         m_FrameFreeQueues.clear();
+        m_GPUProfiler.reset();
 
         for (u32 i = 0; i < m_SwapchainImageCount; i++)
         {
@@ -233,6 +243,8 @@ namespace eng
 
     bool RenderContext::BeginFrame()
     {
+        ENG_PROFILE_ZONE("RenderContext::BeginFrame");
+
         // Recreate the swapchain if necessary.
         m_WasSwapchainRecreated = m_RecreateSwapchain;
         if (m_RecreateSwapchain)
@@ -256,6 +268,7 @@ namespace eng
         VkCommandBuffer frameCommandBuffer = m_FrameCommandBuffers[m_FrameIndex];
 
         // Wait for the previous frame using this image to finish rendering.
+        ENG_PROFILE_ZONE("Wait for frame fence");
         result = vkWaitForFences(m_Device, 1, &frameInFlightFence, VK_TRUE, std::numeric_limits<u64>::max());
         ENG_ASSERT(result == VK_SUCCESS, "Failed to wait for frame fence.");
 
@@ -280,11 +293,15 @@ namespace eng
             ENG_ASSERT(result == VK_SUCCESS, "Failed to begin command buffer.");
         }
 
+        m_GPUProfiler->BeginFrame(frameCommandBuffer, m_FrameIndex);
+
         return true;
     }
 
     void RenderContext::EndFrame()
     {
+        ENG_PROFILE_ZONE("RenderContext::EndFrame");
+
         ENG_ASSERT(not m_RecreateSwapchain);
 
         VkSemaphore imageAcquiredSemaphore = m_ImageAcquiredSemaphores[m_SemaphoreIndex];
@@ -292,6 +309,8 @@ namespace eng
         VkFence frameInFlightFence = m_FrameInFlightFences[m_FrameIndex];
         VkCommandBuffer frameCommandBuffer = m_FrameCommandBuffers[m_FrameIndex];
 
+        m_GPUProfiler->EndFrame(frameCommandBuffer);
+
         // End the frame's command buffer and submit it to the graphics queue.
         {
             VkPipelineStageFlags waitMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
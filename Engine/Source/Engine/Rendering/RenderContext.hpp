@@ -5,6 +5,7 @@
 #include "Engine/Core/DataTypes.hpp"
 #include <vulkan/vulkan.h>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #define ENG_GET_FUNC_VK_EXT(name) \
@@ -14,6 +15,8 @@ struct GLFWwindow;
 
 namespace eng
 {
+    class GPUProfiler;
+
     class RenderContext
     {
         ENG_IMMOVABLE_UNCOPYABLE_CLASS(RenderContext);
@@ -52,6 +55,7 @@ namespace eng
         VkFormat GetSwapchainFormat() const;
         bool WasSwapchainRecreated() const;
         VkCommandBuffer GetActiveCommandBuffer() const;
+        GPUProfiler& GetGPUProfiler();
     private:
         friend class Window;
 
@@ -121,6 +125,8 @@ namespace eng
         std::vector<VkSemaphore> m_ImageAcquiredSemaphores;
         std::vector<VkSemaphore> m_RenderCompleteSemaphores;
 
+        std::unique_ptr<GPUProfiler> m_GPUProfiler;
+
         struct FreeRAII
         {
             FreeRAII(std::function<void()>&& freeFunction) : m_FreeFunction(std::move(freeFunction)) {}
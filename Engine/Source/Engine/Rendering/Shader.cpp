@@ -29,7 +29,7 @@ namespace eng
     Shader::Shader(ShaderInfo const& info)
         : m_Context(*info.RenderContext)
     {
-        auto stages = CompileExistingSources(info.Filepath);
+        auto stages = CompileExistingSources(info.Filepath, info.Defines);
         auto pipelineShaderStageInfos = GetPipelineShaderStageInfos(stages);
 
         // Get vertex strides, vertex input attribute descriptions, descriptor set layout bindings, and descriptor pool sizes.
@@ -44,7 +44,7 @@ namespace eng
         CreateDescriptorPool(descriptorPoolSizes);
         CreateDescriptorSets();
         CreatePipelineLayout();
-        CreatePipeline(info.Topology, info.RenderPass, strides, vertexInputBindingDescriptions, vertexInputAttributeDescriptions, pipelineShaderStageInfos);
+        CreatePipeline(info.Topology, info.RenderPass, info.DepthWrite, strides, vertexInputBindingDescriptions, vertexInputAttributeDescriptions, pipelineShaderStageInfos);
 
         // Destroy the temporary modules.
         for (auto& pipelineShaderStageInfo : pipelineShaderStageInfos)
@@ -160,12 +160,14 @@ namespace eng
         vkUpdateDescriptorSets(m_Context.GetDevice(), writeCount, writes.data(), 0, nullptr);
     }
 
-    std::vector<std::tuple<std::vector<u8>, VkShaderStageFlagBits>> Shader::CompileExistingSources(path const& filepath)
+    std::vector<std::tuple<std::vector<u8>, VkShaderStageFlagBits>> Shader::CompileExistingSources(path const& filepath, std::span<ShaderDefine const> defines)
     {
         shaderc::Compiler compiler;
         shaderc::CompileOptions options;
         options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
         options.SetOptimizationLevel(shaderc_optimization_level_performance);
+        for (ShaderDefine const& define : defines)
+            options.AddMacroDefinition(define.Name.data(), define.Name.size(), define.Value.data(), define.Value.size());
 
         return // NOTE: Yes, no semicolon. This is returning the following pipes' results.
 
@@ -484,6 +486,7 @@ namespace eng
     void Shader::CreatePipeline(
         VkPrimitiveTopology topology,
         VkRenderPass renderPass,
+        bool depthWrite,
         std::span<u32> strides,
         std::span<VkVertexInputBindingDescription> vertexInputBindingDescriptions,
         std::span<VkVertexInputAttributeDescription> vertexInputAttributeDescriptions,
@@ -552,7 +555,7 @@ namespace eng
         {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
             .depthTestEnable = VK_TRUE, // TODO: relevant
-            .depthWriteEnable = VK_TRUE, // TODO: relevant
+            .depthWriteEnable = depthWrite ? VK_TRUE : VK_FALSE,
             .depthCompareOp = VK_COMPARE_OP_LESS, // TODO: relevant
             .depthBoundsTestEnable = VK_FALSE, // TODO
             .stencilTestEnable = VK_FALSE, // TODO
@@ -4,6 +4,7 @@
 #include "Engine/Core/DataTypes.hpp"
 #include <vulkan/vulkan.h>
 #include <span>
+#include <string_view>
 #include <vector>
 
 namespace eng
@@ -47,13 +48,22 @@ namespace eng
         std::span<ShaderSamplerBinding> Samplers;
     };
 
+    // A preprocessor macro defined in every stage, so one source can be compiled into variants.
+    struct ShaderDefine
+    {
+        std::string_view Name;
+        std::string_view Value;
+    };
+
     struct ShaderInfo
     {
         RenderContext* RenderContext = nullptr;
         path Filepath;
+        std::span<ShaderDefine const> Defines;
         std::span<ShaderVertexBufferBinding> VertexBufferBindings;
         VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
         VkRenderPass RenderPass = nullptr;
+        bool DepthWrite = true; // Off for blended geometry that shouldn't hide what's drawn behind it later.
     };
 
     // TODO: separate shader from pipeline.
@@ -68,7 +78,7 @@ namespace eng
         void Bind(VkCommandBuffer commandBuffer);
         void UpdateDescriptorSet(ShaderDescriptorSetData const& data);
     private:
-        std::vector<std::tuple<std::vector<u8>, VkShaderStageFlagBits>> CompileExistingSources(path const& filepath);
+        std::vector<std::tuple<std::vector<u8>, VkShaderStageFlagBits>> CompileExistingSources(path const& filepath, std::span<ShaderDefine const> defines);
 
         std::vector<VkPipelineShaderStageCreateInfo> GetPipelineShaderStageInfos(
             std::span<std::tuple<std::vector<u8>, VkShaderStageFlagBits>> stages
@@ -92,6 +102,7 @@ namespace eng
         void CreatePipeline(
             VkPrimitiveTopology topology,
             VkRenderPass renderPass,
+            bool depthWrite,
             std::span<u32> strides,
             std::span<VkVertexInputBindingDescription> vertexInputBindingDescriptions,
             std::span<VkVertexInputAttributeDescription> vertexInputAttributeDescriptions,
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Engine/Core/Attributes.hpp"
+#include "Engine/Core/ClassTypes.hpp"
+#include "Engine/Core/DataTypes.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+
+namespace eng
+{
+    // Fixed capacity lock-free queue that any number of threads can push to and pop from.
+    // Pushing to a full queue or popping from an empty one fails instead of waiting, so
+    // callers decide how to apply back-pressure.
+    template <typename T>
+    class BoundedQueue
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(BoundedQueue);
+    public:
+        // The capacity is rounded up to a power of two.
+        explicit BoundedQueue(u64 capacity)
+            : m_Slots(std::make_unique<Slot[]>(std::bit_ceil(std::max<u64>(capacity, 2))))
+            , m_Mask(std::bit_ceil(std::max<u64>(capacity, 2)) - 1)
+        {
+            for (u64 i = 0; i <= m_Mask; i++)
+                m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+
+        // Returns false, leaving the value untouched, if the queue is full.
+        ENG_NO_DISCARD bool TryPush(T&& value)
+        {
+            u64 position = m_Tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Slot& slot = m_Slots[position & m_Mask];
+                u64 sequence = slot.Sequence.load(std::memory_order_acquire);
+                i64 difference = i64(sequence - position);
+                if (difference == 0)
+                {
+                    // The slot is free; claim it unless another producer got there first.
+                    if (m_Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        slot.Value = std::move(value);
+                        slot.Sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false;
+                else
+                    position = m_Tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Returns false if the queue is empty.
+        ENG_NO_DISCARD bool TryPop(T& value)
+        {
+            u64 position = m_Head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Slot& slot = m_Slots[position & m_Mask];
+                u64 sequence = slot.Sequence.load(std::memory_order_acquire);
+                i64 difference = i64(sequence - (position + 1));
+                if (difference == 0)
+                {
+                    // The slot is filled; claim it unless another consumer got there first.
+                    if (m_Head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        value = std::move(slot.Value);
+                        slot.Value = T{}; // Don't hold on to what was moved from until the slot is reused.
+                        slot.Sequence.store(position + m_Mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false;
+                else
+                    position = m_Head.load(std::memory_order_relaxed);
+            }
+        }
+
+        ENG_NO_DISCARD u64 Capacity() const noexcept { return m_Mask + 1; }
+    private:
+        struct Slot
+        {
+            // Equals the position a producer can fill the slot at, or one past the position a consumer can empty it at.
+            std::atomic<u64> Sequence;
+            T Value;
+        };
+    private:
+        std::unique_ptr<Slot[]> m_Slots;
+        u64 m_Mask;
+        // Kept on separate cache lines, so producers and consumers don't contend.
+        alignas(64) std::atomic<u64> m_Head = 0; // Next position to pop.
+        alignas(64) std::atomic<u64> m_Tail = 0; // Next position to push.
+    };
+}
@@ -20,6 +20,9 @@ namespace eng
 
         m_Running.store(false, std::memory_order_relaxed);
         m_TaskAvailable.notify_all();
+
+        // Join here, while the tasks and their mutex are still alive.
+        m_Threads.clear();
     }
 
     void ThreadPool::SubmitTask(std::function<void()>&& task)
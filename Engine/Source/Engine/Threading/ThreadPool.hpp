@@ -3,6 +3,7 @@
 #include "Engine/Core/DataTypes.hpp"
 #include "Engine/Core/ClassTypes.hpp"
 #include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <functional>
 #include <mutex>
@@ -1,5 +1,6 @@
 #include "ThreadTracer.hpp"
 #include "Engine/Core/Log.hpp"
+#include "Engine/Util/Profiler.hpp"
 
 namespace eng
 {
@@ -8,6 +9,7 @@ namespace eng
         , m_TID(std::this_thread::get_id())
     {
         ENG_LOG_TRACE("Starting {} thread with tid={}.", m_Name, m_TID._Get_underlying_id());
+        ENG_PROFILE_THREAD(m_Name);
     }
 
     ThreadTracer::~ThreadTracer()
@@ -0,0 +1,147 @@
+#include "LZ.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace eng
+{
+    static constexpr u64 s_MinMatchLength = 4;
+    static constexpr u64 s_MaxMatchOffset = u16(-1);
+    static constexpr u32 s_HashBits = 12;
+
+    static u32 Load32(u8 const* data) noexcept
+    {
+        u32 value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    static u32 Hash(u32 sequence) noexcept
+    {
+        return (sequence * 2654435761u) >> (32 - s_HashBits);
+    }
+
+    // Lengths past the 15 that fit in a nibble are continued in bytes.
+    static void WriteLength(std::vector<u8>& output, u64 length)
+    {
+        for (; length >= 255; length -= 255)
+            output.push_back(255);
+        output.push_back(u8(length));
+    }
+
+    static bool ReadLength(u8 const*& in, u8 const* inEnd, u64& length) noexcept
+    {
+        u8 byte;
+        do
+        {
+            if (in == inEnd)
+                return false;
+            byte = *in++;
+            length += byte;
+        }
+        while (byte == 255);
+        return true;
+    }
+
+    static void WriteSequence(std::vector<u8>& output, std::span<u8 const> literals, u64 matchOffset, u64 matchLength)
+    {
+        u64 literalCount = literals.size();
+        u64 matchLengthCode = matchLength ? matchLength - s_MinMatchLength : 0;
+        output.push_back(u8(std::min<u64>(literalCount, 15) << 4 | std::min<u64>(matchLengthCode, 15)));
+        if (literalCount >= 15)
+            WriteLength(output, literalCount - 15);
+        output.insert(output.end(), literals.begin(), literals.end());
+
+        // The last sequence has no match.
+        if (not matchLength)
+            return;
+        output.push_back(u8(matchOffset));
+        output.push_back(u8(matchOffset >> 8));
+        if (matchLengthCode >= 15)
+            WriteLength(output, matchLengthCode - 15);
+    }
+
+    void LZ::Compress(std::span<u8 const> input, std::vector<u8>& output)
+    {
+        // Positions + 1 of the last time each hashed 4 bytes were seen, or 0 if never.
+        std::array<u32, 1 << s_HashBits> positions{};
+
+        u8 const* data = input.data();
+        u64 size = input.size();
+        u64 literalStart = 0;
+        u64 i = 0;
+        while (i + s_MinMatchLength <= size)
+        {
+            u32 sequence = Load32(data + i);
+            u32& position = positions[Hash(sequence)];
+            u64 candidate = u64(position) - 1;
+            bool found = position != 0 and i - candidate <= s_MaxMatchOffset and Load32(data + candidate) == sequence;
+            position = u32(i + 1);
+            if (not found)
+            {
+                i++;
+                continue;
+            }
+
+            u64 matchLength = s_MinMatchLength;
+            while (i + matchLength < size and data[candidate + matchLength] == data[i + matchLength])
+                matchLength++;
+
+            WriteSequence(output, input.subspan(literalStart, i - literalStart), i - candidate, matchLength);
+            i += matchLength;
+            literalStart = i;
+        }
+
+        if (literalStart < size or size == 0)
+            WriteSequence(output, input.subspan(literalStart), 0, 0);
+    }
+
+    bool LZ::Decompress(std::span<u8 const> input, std::span<u8> output) noexcept
+    {
+        u8 const* in = input.data();
+        u8 const* inEnd = in + input.size();
+        u8* outBegin = output.data();
+        u8* out = outBegin;
+        u8* outEnd = out + output.size();
+
+        while (in < inEnd)
+        {
+            u8 token = *in++;
+
+            u64 literalCount = token >> 4;
+            if (literalCount == 15 and not ReadLength(in, inEnd, literalCount))
+                return false;
+            if (literalCount > u64(inEnd - in) or literalCount > u64(outEnd - out))
+                return false;
+            std::memcpy(out, in, literalCount);
+            in += literalCount;
+            out += literalCount;
+
+            // Only the last sequence ends after its literals.
+            if (in == inEnd)
+                break;
+
+            if (inEnd - in < 2)
+                return false;
+            u64 matchOffset = u64(in[0]) | u64(in[1]) << 8;
+            in += 2;
+            u64 matchLength = (token & 15) + s_MinMatchLength;
+            if ((token & 15) == 15 and not ReadLength(in, inEnd, matchLength))
+                return false;
+            if (matchOffset == 0 or matchOffset > u64(out - outBegin) or matchLength > u64(outEnd - out))
+                return false;
+
+            // Matches that overlap what they copy repeat it, so they're copied in steps that
+            // double as the repeated part grows, and never overlap themselves.
+            u8 const* match = out - matchOffset;
+            for (u8* matchEnd = out + matchLength; out < matchEnd;)
+            {
+                u64 step = std::min<u64>(matchEnd - out, out - match);
+                std::memcpy(out, match, step);
+                out += step;
+            }
+        }
+
+        return out == outEnd;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Engine/Core/Attributes.hpp"
+#include "Engine/Core/ClassTypes.hpp"
+#include "Engine/Core/DataTypes.hpp"
+#include <span>
+#include <vector>
+
+namespace eng
+{
+    // Byte-oriented LZ77 compression in the style of LZ4, tuned for decompression speed over ratio.
+    //
+    // The compressed data is a list of sequences, each a token, literals, and a match:
+    //  u8 Token                    High nibble is the literal count, low nibble the match length - 4.
+    //  u8 LiteralCount[]           If the literal count nibble is 15, bytes added to it until one isn't 255.
+    //  u8 Literals[LiteralCount]
+    //  u16 MatchOffset             How far back the match starts in the decompressed data. Omitted by the last sequence.
+    //  u8 MatchLength[]            If the match length nibble is 15, bytes added to it until one isn't 255.
+    class LZ
+    {
+        ENG_STATIC_CLASS(LZ);
+    public:
+        // Appends the compressed input to output.
+        static void Compress(std::span<u8 const> input, std::vector<u8>& output);
+
+        // Decompresses input into output, which must be exactly the decompressed size.
+        // Returns true if input decompressed into exactly all of output, or false if input is invalid.
+        ENG_NO_DISCARD static bool Decompress(std::span<u8 const> input, std::span<u8> output) noexcept;
+    };
+}
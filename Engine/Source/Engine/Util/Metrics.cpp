@@ -0,0 +1,205 @@
+#include "Metrics.hpp"
+#include "Engine/Core/Log.hpp"
+#include "Engine/IO/FileIO.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eng
+{
+    MetricCounter::MetricCounter(small_string_view name)
+        : m_Name(name)
+    {
+    }
+
+    MetricGauge::MetricGauge(small_string_view name)
+        : m_Name(name)
+    {
+    }
+
+    MetricHistogram::MetricHistogram(small_string_view name)
+        : m_Name(name)
+    {
+    }
+
+    u64 MetricHistogram::Snapshot::Percentile(f64 fraction) const noexcept
+    {
+        if (Count == 0)
+            return 0;
+
+        u64 rank = std::max(u64(std::ceil(std::clamp(fraction, 0.0, 1.0) * f64(Count))), u64(1));
+        u64 seen = 0;
+        for (u32 i = 0; i < s_BucketCount; i++)
+        {
+            seen += Buckets[i];
+            if (seen >= rank)
+                return GetBucketValue(i);
+        }
+        return Max();
+    }
+
+    u64 MetricHistogram::Snapshot::Max() const noexcept
+    {
+        for (u32 i = s_BucketCount; i-- > 0;)
+            if (Buckets[i])
+                return GetBucketValue(i);
+        return 0;
+    }
+
+    f64 MetricHistogram::Snapshot::Mean() const noexcept
+    {
+        return Count ? f64(Sum) / f64(Count) : 0.0;
+    }
+
+    MetricHistogram::Snapshot MetricHistogram::Snapshot::operator-(Snapshot const& older) const noexcept
+    {
+        Snapshot difference;
+        for (u32 i = 0; i < s_BucketCount; i++)
+            difference.Buckets[i] = Buckets[i] - older.Buckets[i];
+        difference.Count = Count - older.Count;
+        difference.Sum = Sum - older.Sum;
+        return difference;
+    }
+
+    MetricHistogram::Snapshot MetricHistogram::TakeSnapshot() const noexcept
+    {
+        // Buckets are read one by one while other threads record, so the snapshot is only
+        // approximately consistent, which is fine for statistics.
+        Snapshot snapshot;
+        for (u32 i = 0; i < s_BucketCount; i++)
+        {
+            snapshot.Buckets[i] = m_Buckets[i].load(std::memory_order_relaxed);
+            snapshot.Count += snapshot.Buckets[i];
+        }
+        snapshot.Sum = m_Sum.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    // Registered metrics, with what they were at the last sample.
+    struct RegisteredCounter
+    {
+        std::unique_ptr<MetricCounter> Counter;
+        u64 SampledValue = 0;
+    };
+    struct RegisteredHistogram
+    {
+        std::unique_ptr<MetricHistogram> Histogram;
+        MetricHistogram::Snapshot SampledSnapshot;
+    };
+
+    static std::vector<RegisteredCounter> s_Counters;
+    static std::vector<std::unique_ptr<MetricGauge>> s_Gauges;
+    static std::vector<RegisteredHistogram> s_Histograms;
+    static std::mutex s_MetricMutex;
+
+    // Sampling state, only used from the sampling thread.
+    // History is trimmed by half when full, so long sessions keep their most recent samples.
+    static constexpr u64 s_MaxHistorySize = 1 << 21;
+    static std::vector<MetricSample> s_History;
+    static std::vector<MetricSample> s_LatestSamples;
+    static auto const s_StartTime = std::chrono::steady_clock::now();
+    static f64 s_LastSampleTime = 0.0;
+
+    template <typename T>
+    static T& FindOrRegister(std::vector<T>& metrics, small_string_view name, auto getMetric)
+    {
+        for (auto& metric : metrics)
+            if (getMetric(metric)->GetName() == name)
+                return metric;
+        return metrics.emplace_back();
+    }
+
+    MetricCounter& Metrics::GetCounter(small_string_view name)
+    {
+        std::unique_lock lock(s_MetricMutex);
+        auto& registered = FindOrRegister(s_Counters, name, [](RegisteredCounter const& r) { return r.Counter.get(); });
+        if (not registered.Counter)
+            registered.Counter = std::make_unique<MetricCounter>(name);
+        return *registered.Counter;
+    }
+
+    MetricGauge& Metrics::GetGauge(small_string_view name)
+    {
+        std::unique_lock lock(s_MetricMutex);
+        auto& gauge = FindOrRegister(s_Gauges, name, [](std::unique_ptr<MetricGauge> const& g) { return g.get(); });
+        if (not gauge)
+            gauge = std::make_unique<MetricGauge>(name);
+        return *gauge;
+    }
+
+    MetricHistogram& Metrics::GetHistogram(small_string_view name)
+    {
+        std::unique_lock lock(s_MetricMutex);
+        auto& registered = FindOrRegister(s_Histograms, name, [](RegisteredHistogram const& r) { return r.Histogram.get(); });
+        if (not registered.Histogram)
+            registered.Histogram = std::make_unique<MetricHistogram>(name);
+        return *registered.Histogram;
+    }
+
+    void Metrics::Sample()
+    {
+        f64 time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - s_StartTime).count();
+        f64 elapsed = time - s_LastSampleTime;
+        s_LastSampleTime = time;
+
+        s_LatestSamples.clear();
+        {
+            std::unique_lock lock(s_MetricMutex);
+
+            for (auto& registered : s_Counters)
+            {
+                u64 value = registered.Counter->Get();
+                f64 rate = elapsed > 0.0 ? f64(value - registered.SampledValue) / elapsed : 0.0;
+                registered.SampledValue = value;
+                s_LatestSamples.push_back({time, registered.Counter->GetName(), "total", f64(value)});
+                s_LatestSamples.push_back({time, registered.Counter->GetName(), "per_second", rate});
+            }
+
+            for (auto& gauge : s_Gauges)
+                s_LatestSamples.push_back({time, gauge->GetName(), "value", f64(gauge->Get())});
+
+            for (auto& registered : s_Histograms)
+            {
+                auto snapshot = registered.Histogram->TakeSnapshot();
+                auto interval = snapshot - registered.SampledSnapshot;
+                registered.SampledSnapshot = snapshot;
+
+                small_string_view name = registered.Histogram->GetName();
+                s_LatestSamples.push_back({time, name, "count", f64(interval.Count)});
+                s_LatestSamples.push_back({time, name, "mean", interval.Mean()});
+                s_LatestSamples.push_back({time, name, "p50", f64(interval.Percentile(0.50))});
+                s_LatestSamples.push_back({time, name, "p90", f64(interval.Percentile(0.90))});
+                s_LatestSamples.push_back({time, name, "p99", f64(interval.Percentile(0.99))});
+                s_LatestSamples.push_back({time, name, "max", f64(interval.Max())});
+            }
+        }
+
+        if (s_History.size() + s_LatestSamples.size() > s_MaxHistorySize)
+            s_History.erase(s_History.begin(), s_History.begin() + s_History.size() / 2);
+        s_History.insert(s_History.end(), s_LatestSamples.begin(), s_LatestSamples.end());
+    }
+
+    std::span<MetricSample const> Metrics::GetLatestSamples() noexcept
+    {
+        return s_LatestSamples;
+    }
+
+    void Metrics::FormatCSV(string& csv)
+    {
+        csv = "time,metric,statistic,value\n";
+        csv.reserve(csv.size() + s_History.size() * 64);
+        for (auto& sample : s_History)
+            fmt::format_to(std::back_inserter(csv), "{:.3f},{},{},{}\n", sample.Time, sample.Name, sample.Statistic, sample.Value);
+    }
+
+    bool Metrics::WriteCSV(path const& filepath)
+    {
+        string csv;
+        FormatCSV(csv);
+        return WriteFile(filepath, csv);
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Engine/Core/Attributes.hpp"
+#include "Engine/Core/ClassTypes.hpp"
+#include "Engine/Core/DataTypes.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <span>
+
+namespace eng
+{
+    // A monotonically increasing count, e.g. bytes uploaded.
+    class MetricCounter
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(MetricCounter);
+    public:
+        MetricCounter(small_string_view name);
+
+        void Add(u64 value = 1) noexcept { m_Value.fetch_add(value, std::memory_order_relaxed); }
+        u64 Get() const noexcept { return m_Value.load(std::memory_order_relaxed); }
+
+        small_string const& GetName() const noexcept { return m_Name; }
+    private:
+        small_string m_Name;
+        std::atomic<u64> m_Value = 0;
+    };
+
+    // A value that is overwritten, e.g. a queue depth.
+    class MetricGauge
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(MetricGauge);
+    public:
+        MetricGauge(small_string_view name);
+
+        void Set(i64 value) noexcept { m_Value.store(value, std::memory_order_relaxed); }
+        void Add(i64 value) noexcept { m_Value.fetch_add(value, std::memory_order_relaxed); }
+        i64 Get() const noexcept { return m_Value.load(std::memory_order_relaxed); }
+
+        small_string const& GetName() const noexcept { return m_Name; }
+    private:
+        small_string m_Name;
+        std::atomic<i64> m_Value = 0;
+    };
+
+    // A distribution of values, e.g. frame times in microseconds.
+    // Values are counted in log-linear buckets with 8 sub-buckets per power of two, so
+    // percentiles are accurate to within 12.5%.
+    class MetricHistogram
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(MetricHistogram);
+    public:
+        static constexpr u32 s_SubBucketBits = 3;
+        static constexpr u32 s_SubBucketCount = 1 << s_SubBucketBits;
+        // Values below this get a bucket each.
+        static constexpr u32 s_LinearBucketCount = 2 * s_SubBucketCount;
+        static constexpr u32 s_BucketCount = s_LinearBucketCount + (64 - (s_SubBucketBits + 1)) * s_SubBucketCount;
+
+        // Copy of the buckets at a point in time.
+        // Subtracting an older snapshot gives the distribution of the values recorded in between.
+        struct Snapshot
+        {
+            std::array<u64, s_BucketCount> Buckets{};
+            u64 Count = 0;
+            u64 Sum = 0;
+
+            // Returns the approximate value below which the given fraction of values are, or 0 if empty.
+            ENG_NO_DISCARD u64 Percentile(f64 fraction) const noexcept;
+            // Returns the approximate largest value, or 0 if empty.
+            ENG_NO_DISCARD u64 Max() const noexcept;
+            ENG_NO_DISCARD f64 Mean() const noexcept;
+
+            ENG_NO_DISCARD Snapshot operator-(Snapshot const& older) const noexcept;
+        };
+    public:
+        MetricHistogram(small_string_view name);
+
+        void Record(u64 value) noexcept
+        {
+            m_Buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            m_Sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        ENG_NO_DISCARD Snapshot TakeSnapshot() const noexcept;
+
+        small_string const& GetName() const noexcept { return m_Name; }
+
+        static constexpr u32 GetBucketIndex(u64 value) noexcept
+        {
+            if (value < s_LinearBucketCount)
+                return u32(value);
+            u32 exponent = u32(std::bit_width(value)) - 1;
+            u32 subBucket = u32(value >> (exponent - s_SubBucketBits)) & (s_SubBucketCount - 1);
+            return s_LinearBucketCount + (exponent - (s_SubBucketBits + 1)) * s_SubBucketCount + subBucket;
+        }
+        // Returns the largest value that lands in the bucket.
+        static constexpr u64 GetBucketValue(u32 index) noexcept
+        {
+            if (index < s_LinearBucketCount)
+                return index;
+            u32 exponent = (index - s_LinearBucketCount) / s_SubBucketCount + (s_SubBucketBits + 1);
+            u64 subBucket = (index - s_LinearBucketCount) % s_SubBucketCount;
+            u64 lowest = (u64(1) << exponent) | (subBucket << (exponent - s_SubBucketBits));
+            return lowest + ((u64(1) << (exponent - s_SubBucketBits)) - 1);
+        }
+    private:
+        small_string m_Name;
+        std::array<std::atomic<u64>, s_BucketCount> m_Buckets{};
+        std::atomic<u64> m_Sum = 0;
+    };
+
+    struct MetricSample
+    {
+        f64 Time;                    // Seconds since the program started.
+        small_string_view Name;      // Name of the metric.
+        small_string_view Statistic; // Which statistic of the metric, e.g. "value" or "p99".
+        f64 Value;
+    };
+
+    // Registry of named metrics.
+    // Registering takes a lock, but the returned references are stable for the lifetime of
+    // the program and are updated lock-free from any thread, so cache them, e.g. in a static.
+    class Metrics
+    {
+        ENG_STATIC_CLASS(Metrics);
+    public:
+        // Returns the metric with the given name, registering it on first use.
+        static MetricCounter& GetCounter(small_string_view name);
+        static MetricGauge& GetGauge(small_string_view name);
+        static MetricHistogram& GetHistogram(small_string_view name);
+
+        // Samples every metric and appends the samples to the history. Counters are sampled as
+        // their total and rate, and histograms over the values recorded since the last sample.
+        // Sampling, the latest samples, and writing are only to be used from one thread.
+        static void Sample();
+        static std::span<MetricSample const> GetLatestSamples() noexcept;
+
+        // Formats the sampled history as CSV with a row per sample, replacing csv's contents.
+        static void FormatCSV(string& csv);
+        // Writes the sampled history as CSV; returns true if the file was written, or false if not.
+        static bool WriteCSV(path const& filepath);
+    };
+}
@@ -0,0 +1,173 @@
+#include "Profiler.hpp"
+
+#if ENG_ENABLE_PROFILING
+    #include "Engine/Core/Attributes.hpp"
+    #include "Engine/Core/Log.hpp"
+    #include "Engine/IO/FileIO.hpp"
+    #include <algorithm>
+    #include <atomic>
+    #include <iterator>
+    #include <memory>
+    #include <mutex>
+    #include <span>
+    #include <vector>
+
+namespace eng
+{
+    struct ProfiledZone
+    {
+        string_view Name;
+        i64 Begin;
+        i64 End;
+    };
+
+    // Only ever written by its own thread, and only ever read by exports.
+    struct ProfilerThreadBuffer
+    {
+        // Must be a power of two.
+        static constexpr u64 Capacity = 1 << 15;
+
+        small_string Name; // Guarded by s_ThreadBufferMutex.
+        u32 ThreadIndex = 0;
+        std::unique_ptr<ProfiledZone[]> Events = std::make_unique<ProfiledZone[]>(Capacity);
+        std::atomic<u64> WriteIndex = 0;
+    };
+
+    // Buffers outlive their threads so exports still include threads that have exited.
+    static std::vector<std::unique_ptr<ProfilerThreadBuffer>> s_ThreadBuffers;
+    static std::mutex s_ThreadBufferMutex;
+    static thread_local ProfilerThreadBuffer* s_ThreadBuffer = nullptr;
+    // The GPU gets its own track, since it doesn't belong to any one thread.
+    static ProfilerThreadBuffer* s_GPUBuffer = nullptr;
+
+    // Taken together so ticks can be converted to time.
+    static i64 const s_EpochTicks = Profiler::Now();
+    static auto const s_EpochTime = std::chrono::steady_clock::now();
+
+    static ProfilerThreadBuffer* CreateThreadBuffer()
+    {
+        std::unique_lock lock(s_ThreadBufferMutex);
+        auto& threadBuffer = s_ThreadBuffers.emplace_back(std::make_unique<ProfilerThreadBuffer>());
+        threadBuffer->ThreadIndex = u32(s_ThreadBuffers.size());
+        threadBuffer->Name = fmt::format("thread {}", threadBuffer->ThreadIndex);
+        return threadBuffer.get();
+    }
+
+    static ProfilerThreadBuffer& GetThreadBuffer()
+    {
+        if (not s_ThreadBuffer) ENG_UNLIKELY
+            s_ThreadBuffer = CreateThreadBuffer();
+        return *s_ThreadBuffer;
+    }
+
+    static void WriteZone(ProfilerThreadBuffer& threadBuffer, string_view name, i64 begin, i64 end)
+    {
+        u64 writeIndex = threadBuffer.WriteIndex.load(std::memory_order_relaxed);
+        threadBuffer.Events[writeIndex & (ProfilerThreadBuffer::Capacity - 1)] = {name, begin, end};
+        threadBuffer.WriteIndex.store(writeIndex + 1, std::memory_order_release);
+    }
+
+    static void AppendJsonString(string& json, string_view text)
+    {
+        json += '"';
+        for (char c : text)
+        {
+            if (c == '"' or c == '\\')
+                json += '\\';
+            json += c;
+        }
+        json += '"';
+    }
+
+    void Profiler::SetThreadName(small_string_view name)
+    {
+        ProfilerThreadBuffer& threadBuffer = GetThreadBuffer();
+        std::unique_lock lock(s_ThreadBufferMutex);
+        threadBuffer.Name = name;
+    }
+
+    void Profiler::RecordZone(string_view name, i64 begin, i64 end) noexcept
+    {
+        WriteZone(GetThreadBuffer(), name, begin, end);
+    }
+
+    void Profiler::RecordGPUZone(string_view name, i64 begin, i64 end) noexcept
+    {
+        if (not s_GPUBuffer) ENG_UNLIKELY
+        {
+            s_GPUBuffer = CreateThreadBuffer();
+            std::unique_lock lock(s_ThreadBufferMutex);
+            s_GPUBuffer->Name = "gpu";
+        }
+        WriteZone(*s_GPUBuffer, name, begin, end);
+    }
+
+    f64 Profiler::GetTicksPerNanosecond() noexcept
+    {
+        f64 elapsedNanoseconds = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - s_EpochTime).count();
+        return f64(std::max<i64>(Now() - s_EpochTicks, 1)) / std::max(elapsedNanoseconds, 1.0);
+    }
+
+    bool Profiler::WriteChromeTrace(path const& filepath)
+    {
+        // Measure the tick rate over the whole time the profiler has been running.
+        f64 microsecondsPerTick = 1e-3 / GetTicksPerNanosecond();
+        auto toMicroseconds = [microsecondsPerTick](i64 ticks) { return f64(ticks - s_EpochTicks) * microsecondsPerTick; };
+
+        string json;
+        json.reserve(1 << 20);
+        json += "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+        auto out = std::back_inserter(json);
+
+        u64 zoneCount = 0;
+        {
+            std::unique_lock lock(s_ThreadBufferMutex);
+            for (auto& threadBuffer : s_ThreadBuffers)
+            {
+                fmt::format_to(out, "{{\"ph\": \"M\", \"pid\": 0, \"tid\": {}, \"name\": \"thread_name\", \"args\": {{\"name\": ", threadBuffer->ThreadIndex);
+                AppendJsonString(json, threadBuffer->Name);
+                json += "}},\n";
+
+                // Copy out the zones the thread can't be overwriting, then drop any that
+                // were overwritten while copying. The thread keeps recording meanwhile.
+                u64 endIndex = threadBuffer->WriteIndex.load(std::memory_order_acquire);
+                u64 beginIndex = endIndex - std::min(endIndex, ProfilerThreadBuffer::Capacity);
+                std::vector<ProfiledZone> events;
+                events.reserve(endIndex - beginIndex);
+                for (u64 i = beginIndex; i < endIndex; i++)
+                    events.push_back(threadBuffer->Events[i & (ProfilerThreadBuffer::Capacity - 1)]);
+
+                // Keep the copies above from being reordered past the second load. The zone at the
+                // write index may be half written, and it shares its slot with the one a capacity before it.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                u64 overwrittenIndex = threadBuffer->WriteIndex.load(std::memory_order_acquire);
+                u64 validBeginIndex = overwrittenIndex + 1 - std::min(overwrittenIndex + 1, ProfilerThreadBuffer::Capacity);
+                u64 skipCount = std::min(events.size(), validBeginIndex > beginIndex ? validBeginIndex - beginIndex : 0);
+
+                for (auto& event : std::span(events).subspan(skipCount))
+                {
+                    json += "{\"ph\": \"X\", \"pid\": 0, ";
+                    fmt::format_to(out, "\"tid\": {}, \"ts\": {:.3f}, \"dur\": {:.3f}, \"name\": ",
+                        threadBuffer->ThreadIndex, toMicroseconds(event.Begin), f64(event.End - event.Begin) * microsecondsPerTick);
+                    AppendJsonString(json, event.Name);
+                    json += "},\n";
+                    zoneCount++;
+                }
+            }
+        }
+
+        // Remove the trailing comma.
+        if (json.ends_with(",\n"))
+            json.erase(json.size() - 2, 1);
+        json += "]}\n";
+
+        if (not WriteFile(filepath, json))
+        {
+            ENG_LOG_ERROR("Failed to write profiler trace to \"{}\".", filepath.string());
+            return false;
+        }
+        ENG_LOG_INFO("Wrote {} profiler zones to \"{}\".", zoneCount, filepath.string());
+        return true;
+    }
+}
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+
+#if ENG_ENABLE_PROFILING
+    #include "Engine/Core/ClassTypes.hpp"
+    #include "Engine/Core/DataTypes.hpp"
+    #include <chrono>
+    #if defined(_M_X64) or defined(__x86_64__)
+        #define _ENG_PROFILE_USE_TSC 1
+        #if ENG_SYSTEM_WINDOWS
+            #include <intrin.h>
+        #else
+            #include <x86intrin.h>
+        #endif
+    #endif
+
+namespace eng
+{
+    // Low overhead scoped-zone CPU profiler.
+    // Each thread records its finished zones into its own lock-free ring buffer, which only
+    // keeps the most recent zones. Zones nest by time, so no explicit parent is tracked.
+    class Profiler
+    {
+        ENG_STATIC_CLASS(Profiler);
+    public:
+        // Names the calling thread in exported traces.
+        static void SetThreadName(small_string_view name);
+
+        // Writes every thread's recorded zones as Chrome trace event json, which can be
+        // opened in chrome://tracing or ui.perfetto.dev. Can be called from any thread.
+        static bool WriteChromeTrace(path const& filepath);
+
+        // Records a zone on the GPU track, in ticks from Now(). Only call from one thread at a time.
+        static void RecordGPUZone(string_view name, i64 begin, i64 end) noexcept;
+        // Measures the rate of Now() against the system clock.
+        static f64 GetTicksPerNanosecond() noexcept;
+
+        // Reads the time stamp counter where available, since it's several times cheaper than
+        // the system clock. Ticks are calibrated against the system clock when exporting.
+        static i64 Now() noexcept
+        {
+    #if _ENG_PROFILE_USE_TSC
+            return i64(__rdtsc());
+    #else
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+    #endif
+        }
+    private:
+        friend class ProfileZone;
+
+        static void RecordZone(string_view name, i64 begin, i64 end) noexcept;
+    };
+
+    class ProfileZone
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(ProfileZone);
+    public:
+        // The name isn't copied, so it must outlive the profiler, e.g. a string literal.
+        ProfileZone(string_view name) noexcept
+            : m_Name(name)
+            , m_Begin(Profiler::Now())
+        {
+        }
+
+        ~ProfileZone() noexcept
+        {
+            Profiler::RecordZone(m_Name, m_Begin, Profiler::Now());
+        }
+    private:
+        string_view m_Name;
+        i64 m_Begin;
+    };
+}
+
+    #define _ENG_PROFILE_CONCAT_IMPL(a, b) a##b
+    #define _ENG_PROFILE_CONCAT(a, b) _ENG_PROFILE_CONCAT_IMPL(a, b)
+
+    // Profiles the rest of the enclosing scope under the given static name.
+    #define ENG_PROFILE_ZONE(name) ::eng::ProfileZone _ENG_PROFILE_CONCAT(_engProfileZone, __LINE__)(name)
+    #define ENG_PROFILE_FUNCTION() ENG_PROFILE_ZONE(__func__)
+    #define ENG_PROFILE_THREAD(name) ::eng::Profiler::SetThreadName(name)
+#else
+    #define ENG_PROFILE_ZONE(name) static_cast<void>(0)
+    #define ENG_PROFILE_FUNCTION() static_cast<void>(0)
+    #define ENG_PROFILE_THREAD(name) static_cast<void>(0)
+#endif
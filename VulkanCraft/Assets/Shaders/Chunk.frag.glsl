@@ -27,8 +27,11 @@ vec3 CalculateTexCoord() {
 
 void main() {
     const vec4 color = texture(BlockTextureAtlas, CalculateTexCoord());
+#ifdef VC_ALPHA_TEST
+    // Only the cutout pass discards, since discarding at all turns off early depth testing.
     if (color.a == 0)
         discard;
+#endif
 
     o_Color = color;
 }
@@ -1,7 +1,9 @@
 #version 460 core
 #extension GL_KHR_vulkan_glsl : enable
 
+#ifndef VC_VERTEX_PULLING
 layout(location = 0) in uvec2 i_PackedFaceData;
+#endif
 
 layout(location = 0) out vec2 o_TexCoord;
 layout(location = 1) out flat vec2 o_TexTopLeft;
@@ -23,32 +25,41 @@ layout(std430, binding = 1) readonly buffer _ChunkData {
     uvec2 PackedChunkData[];
 } ChunkData;
 
+#ifdef VC_VERTEX_PULLING
+// Quad data; storage buffer; the whole vertex buffer, with 4 vertices per quad under the shared quad index buffer.
+layout(std430, binding = 3) readonly buffer _QuadData {
+    uvec2 PackedFaceData[];
+} QuadData;
+#endif
+
 // Unpacking data.
 
 void UnpackFaceData(
     const uvec2 packedFaceData,
     out uvec3 localPosition,    // 0..15
     out uvec2 size,             // 1..16
-    out uint textureID          // only 16 bits
+    out uint textureID,         // only 16 bits
+    out ivec3 chunkOffset       // 0..3, in the super chunk
 ) {
     //                   packedFaceData.y                 packedFaceData.x
     // 64  60  56  52  48  44  40  36  32   28  24  20  16  12   8   4   0
-    //   ----------------------------hhhh wwwwzzzzyyyyxxxxtttttttttttttttt
-    // t = texture id, x = local x, y = local y, z = local z, w = width, h = height
+    //   ----------------------cccccchhhh wwwwzzzzyyyyxxxxtttttttttttttttt
+    // t = texture id, x = local x, y = local y, z = local z, w = width, h = height, c = chunk offset
     localPosition = 0xF & uvec3(packedFaceData.x >> 16, packedFaceData.x >> 20, packedFaceData.x >> 24);
     size = 1 + (0xF & uvec2(packedFaceData.x >> 28, packedFaceData.y));
     textureID = 0xFFFF & packedFaceData.x;
+    chunkOffset = ivec3(0x3 & uvec3(packedFaceData.y >> 4, packedFaceData.y >> 6, packedFaceData.y >> 8));
 }
 
 void UnpackChunkData(
     const uvec2 packedChunkData,
-    out ivec3 chunkPosition, // only 16 bits (per channel)
+    out ivec3 chunkPosition, // only 16 bits (per channel), the super chunk's origin
     out uint face            // 0, 1, 2, 3, 4, 5 => left(-x), right(+x), bottom(-y), top(+y), back(-z), front(+z)
 ) {
     //                  packedChunkData.y                packedChunkData.x
     // 64  60  56  52  48  44  40  36  32   28  24  20  16  12   8   4   0
     //   -------------fffzzzzzzzzzzzzzzzz yyyyyyyyyyyyyyyyxxxxxxxxxxxxxxxx
-    // x = chunk x, y = chunk y, z = chunk z, f = face
+    // x = super chunk origin x, y = super chunk origin y, z = super chunk origin z, f = face
     chunkPosition = ivec3(packedChunkData.x, packedChunkData.x >> 16, packedChunkData.y) << 16 >> 16;
     face = 0x7 & (packedChunkData.y >> 16);
 }
@@ -117,10 +128,17 @@ void main() {
     uvec3 localPosition;
     uvec2 size;
     uint textureID;
+    ivec3 chunkOffset;
     ivec3 chunkPosition;
     uint face;
 
-    UnpackFaceData(i_PackedFaceData, localPosition, size, textureID);
+#ifdef VC_VERTEX_PULLING
+    const uvec2 packedFaceData = QuadData.PackedFaceData[gl_VertexIndex >> 2];
+#else
+    const uvec2 packedFaceData = i_PackedFaceData;
+#endif
+
+    UnpackFaceData(packedFaceData, localPosition, size, textureID, chunkOffset);
     UnpackChunkData(ChunkData.PackedChunkData[gl_DrawID], chunkPosition, face);
 
     // Calculate texture coordinates based on the textureID.
@@ -138,9 +156,13 @@ void main() {
     const uvec3 size3 = sizes[face >> 1]; // left/right = 0, bottom/top = 1, back/front = 2
 
     // Index into the instance data.
+#ifdef VC_VERTEX_PULLING
+    const uint index = gl_VertexIndex & 3;
+#else
     const uint index = s_InstanceIndices[gl_VertexIndex];
+#endif
 
-    const vec3 position = s_InstancePositions[face][index] * size3 + vec3(localPosition) + chunkPosition * 16;
+    const vec3 position = s_InstancePositions[face][index] * size3 + vec3(localPosition) + (chunkPosition + chunkOffset) * 16;
     const vec2 texCoord = s_InstanceTexCoords[index] * size;
     const vec2 texTopLeft = vec2(textureX, textureY) * FrameData.BlockTextureAtlas.TextureScale;
     const float texLayer = float(textureZ);
@@ -59,6 +59,7 @@ project "VulkanCraft"
             "ENG_ENABLE_CONSOLE",
             "ENG_ENABLE_VERIFYS",
             "ENG_ENABLE_ASSERTS",
+            "ENG_ENABLE_PROFILING",
         }
 
     filter "configurations:Release"
@@ -71,6 +72,7 @@ project "VulkanCraft"
             "ENG_CONFIG_RELEASE",
             "ENG_ENABLE_CONSOLE",
             "ENG_ENABLE_VERIFYS",
+            "ENG_ENABLE_PROFILING",
         }
 
     filter "configurations:Dist"
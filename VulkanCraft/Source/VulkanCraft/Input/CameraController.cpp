@@ -12,6 +12,11 @@ namespace vc
         return m_Projection * m_View;
     }
 
+    vec3 CameraController::GetPosition() const
+    {
+        return m_Position;
+    }
+
     void CameraController::SetPosition(vec3 position)
     {
         m_Position = position;
@@ -11,6 +11,7 @@ namespace vc
     {
     public:
         mat4 GetViewProjection();
+        vec3 GetPosition() const;
 
         void SetPosition(vec3 position);
         void SetRotation(vec3 rotation);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "VulkanCraft/Rendering/RenderLayer.hpp"
 #include "VulkanCraft/Rendering/TextureID.hpp"
 
 namespace vc
@@ -7,6 +8,7 @@ namespace vc
     struct BlockModel
     {
         u8 SolidBits = 0;
+        RenderLayer Layer = RenderLayer::Opaque;
         TextureID Left{};
         TextureID Right{};
         TextureID Bottom{};
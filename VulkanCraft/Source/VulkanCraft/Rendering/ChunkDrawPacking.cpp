@@ -0,0 +1,25 @@
+#include "ChunkDrawPacking.hpp"
+
+namespace vc
+{
+    void ChunkDrawPacking::PackStorageData(std::span<ChunkSubmeshRegion const> regions, std::span<uvec2> storageData)
+    {
+        ENG_ASSERT(storageData.size() >= regions.size());
+        for (u64 i = 0; i < regions.size(); i++)
+            storageData[i] = PackStorageData(regions[i].ChunkPos, regions[i].Type);
+    }
+
+    void ChunkDrawPacking::PackIndirectData(std::span<ChunkSubmeshRegion const> regions, std::span<VkDrawIndirectCommand> indirectData)
+    {
+        ENG_ASSERT(indirectData.size() >= regions.size());
+        for (u64 i = 0; i < regions.size(); i++)
+            indirectData[i] = {6, regions[i].InstanceCount, 0, regions[i].FirstInstance};
+    }
+
+    void ChunkDrawPacking::PackIndexedIndirectData(std::span<ChunkSubmeshRegion const> regions, std::span<VkDrawIndexedIndirectCommand> indirectData)
+    {
+        ENG_ASSERT(indirectData.size() >= regions.size());
+        for (u64 i = 0; i < regions.size(); i++)
+            indirectData[i] = {regions[i].InstanceCount * 6, 1, 0, i32(regions[i].FirstInstance * 4), 0};
+    }
+}
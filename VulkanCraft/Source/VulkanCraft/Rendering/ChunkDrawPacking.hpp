@@ -0,0 +1,71 @@
+#pragma once
+
+#include "VulkanCraft/Rendering/MeshType.hpp"
+#include "VulkanCraft/Rendering/RenderLayer.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+#include <span>
+
+using namespace eng;
+
+namespace vc
+{
+    // A contiguous range of the vertex buffer holding one submesh of every chunk in a super chunk.
+    struct ChunkSubmeshRegion
+    {
+        ChunkPos ChunkPos; // The super chunk's origin.
+        u32 FirstInstance;
+        u32 InstanceCount; // Up to SuperChunkSize^3 chunks' worth, so doesn't fit in 16 bits.
+        MeshType Type;
+        u8 Lod = 0; // Only the super chunk's selected level of detail is drawn.
+        RenderLayer Layer = RenderLayer::Opaque; // Each layer is drawn in its own pass.
+        bool Removing = false;
+    };
+
+    // Packs per-draw data for the chunk shader, one element per region.
+    class ChunkDrawPacking
+    {
+        ENG_STATIC_CLASS(ChunkDrawPacking);
+    public:
+        // Chunks are drawn in cubes of this many chunks per axis, so each face direction of a cube is one draw.
+        inline static constexpr i32 SuperChunkSize = 4;
+
+        static constexpr ChunkPos GetSuperChunkOrigin(ChunkPos chunkPos)
+        {
+            return chunkPos & ~(SuperChunkSize - 1);
+        }
+
+        // The chunk's offset in its super chunk, to be OR'd into bits 4-9 of each of its packed quads' y.
+        // See ChunkMesher::PackQuad.
+        static constexpr u32 PackSuperChunkOffset(ChunkPos chunkPos)
+        {
+            ChunkPos offset = chunkPos & (SuperChunkSize - 1);
+            return u32(offset.z << 4 | offset.y << 2 | offset.x) << 4;
+        }
+
+        // The index of a packed quad's chunk in its super chunk, i.e. PackSuperChunkOffset >> 4.
+        static constexpr u32 GetSuperChunkIndex(uvec2 quad)
+        {
+            return quad.y >> 4 & 0x3F;
+        }
+
+        //                  packedChunkData.y                packedChunkData.x
+        // 64  60  56  52  48  44  40  36  32   28  24  20  16  12   8   4   0
+        //   -------------fffzzzzzzzzzzzzzzzz yyyyyyyyyyyyyyyyxxxxxxxxxxxxxxxx
+        // x = super chunk origin x, y = super chunk origin y, z = super chunk origin z, f = face
+        static constexpr uvec2 PackStorageData(ChunkPos chunkPos, MeshType type)
+        {
+            return
+            {
+                u32(chunkPos.y & 0xFFFF) << 16 | u32(chunkPos.x & 0xFFFF),
+                /* extra 13 bits */ u32(type.Index()) << 16 | u32(chunkPos.z & 0xFFFF),
+            };
+        }
+
+        // Both outputs must have room for every region. They may point straight into mapped memory.
+        static void PackStorageData(std::span<ChunkSubmeshRegion const> regions, std::span<uvec2> storageData);
+        static void PackIndirectData(std::span<ChunkSubmeshRegion const> regions, std::span<VkDrawIndirectCommand> indirectData);
+        // For vertex pulling, where each quad is 4 vertices of the shared quad index buffer.
+        static void PackIndexedIndirectData(std::span<ChunkSubmeshRegion const> regions, std::span<VkDrawIndexedIndirectCommand> indirectData);
+    };
+}
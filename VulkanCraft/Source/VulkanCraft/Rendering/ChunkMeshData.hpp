@@ -1,6 +1,10 @@
 #pragma once
 
+#include "VulkanCraft/Rendering/MeshType.hpp"
+#include "VulkanCraft/Rendering/RenderLayer.hpp"
 #include "VulkanCraft/World/ChunkPos.hpp"
+#include <array>
+#include <span>
 #include <vector>
 
 using namespace eng;
@@ -9,12 +13,29 @@ namespace vc
 {
     struct ChunkMeshData
     {
+        // Levels of detail, each merging twice as many blocks along every axis as the last: 1x, 2x, 4x and 8x.
+        inline static constexpr u8 LodCount = 4;
+
+        // One per render layer, level of detail and MeshType.
+        inline static constexpr u32 SubmeshCount = RenderLayer::_Count * LodCount * MeshType::_Count;
+
         ChunkPos ChunkPos;
-        std::vector<uvec2> Left;
-        std::vector<uvec2> Right;
-        std::vector<uvec2> Bottom;
-        std::vector<uvec2> Top;
-        std::vector<uvec2> Back;
-        std::vector<uvec2> Front;
+        u64 Version = 0; // The remesh this mesh is from, or 0 if from generation.
+        // Every packed quad in one buffer, grouped by render layer, then level of detail, then MeshType in order,
+        // so it can be uploaded in one copy.
+        std::vector<uvec2> Quads;
+        // Where each submesh's quads start in Quads, followed by the total quad count.
+        std::array<u32, SubmeshCount + 1> FaceOffsets{};
+
+        static constexpr u32 GetSubmesh(MeshType type, u8 lod, RenderLayer layer)
+        {
+            return (layer.Index() * LodCount + lod) * MeshType::_Count + type.Index();
+        }
+
+        std::span<uvec2 const> GetQuads(MeshType type, u8 lod = 0, RenderLayer layer = RenderLayer::Opaque) const
+        {
+            u32 index = GetSubmesh(type, lod, layer);
+            return std::span(Quads).subspan(FaceOffsets[index], FaceOffsets[index + 1] - FaceOffsets[index]);
+        }
     };
 }
@@ -16,9 +16,5 @@ namespace vc
         Top,
         Back,
         Front,
-
-        //Opaque, // e.g. flowers/crops/fire.
-
-        //Translucent, // e.g. tinted glass
     );
 }
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Engine.hpp>
+
+using namespace eng;
+
+namespace vc
+{
+    // Which pass a block model's faces are drawn in, in draw order.
+    ENG_DEFINE_BOUNDED_ENUM(
+        RenderLayer, u8,
+
+        Opaque,      // Every texel is drawn, so nothing is discarded and early depth testing stays on.
+        Cutout,      // e.g. leaves, texels with no alpha are discarded.
+        Translucent, // e.g. ice, blended over what's behind, back to front.
+    );
+}
@@ -1,12 +1,79 @@
 #include "WorldRenderer.hpp"
 #include "VulkanCraft/World/World.hpp"
-#include "VulkanCraft/World/ChunkGenerator.hpp"
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <span>
+#include <tuple>
 
 namespace vc
 {
-    WorldRenderer::WorldRenderer(RenderContext& context, VkRenderPass renderPass, u16 maxChunkCount)
+    // Radius of the sphere around a chunk, used to tell if any of it is in view.
+    static constexpr f32 s_ChunkBoundingRadius = f32(Chunk::Size) * 0.8660254f; // sqrt(3) / 2
+
+    // Distances from the camera, in chunks, from which each level of detail is drawn. A chunk has to move
+    // past a distance by the hysteresis to change level, so chunks near one don't flicker between levels.
+    static constexpr auto s_LodDistances = std::to_array<f32>({0.0f, 6.0f, 12.0f, 24.0f});
+    static_assert(s_LodDistances.size() == ChunkMeshData::LodCount);
+    static constexpr f32 s_LodHysteresis = 0.5f;
+
+    static u8 SelectLod(f32 distance, u8 lod)
+    {
+        while (lod + 1 < ChunkMeshData::LodCount and distance > s_LodDistances[lod + 1] + s_LodHysteresis)
+            lod++;
+        while (lod > 0 and distance < s_LodDistances[lod] - s_LodHysteresis)
+            lod--;
+        return lod;
+    }
+
+    // Most quads a region can hold: one face direction of a whole super chunk, each chunk's at
+    // most a checkerboard of half its blocks. The shared quad index buffer covers this many.
+    static constexpr u32 s_MaxRegionQuadCount = ChunkDrawPacking::SuperChunkSize * ChunkDrawPacking::SuperChunkSize * ChunkDrawPacking::SuperChunkSize * Chunk::Size3 / 2;
+
+    static VkDeviceSize GetMeshVertexSize(ChunkMeshData const& chunkMeshData)
+    {
+        return chunkMeshData.Quads.size() * sizeof(uvec2); // sizeof vertex
+    }
+
+    // The center of a packed quad, in blocks from its super chunk's origin, placed like the chunk vertex shader does.
+    static vec3 GetQuadCenter(uvec2 quad, u32 face)
+    {
+        vec3 localPosition = vec3(uvec3(quad.x >> 16, quad.x >> 20, quad.x >> 24) & 0xFu);
+        vec2 size = vec2(1u + (uvec2(quad.x >> 28, quad.y) & 0xFu));
+        vec3 chunkOffset = vec3(uvec3(quad.y >> 4, quad.y >> 6, quad.y >> 8) & 0x3u);
+
+        // Half the quad along its plane, and a whole block along its normal for faces on the positive side.
+        f32 normalOffset = f32(face & 1);
+        vec3 extent;
+        switch (face >> 1)
+        {
+            case 0:  extent = vec3(normalOffset, size.y * 0.5f, size.x * 0.5f); break; // left/right
+            case 1:  extent = vec3(size.x * 0.5f, normalOffset, size.y * 0.5f); break; // bottom/top
+            default: extent = vec3(size.x * 0.5f, size.y * 0.5f, normalOffset); break; // back/front
+        }
+        return localPosition + extent + chunkOffset * f32(Chunk::Size);
+    }
+
+    // Sorts each translucent submesh's quads from furthest to nearest, so they blend over each other in order.
+    static void SortTranslucentQuads(ChunkPos origin, std::span<uvec2> quads, std::span<u32 const> submeshOffsets, vec3 cameraPosition)
+    {
+        vec3 camera = cameraPosition - vec3(origin) * f32(Chunk::Size);
+        for (u32 submesh = 0; submesh + 1 < submeshOffsets.size(); submesh++)
+        {
+            u32 face = submesh % MeshType::_Count;
+            auto submeshQuads = quads.subspan(submeshOffsets[submesh], submeshOffsets[submesh + 1] - submeshOffsets[submesh]);
+            std::ranges::sort(submeshQuads, std::ranges::greater(), [face, camera](uvec2 quad)
+            {
+                vec3 offset = GetQuadCenter(quad, face) - camera;
+                return glm::dot(offset, offset);
+            });
+        }
+    }
+
+    WorldRenderer::WorldRenderer(RenderContext& context, FileIOService& fileIO, VkRenderPass renderPass, u16 maxChunkCount, ChunkMeshUploadBudget uploadBudget)
         : m_Context(context)
         , m_RenderPass(renderPass)
+        , m_UploadBudget(uploadBudget)
     {
         ReloadShaders();
 
@@ -14,13 +81,29 @@ namespace vc
         // TODO: dynamic loading via block model files
         {
 #define VC_TEXTURE(x) R"(D:\Dorkspace\Programming\Archive\VanillaDefault-Resource-Pack-16x-1.21\assets\minecraft\textures\)" x
+            // Read every texture at once, then decode them as they arrive.
+            std::array textureFiles = {
+                fileIO.ReadFile(VC_TEXTURE("block/bedrock.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/stone.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/dirt.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/grass_block_side.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/grass_block_top.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/cobblestone.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/oak_log.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/oak_log_top.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/oak_leaves.png")),
+                fileIO.ReadFile(VC_TEXTURE("block/ice.png")),
+            };
             std::vector<LocalTexture> textures;
-            textures.reserve(5);
-            textures.emplace_back(VC_TEXTURE("block/bedrock.png"));
-            textures.emplace_back(VC_TEXTURE("block/stone.png"));
-            textures.emplace_back(VC_TEXTURE("block/dirt.png"));
-            textures.emplace_back(VC_TEXTURE("block/grass_block_side.png"));
-            textures.emplace_back(VC_TEXTURE("block/grass_block_top.png"));
+            textures.reserve(textureFiles.size());
+            for (auto& textureFile : textureFiles)
+            {
+                // A texture that wasn't read decodes to no pixels, like one that failed to decode.
+                std::optional<FileBuffer> contents = textureFile.get();
+                if (not contents)
+                    ENG_LOG_ERROR("Failed to read a block texture.");
+                textures.emplace_back(contents ? std::span<u8 const>(contents->GetBytes()) : std::span<u8 const>());
+            }
             m_BlockTextureAtlas = std::make_unique<TextureAtlas>(m_Context, 16, textures);
         }
 
@@ -36,12 +119,17 @@ namespace vc
 
         // chunks * blocks/chunk * faces/block * bytes/face
         VkDeviceSize vertexBufferSize = maxChunkCount * (Chunk::Size3 * 6 * sizeof(uvec2));
+        m_VertexBufferSize = vertexBufferSize;
+        m_VertexPullingSupported = vertexBufferSize <= m_Context.GetPhysicalDeviceProperties().limits.maxStorageBufferRange;
         // Use the same struct layout as the GPU will have and simply use sizeof.
         VkDeviceSize uniformBufferSize = sizeof(LocalUniformBuffer);
-        // chunks * faces/chunk * bytes/face
-        VkDeviceSize storageBufferSize = maxChunkCount * (6 * sizeof(uvec2));
-        // chunks * faces/chunk * bytes/face
-        VkDeviceSize indirectBufferSize = maxChunkCount * (6 * sizeof(VkDrawIndirectCommand));
+        // chunks * layers/chunk * faces/layer * bytes/face, with room to align each layer's start.
+        VkDeviceSize storageBufferSize = maxChunkCount * (RenderLayer::_Count * 6 * sizeof(uvec2))
+            + RenderLayer::_Count * m_Context.GetPhysicalDeviceProperties().limits.minStorageBufferOffsetAlignment;
+        // chunks * layers/chunk * faces/layer * bytes/face, sized for whichever draw command is larger so either path fits.
+        VkDeviceSize indirectBufferSize = maxChunkCount * (RenderLayer::_Count * 6 * std::max(sizeof(VkDrawIndirectCommand), sizeof(VkDrawIndexedIndirectCommand)));
+        // quads * indices/quad * bytes/index
+        VkDeviceSize quadIndexBufferSize = s_MaxRegionQuadCount * (6 * sizeof(u32));
 
         // Create vertex buffer and get its memory requirements.
         VkMemoryRequirements vertexMemoryRequirements;
@@ -50,13 +138,29 @@ namespace vc
             {
                 .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
                 .size = vertexBufferSize,
-                .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                // Also a transfer source, since super chunks are repacked by copying within it,
+                // and a storage buffer for vertex pulling.
+                .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             };
             VkResult result = vkCreateBuffer(device, &info, nullptr, &m_VertexBuffer);
             ENG_ASSERT(result == VK_SUCCESS, "Failed to create vertex buffer.");
             vkGetBufferMemoryRequirements(device, m_VertexBuffer, &vertexMemoryRequirements);
         }
 
+        // Create the quad index buffer and get its memory requirements.
+        VkMemoryRequirements quadIndexMemoryRequirements;
+        {
+            VkBufferCreateInfo info
+            {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .size = quadIndexBufferSize,
+                .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            };
+            VkResult result = vkCreateBuffer(device, &info, nullptr, &m_QuadIndexBuffer);
+            ENG_ASSERT(result == VK_SUCCESS, "Failed to create quad index buffer.");
+            vkGetBufferMemoryRequirements(device, m_QuadIndexBuffer, &quadIndexMemoryRequirements);
+        }
+
         // Create uniform buffers and get their memory requirements.
         VkMemoryRequirements uniformMemoryRequirements;
         {
@@ -112,14 +216,16 @@ namespace vc
         }
 
         // Calculate buffer offsets and allocation sizes.
-        VkDeviceSize vertexOffset;
+        VkDeviceSize vertexOffset, quadIndexOffset;
         VkDeviceSize deviceLocalAllocationSize, hostVisibleAllocationSize;
         {
             VkDeviceSize offset = 0;
             vertexOffset = BufferUtils::Align(offset, vertexMemoryRequirements.alignment);
-            offset += vertexMemoryRequirements.size;
+            offset = vertexOffset + vertexMemoryRequirements.size;
+            quadIndexOffset = BufferUtils::Align(offset, quadIndexMemoryRequirements.alignment);
+            offset = quadIndexOffset + quadIndexMemoryRequirements.size;
 
-            VkDeviceSize maxAlignment = vertexMemoryRequirements.alignment;
+            VkDeviceSize maxAlignment = std::max(vertexMemoryRequirements.alignment, quadIndexMemoryRequirements.alignment);
             deviceLocalAllocationSize = BufferUtils::Align(offset, maxAlignment);
 
             offset = 0;
@@ -149,7 +255,7 @@ namespace vc
 
         // Allocate once for all device local buffers.
         {
-            u32 memoryTypeBits = vertexMemoryRequirements.memoryTypeBits;
+            u32 memoryTypeBits = vertexMemoryRequirements.memoryTypeBits & quadIndexMemoryRequirements.memoryTypeBits;
             VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
             VkMemoryAllocateInfo info
@@ -185,6 +291,8 @@ namespace vc
         {
             VkResult result = vkBindBufferMemory(device, m_VertexBuffer, m_DeviceLocalMemory, vertexOffset);
             ENG_ASSERT(result == VK_SUCCESS, "Failed to bind vertex buffer memory.");
+            result = vkBindBufferMemory(device, m_QuadIndexBuffer, m_DeviceLocalMemory, quadIndexOffset);
+            ENG_ASSERT(result == VK_SUCCESS, "Failed to bind quad index buffer memory.");
             for (u32 i = 0; i < swapchainImageCount; i++)
             {
                 result = vkBindBufferMemory(device, m_UniformBuffers[i], m_HostVisibleMemory, m_UniformOffsets[i]);
@@ -199,6 +307,33 @@ namespace vc
         void* mappedMemory;
         BufferUtils::MapMemory(m_Context, m_HostVisibleMemory, 0, hostVisibleAllocationSize, mappedMemory);
         m_MappedMemory = std::span((u8*)mappedMemory, hostVisibleAllocationSize);
+
+        // Fill the quad index buffer, two triangles over each quad's 4 vertices.
+        {
+            StagingBuffer stagingBuffer({&m_Context, quadIndexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT});
+            auto indices = std::span(static_cast<u32*>(stagingBuffer.GetMappedMemory()), s_MaxRegionQuadCount * 6);
+            for (u32 quad = 0; quad < s_MaxRegionQuadCount; quad++)
+            {
+                auto quadIndices = indices.subspan(quad * 6, 6);
+                u32 vertex = quad * 4;
+                quadIndices[0] = vertex + 0;
+                quadIndices[1] = vertex + 1;
+                quadIndices[2] = vertex + 2;
+                quadIndices[3] = vertex + 2;
+                quadIndices[4] = vertex + 3;
+                quadIndices[5] = vertex + 0;
+            }
+
+            VkCommandBuffer commandBuffer = m_Context.BeginOneTimeCommandBuffer();
+            VkBufferCopy region
+            {
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = quadIndexBufferSize,
+            };
+            vkCmdCopyBuffer(commandBuffer, stagingBuffer.GetBuffer(), m_QuadIndexBuffer, 1, &region);
+            m_Context.EndOneTimeCommandBuffer(commandBuffer);
+        }
     }
 
     WorldRenderer::~WorldRenderer()
@@ -208,6 +343,7 @@ namespace vc
 
         BufferUtils::UnmapMemory(m_Context, m_HostVisibleMemory);
         vkDestroyBuffer(device, m_VertexBuffer, nullptr);
+        vkDestroyBuffer(device, m_QuadIndexBuffer, nullptr);
         for (auto& uniformBuffer : m_UniformBuffers)
             vkDestroyBuffer(device, uniformBuffer, nullptr);
         for (auto& storageBuffer : m_StorageBuffers)
@@ -221,10 +357,12 @@ namespace vc
     auto WorldRenderer::Render(
         VkCommandBuffer commandBuffer,
         mat4 const& viewProjection,
-        World const& world,
-        ChunkGenerator& chunkGenerator
+        vec3 cameraPosition,
+        World& world
     ) -> Statistics
     {
+        ENG_PROFILE_ZONE("WorldRenderer::Render");
+
         // TODO: use compute shader to decide which chunks get rendered rather than cpu-side decisions.
 
         u32 swapchainImageIndex = m_Context.GetSwapchainImageIndex();
@@ -236,35 +374,115 @@ namespace vc
         auto& storageOffset = m_StorageOffsets[swapchainImageIndex];
         auto& indirectOffset = m_IndirectOffsets[swapchainImageIndex];
 
-        // TODO: replace this with an explicit call to remove chunk mesh or something.
-        // There's currently a race condition where the world has to call
-        // ConsumeGeneratedChunks before ConsumeGeneratedChunkMeshes.
-        //
-        // Remove regions for all chunks that have been removed from the world.
-        for (auto& region : m_ChunkSubmeshRegions)
-            if (not world.m_Chunks.contains(region.ChunkPos))
-                RemoveChunkMesh(region.ChunkPos);
+        // Apply the chunk events published since the last frame.
+        world.TakeChunkEvents(m_ChunkEvents);
+        if (not m_ChunkEvents.empty())
+        {
+            // Only the latest event of each chunk in the batch matters for its mesh, so meshes
+            // of chunks that were remeshed again or removed later in the batch are skipped.
+            m_LatestChunkEventSequences.clear();
+            for (auto& event : m_ChunkEvents)
+                m_LatestChunkEventSequences[event.ChunkPos] = event.Sequence;
+
+            // New meshes replace any still waiting to be uploaded for the same chunk.
+            for (auto& event : m_ChunkEvents)
+            {
+                switch (+event.Type)
+                {
+                    case ChunkEventType::Added:
+                        break;
+                    case ChunkEventType::Remeshed:
+                        if (event.Sequence == m_LatestChunkEventSequences[event.ChunkPos])
+                            m_PendingChunkMeshes[event.ChunkPos] = std::move(event.Mesh);
+                        break;
+                    case ChunkEventType::Removed:
+                        m_PendingChunkMeshes.erase(event.ChunkPos);
+                        m_ChunkMeshRemovals.push_back(event.ChunkPos);
+                        break;
+                }
+            }
+        }
 
-        // Add regions for all chunks that have meshes.
+        // Translucent quads are re-sorted when the camera moves to another chunk, and sorted from here when repacked.
+        m_CameraPosition = cameraPosition;
+        if (ChunkPos cameraChunkPos = BlockQuery::GetChunkPos(ivec3(glm::floor(cameraPosition))); cameraChunkPos != m_CameraChunkPos)
         {
-            // TODO: Don't create command buffer if there are no new chunk meshes.
-            VkCommandBuffer commandBuffer = m_Context.BeginOneTimeCommandBuffer();
-            chunkGenerator.ConsumeGeneratedChunkMeshes([this, commandBuffer](ChunkMeshData&& chunkMeshData)
+            m_CameraChunkPos = cameraChunkPos;
+            for (auto& [origin, superChunk] : m_SuperChunks)
             {
-                AddOrReplaceChunkMesh(commandBuffer, chunkMeshData);
-            });
-            m_Context.EndOneTimeCommandBuffer(commandBuffer);
+                if (not superChunk.TranslucentQuads.empty() and not superChunk.Sorting)
+                    QueueTranslucentSort(origin, superChunk);
+            }
+        }
+
+        if (not m_PendingChunkMeshes.empty())
+            SelectChunkMeshUploads(viewProjection, cameraPosition);
+        if (not m_ChunkMeshUploads.empty() or not m_ChunkMeshRemovals.empty())
+            UpdateSuperChunks();
+        u32 sortedSuperChunkCount = ApplyTranslucentSorts();
+        m_PendingChunkMeshGauge.Set(i64(m_PendingChunkMeshes.size()));
+
+        // Record this frame's uploads and the resulting vertex buffer layout.
+        m_UploadedBytesPerFrame.Record(m_FrameUploadSize);
+        m_FrameUploadSize = 0;
+        if (m_VertexBufferLayoutChanged)
+            UpdateVertexBufferMetrics();
+
+        // Move each super chunk between levels of detail as the camera moves, by the distance to its nearest point.
+        for (auto& [origin, superChunk] : m_SuperChunks)
+        {
+            vec3 lower = vec3(origin) * f32(Chunk::Size);
+            vec3 upper = lower + f32(ChunkDrawPacking::SuperChunkSize * Chunk::Size);
+            f32 distance = glm::distance(glm::clamp(cameraPosition, lower, upper), cameraPosition) / f32(Chunk::Size);
+            superChunk.Lod = SelectLod(distance, superChunk.Lod);
         }
 
         // TODO: cull chunks
-        auto& renderingRegions = m_ChunkSubmeshRegions;
-        u32 drawCount = u32(renderingRegions.size());
+        // Regions being removed are skipped, their super chunk is either gone or drawn from its new regions.
+        for (auto& renderingRegions : m_RenderingRegions)
+            renderingRegions.clear();
+        u32 drawnInstanceCount = 0;
+        for (auto& region : m_ChunkSubmeshRegions)
+        {
+            if (region.Removing)
+                continue;
+            auto it = m_SuperChunks.find(region.ChunkPos);
+            if (it != m_SuperChunks.end() and it->second.Lod == region.Lod)
+            {
+                m_RenderingRegions[region.Layer.Index()].push_back(region);
+                drawnInstanceCount += region.InstanceCount;
+            }
+        }
 
-        auto shader = m_Shader.Get();
+        // Translucent quads are sorted within their super chunk, so the super chunks are drawn back to front too.
+        std::ranges::sort(m_RenderingRegions[RenderLayer(RenderLayer::Translucent).Index()], std::ranges::greater(), [cameraPosition](ChunkSubmeshRegion const& region)
+        {
+            vec3 center = (vec3(region.ChunkPos) + f32(ChunkDrawPacking::SuperChunkSize) * 0.5f) * f32(Chunk::Size);
+            vec3 offset = center - cameraPosition;
+            return glm::dot(offset, offset);
+        });
+
+        u32 drawCount = 0;
+        for (auto& renderingRegions : m_RenderingRegions)
+            drawCount += u32(renderingRegions.size());
+
+        // Both variants of each layer are kept loaded, so switching between them is immediate.
+        bool vertexPulling = m_VertexPulling.load(std::memory_order_relaxed);
+        std::array<std::shared_ptr<Shader>, RenderLayer::_Count> shaders;
+        for (u32 i = 0; i < RenderLayer::_Count; i++)
+        {
+            auto instancedShader = m_Shaders[i].Get();
+            auto vertexPullingShader = m_VertexPullingShaders[i].Get();
+            if (instancedShader.Old)
+                m_Context.DeferFree([oldShader = std::move(instancedShader.Old)] {});
+            if (vertexPullingShader.Old)
+                m_Context.DeferFree([oldShader = std::move(vertexPullingShader.Old)] {});
+            shaders[i] = vertexPulling ? vertexPullingShader.Current : instancedShader.Current;
+        }
 
         // No point in doing anything if nothing will be rendered.
 
-        if (drawCount == 0 or not shader.Current)
+        if (drawCount == 0 or std::ranges::any_of(shaders, [](auto const& shader) { return not shader; }))
             return {};
 
         // Set uniform buffer data.
@@ -284,63 +502,37 @@ namespace vc
             std::memcpy(m_MappedMemory.data() + uniformOffset, &localUniformBuffer, uniformSize);
         }
 
-        // Set storage buffer data.
-        VkDeviceSize storageSize = drawCount * sizeof(uvec2);
+        // Set storage and indirect buffer data, each layer's after the last's. Draw ids restart at 0 in every
+        // indirect draw call, so each layer's storage data is bound on its own, at an offset it can be bound at.
+        VkDeviceSize storageAlignment = m_Context.GetPhysicalDeviceProperties().limits.minStorageBufferOffsetAlignment;
+        VkDeviceSize indirectStride = vertexPulling ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+        std::array<VkDeviceSize, RenderLayer::_Count> layerStorageOffsets;
+        std::array<VkDeviceSize, RenderLayer::_Count> layerIndirectOffsets;
+        VkDeviceSize storageSize = 0;
+        VkDeviceSize indirectSize = 0;
+        for (u32 i = 0; i < RenderLayer::_Count; i++)
         {
-            std::vector<uvec2> storageData;
-            storageData.reserve(drawCount);
-
-            //                  packedChunkData.y                packedChunkData.x
-            // 64  60  56  52  48  44  40  36  32   28  24  20  16  12   8   4   0
-            //   -------------fffzzzzzzzzzzzzzzzz yyyyyyyyyyyyyyyyxxxxxxxxxxxxxxxx
-            // x = chunk x, y = chunk y, z = chunk z, f = face
-            auto packStorageData = [](ChunkPos chunkPos, MeshType type) -> uvec2
+            auto& renderingRegions = m_RenderingRegions[i];
+            u32 layerDrawCount = u32(renderingRegions.size());
+            storageSize = BufferUtils::Align(storageSize, storageAlignment);
+            layerStorageOffsets[i] = storageSize;
+            layerIndirectOffsets[i] = indirectSize;
+
+            auto storageData = std::span((uvec2*)(m_MappedMemory.data() + storageOffset + storageSize), layerDrawCount);
+            ChunkDrawPacking::PackStorageData(renderingRegions, storageData);
+            if (vertexPulling)
             {
-                return
-                {
-                    (chunkPos.y & 0xFFFF) << 16 | (chunkPos.x & 0xFFFF),
-                    /* extra 13 bits */ u32(type.Index()) << 16 | (chunkPos.z & 0xFFFF),
-                };
-            };
-
-            for (auto& region : renderingRegions)
-                storageData.emplace_back(packStorageData(region.ChunkPos, region.Type));
-
-            std::memcpy(m_MappedMemory.data() + storageOffset, storageData.data(), storageSize);
-        }
-
-        // Set indirect buffer data.
-        VkDeviceSize indirectSize = drawCount * sizeof(VkDrawIndirectCommand);
-        {
-            std::vector<VkDrawIndirectCommand> indirectData;
-            indirectData.reserve(drawCount);
-
-            for (auto& region : renderingRegions)
-                indirectData.emplace_back(6, region.InstanceCount, 0, region.FirstInstance);
-
-            std::memcpy(m_MappedMemory.data() + indirectOffset, indirectData.data(), indirectSize);
-        }
-
-        // Update shader descriptors and bind shader.
-        {
-            if (shader.Old)
-                m_Context.DeferFree([oldShader = std::move(shader.Old)] {});
-
-            auto uniformBuffers = std::to_array<ShaderUniformBufferBinding>
-            ({
-                {0, uniformBuffer, 0, uniformSize},
-            });
-            auto storageBuffers = std::to_array<ShaderStorageBufferBinding>
-            ({
-                {1, storageBuffer, 0, storageSize},
-            });
-            auto samplers = std::to_array<ShaderSamplerBinding>
-            ({
-                {2, m_BlockTextureAtlas->GetSampler(), m_BlockTextureAtlas->GetTexture()->GetImageView()},
-            });
+                auto indirectData = std::span((VkDrawIndexedIndirectCommand*)(m_MappedMemory.data() + indirectOffset + indirectSize), layerDrawCount);
+                ChunkDrawPacking::PackIndexedIndirectData(renderingRegions, indirectData);
+            }
+            else
+            {
+                auto indirectData = std::span((VkDrawIndirectCommand*)(m_MappedMemory.data() + indirectOffset + indirectSize), layerDrawCount);
+                ChunkDrawPacking::PackIndirectData(renderingRegions, indirectData);
+            }
 
-            shader.Current->UpdateDescriptorSet({uniformBuffers, storageBuffers, samplers});
-            shader.Current->Bind(commandBuffer);
+            storageSize += layerDrawCount * sizeof(uvec2);
+            indirectSize += layerDrawCount * indirectStride;
         }
 
         // Debug visualization.
@@ -375,36 +567,80 @@ namespace vc
             vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
         }
 
-        // Bind the vertex buffer.
+        // Bind the vertex buffer, or for vertex pulling the quad index buffer.
+        if (vertexPulling)
+            vkCmdBindIndexBuffer(commandBuffer, m_QuadIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        else
         {
             VkDeviceSize offset = 0;
             vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_VertexBuffer, &offset);
         }
 
-        // Draw everything.
-        vkCmdDrawIndirect(commandBuffer, indirectBuffer, 0, drawCount, sizeof(VkDrawIndirectCommand));
+        // Draw each layer in its own pass: opaque, then cutout, then translucent over both.
+        ENG_PROFILE_GPU_ZONE(m_Context, commandBuffer, "Chunks");
+        for (u32 i = 0; i < RenderLayer::_Count; i++)
+        {
+            u32 layerDrawCount = u32(m_RenderingRegions[i].size());
+            if (layerDrawCount == 0)
+                continue;
+
+            // Update shader descriptors and bind shader.
+            auto& shader = shaders[i];
+            {
+                auto uniformBuffers = std::to_array<ShaderUniformBufferBinding>
+                ({
+                    {0, uniformBuffer, 0, uniformSize},
+                });
+                // Only the vertex pulling variant reads the quads from the vertex buffer as a storage buffer.
+                auto storageBuffers = std::to_array<ShaderStorageBufferBinding>
+                ({
+                    {1, storageBuffer, layerStorageOffsets[i], layerDrawCount * sizeof(uvec2)},
+                    {3, m_VertexBuffer, 0, m_VertexBufferSize},
+                });
+                auto samplers = std::to_array<ShaderSamplerBinding>
+                ({
+                    {2, m_BlockTextureAtlas->GetSampler(), m_BlockTextureAtlas->GetTexture()->GetImageView()},
+                });
+
+                shader->UpdateDescriptorSet({uniformBuffers, std::span(storageBuffers).first(vertexPulling ? 2 : 1), samplers});
+                shader->Bind(commandBuffer);
+            }
+
+            if (vertexPulling)
+                vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer, layerIndirectOffsets[i], layerDrawCount, u32(indirectStride));
+            else
+                vkCmdDrawIndirect(commandBuffer, indirectBuffer, layerIndirectOffsets[i], layerDrawCount, u32(indirectStride));
+        }
 
         return Statistics
         {
             .IndirectDrawCallCount = drawCount,
             .InstanceCount = m_TotalInstanceCount,
+            .DrawnInstanceCount = drawnInstanceCount,
             .ChunkCount = m_TotalChunkCount,
+            .DeferredChunkMeshCount = u32(m_PendingChunkMeshes.size()),
             .UsedVertexBufferSize = m_UsedVertexBufferSize,
             .UsedUniformBufferSize = uniformSize,
             .UsedStorageBufferSize = storageSize,
             .UsedIndirectBufferSize = indirectSize,
+            .SortedSuperChunkCount = sortedSuperChunkCount,
+            .VertexPulling = vertexPulling,
         };
     }
 
     void WorldRenderer::ReloadShaders()
     {
-        if (not m_Shader.Loading())
+        if (not m_Shaders.front().Loading())
         {
             // TODO: Add a centralized place for shader loading.
             std::thread([this]
             {
                 Timer timer("WorldRenderer::ReloadShaders");
-                m_Shader.Load([this] { return LoadShaders(); });
+                for (RenderLayer layer : RenderLayers)
+                {
+                    m_Shaders[layer.Index()].Load([this, layer] { return LoadShaders(layer, false); });
+                    m_VertexPullingShaders[layer.Index()].Load([this, layer] { return LoadShaders(layer, true); });
+                }
             }).detach();
         }
     }
@@ -414,143 +650,518 @@ namespace vc
         m_Wireframe.fetch_xor(1, std::memory_order_relaxed);
     }
 
-    void WorldRenderer::AddOrReplaceChunkMesh(VkCommandBuffer commandBuffer, ChunkMeshData const& chunkMeshData)
+    void WorldRenderer::ToggleVertexPulling()
     {
-        struct Submesh
+        if (not m_VertexPullingSupported)
         {
-            VkDeviceSize VertexOffset; // offset in bytes from the start of the staging buffer
-            VkDeviceSize VertexSize;   // size in bytes in the staging buffer
-            u32 FirstInstance;
-            u16 InstanceCount;
-        };
-        std::array<Submesh, +MeshType::_Count> submeshes{};
+            ENG_LOG_WARN("Vertex pulling is unavailable, the vertex buffer is larger than the largest storage buffer binding.");
+            return;
+        }
+        m_VertexPulling.fetch_xor(1, std::memory_order_relaxed);
+    }
 
-        // Compute the vertex size and instance count of each submesh and the entire mesh.
-        VkDeviceSize meshVertexSize = 0;
-        u32 meshInstanceCount = 0;
-        auto calculateSubmeshBounds = [&](std::vector<uvec2> const& data, Submesh& submesh)
+    void WorldRenderer::SelectChunkMeshUploads(mat4 const& viewProjection, vec3 cameraPosition)
+    {
+        ENG_PROFILE_FUNCTION();
+
+        // Frustum planes from the rows of the view projection matrix, with depth in [0, 1].
+        std::array<vec4, 6> frustumPlanes;
         {
-            submesh.VertexOffset = meshVertexSize;
-            submesh.VertexSize = data.size() * sizeof(uvec2); // size of vertex
+            mat4 rows = glm::transpose(viewProjection);
+            frustumPlanes = {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2]};
+            for (vec4& plane : frustumPlanes)
+                plane /= glm::length(vec3(plane));
+        }
 
-            submesh.FirstInstance = meshInstanceCount;
-            submesh.InstanceCount = u16(data.size());
+        // Edits go first, since the player is waiting to see them, then chunks in view, then the rest, each nearest first.
+        m_PendingChunkMeshUploads.clear();
+        for (auto& [chunkPos, chunkMeshData] : m_PendingChunkMeshes)
+        {
+            vec3 center = (vec3(chunkPos) + 0.5f) * f32(Chunk::Size);
+            bool inView = std::ranges::all_of(frustumPlanes, [center](vec4 plane)
+            {
+                return glm::dot(vec3(plane), center) + plane.w > -s_ChunkBoundingRadius;
+            });
+            vec3 offset = center - cameraPosition;
+            u8 rank = chunkMeshData.Version != 0 ? 0 : inView ? 1 : 2;
+            m_PendingChunkMeshUploads.emplace_back(rank, glm::dot(offset, offset), chunkPos);
+        }
+        std::ranges::sort(m_PendingChunkMeshUploads, {}, [](PendingChunkMeshUpload const& upload)
+        {
+            return std::pair(upload.Rank, upload.DistanceSquared);
+        });
 
-            meshVertexSize += submesh.VertexSize;
-            meshInstanceCount += submesh.InstanceCount;
+        // Stop at the first mesh over the budget, so smaller ones further away don't jump the queue.
+        // The first mesh is always uploaded, so meshes larger than the whole budget still get through.
+        VkDeviceSize uploadSize = 0;
+        u32 uploadCount = 0;
+        for (auto& upload : m_PendingChunkMeshUploads)
+        {
+            auto it = m_PendingChunkMeshes.find(upload.ChunkPos);
+            VkDeviceSize meshVertexSize = GetMeshVertexSize(it->second);
+            if (uploadCount >= m_UploadBudget.MaxCount or (uploadCount != 0 and uploadSize + meshVertexSize > m_UploadBudget.MaxBytes))
+                break;
+
+            m_ChunkMeshUploads.push_back(std::move(it->second));
+            m_PendingChunkMeshes.erase(it);
+            uploadSize += meshVertexSize;
+            uploadCount++;
+        }
+    }
+
+    void WorldRenderer::UpdateSuperChunks()
+    {
+        ENG_PROFILE_FUNCTION();
+
+        // Sort the changes by super chunk, so each one is repacked once with all of its changes.
+        auto getOriginKey = [](ChunkPos chunkPos)
+        {
+            ChunkPos origin = ChunkDrawPacking::GetSuperChunkOrigin(chunkPos);
+            return std::tuple(origin.x, origin.y, origin.z);
         };
+        std::ranges::sort(m_ChunkMeshUploads, {}, [&getOriginKey](ChunkMeshData const& chunkMeshData)
+        {
+            return getOriginKey(chunkMeshData.ChunkPos);
+        });
+        std::ranges::sort(m_ChunkMeshRemovals, {}, getOriginKey);
+
+        VkCommandBuffer commandBuffer = m_Context.BeginOneTimeCommandBuffer();
+        auto uploads = std::span<ChunkMeshData const>(m_ChunkMeshUploads);
+        auto removals = std::span<ChunkPos const>(m_ChunkMeshRemovals);
+        while (not uploads.empty() or not removals.empty())
+        {
+            // Take every change to the first super chunk in either list.
+            bool uploadFirst = removals.empty() or (not uploads.empty() and getOriginKey(uploads.front().ChunkPos) < getOriginKey(removals.front()));
+            ChunkPos origin = ChunkDrawPacking::GetSuperChunkOrigin(uploadFirst ? uploads.front().ChunkPos : removals.front());
+            auto isInSuperChunk = [origin](ChunkPos chunkPos)
+            {
+                return ChunkDrawPacking::GetSuperChunkOrigin(chunkPos) == origin;
+            };
+            u64 uploadCount = u64(std::ranges::find_if_not(uploads, isInSuperChunk, &ChunkMeshData::ChunkPos) - uploads.begin());
+            u64 removalCount = u64(std::ranges::find_if_not(removals, isInSuperChunk) - removals.begin());
+
+            RepackSuperChunk(commandBuffer, origin, uploads.first(uploadCount), removals.first(removalCount));
+            uploads = uploads.subspan(uploadCount);
+            removals = removals.subspan(removalCount);
+        }
+        m_Context.EndOneTimeCommandBuffer(commandBuffer);
 
-        for (u8 i = 0; i < MeshType::_Count; i++)
-            calculateSubmeshBounds((&chunkMeshData.Left)[i], submeshes[i]);
+        m_ChunkMeshUploads.clear();
+        m_ChunkMeshRemovals.clear();
+    }
 
-        // Copy the data to the staging buffer.
-        VkBuffer stagingBuffer;
+    void WorldRenderer::RepackSuperChunk(VkCommandBuffer commandBuffer, ChunkPos origin, std::span<ChunkMeshData const> uploads, std::span<ChunkPos const> removals)
+    {
+        auto [superChunkIt, inserted] = m_SuperChunks.try_emplace(origin);
+        SuperChunk& superChunk = superChunkIt->second;
+
+        // Keep the members that aren't removed or replaced, then add the uploaded ones.
+        auto& members = m_Repack.Members;
+        auto& sources = m_Repack.Sources;
+        members.clear();
+        sources.clear();
+        for (u32 i = 0; i < superChunk.Members.size(); i++)
+        {
+            ChunkPos chunkPos = superChunk.Members[i].ChunkPos;
+            bool removed = std::ranges::find(removals, chunkPos) != removals.end();
+            bool replaced = std::ranges::find(uploads, chunkPos, &ChunkMeshData::ChunkPos) != uploads.end();
+            if (removed or replaced)
+                continue;
+            members.push_back(superChunk.Members[i]);
+            sources.push_back({false, i});
+        }
+        for (u32 i = 0; i < uploads.size(); i++)
         {
-            // Create the staging buffer.
-            StagingBuffer buffer({&m_Context, meshVertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT});
+            SuperChunkMember& member = members.emplace_back(uploads[i].ChunkPos);
+            for (u32 submesh = 0; submesh < s_SubmeshCount; submesh++)
+                member.QuadCounts[submesh] = uploads[i].FaceOffsets[submesh + 1] - uploads[i].FaceOffsets[submesh];
+            sources.push_back({true, i});
+        }
 
-            u8* stagingMappedMemory = (u8*)buffer.GetMappedMemory();
-            for (u8 i = 0; i < MeshType::_Count; i++)
-                std::memcpy(stagingMappedMemory + submeshes[i].VertexOffset, (&chunkMeshData.Left)[i].data(), submeshes[i].VertexSize);
+        // Nothing to do if only chunks that aren't members were removed.
+        if (uploads.empty() and members.size() == superChunk.Members.size())
+        {
+            if (superChunk.Members.empty())
+                m_SuperChunks.erase(superChunkIt);
+            return;
+        }
 
-            stagingBuffer = buffer.GetBuffer();
+        // Lays out members by submesh, then member, from the start of the submeshes' range, returning its instance count.
+        auto layOut = [](std::span<SuperChunkMember const> layoutMembers, std::vector<SubmeshCounts>& offsets, u32 submeshBegin, u32 submeshEnd)
+        {
+            offsets.resize(layoutMembers.size());
+            u32 offset = 0;
+            for (u32 submesh = submeshBegin; submesh < submeshEnd; submesh++)
+            {
+                for (u64 i = 0; i < layoutMembers.size(); i++)
+                {
+                    offsets[i][submesh] = offset;
+                    offset += layoutMembers[i].QuadCounts[submesh];
+                }
+            }
+            return offset;
+        };
+        // Translucent submeshes go in a range of their own.
+        layOut(superChunk.Members, m_Repack.CurrentOffsets, 0, s_TranslucentSubmeshBegin);
+        u32 instanceCount = layOut(members, m_Repack.Offsets, 0, s_TranslucentSubmeshBegin);
+        u32 translucentInstanceCount = layOut(members, m_Repack.Offsets, s_TranslucentSubmeshBegin, s_SubmeshCount);
+
+        // Stage the uploaded quads, with their chunk's offset in the super chunk filled in.
+        auto& uploadOffsets = m_Repack.UploadOffsets;
+        uploadOffsets.clear();
+        u32 stagedInstanceCount = 0;
+        for (auto& chunkMeshData : uploads)
+        {
+            uploadOffsets.push_back(stagedInstanceCount);
+            stagedInstanceCount += u32(chunkMeshData.Quads.size());
+        }
+        VkDeviceSize stagingSize = stagedInstanceCount * sizeof(uvec2); // sizeof vertex
+        std::optional<StagingBuffer> stagingBuffer;
+        if (stagingSize != 0)
+        {
+            stagingBuffer.emplace(StagingBufferInfo{&m_Context, stagingSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT});
+            auto stagedQuads = std::span(static_cast<uvec2*>(stagingBuffer->GetMappedMemory()), stagedInstanceCount);
+            for (u32 i = 0; i < uploads.size(); i++)
+            {
+                u32 superChunkOffset = ChunkDrawPacking::PackSuperChunkOffset(uploads[i].ChunkPos);
+                u32 offset = uploadOffsets[i];
+                for (uvec2 quad : uploads[i].Quads)
+                    stagedQuads[offset++] = {quad.x, quad.y | superChunkOffset};
+            }
         }
 
-        // If replacing this chunk mesh, first remove the old data.
-        RemoveChunkMesh(chunkMeshData.ChunkPos);
+        // The old range is still occupied, so the new one never overlaps what it's copied from.
+        u32 firstInstance = instanceCount != 0 ? FindFreeVertexRange(instanceCount) : 0;
 
-        // Find the smallest region large enough to fit the mesh.
-        // NOTE: This is the main reason m_ChunkSubmeshRegions needs to be ordered.
-        VkDeviceSize minRegionOffset = m_UsedVertexBufferSize;
+        // Copy every submesh of every member to its place in the new range.
+        auto& stagingCopies = m_Repack.StagingCopies;
+        auto& vertexCopies = m_Repack.VertexCopies;
+        stagingCopies.clear();
+        vertexCopies.clear();
+        for (u64 i = 0; i < members.size(); i++)
         {
-            VkDeviceSize minRegionSize = m_UsedVertexBufferSize;
-            VkDeviceSize offset = 0;
-            for (auto& region : m_ChunkSubmeshRegions)
+            auto [uploaded, index] = sources[i];
+            for (u32 submesh = 0; submesh < s_TranslucentSubmeshBegin; submesh++)
             {
-                VkDeviceSize regionOffset = region.FirstInstance * sizeof(uvec2); // sizeof vertex
-                VkDeviceSize regionSize = region.InstanceCount * sizeof(uvec2); // sizeof vertex
+                u32 quadCount = members[i].QuadCounts[submesh];
+                if (quadCount == 0)
+                    continue;
 
-                VkDeviceSize betweenRegionSize = regionOffset - offset;
-                if (meshVertexSize <= betweenRegionSize and betweenRegionSize < minRegionSize)
+                // sizeof vertex
+                VkBufferCopy copy
+                {
+                    .dstOffset = (firstInstance + m_Repack.Offsets[i][submesh]) * sizeof(uvec2),
+                    .size = quadCount * sizeof(uvec2),
+                };
+                if (uploaded)
+                {
+                    copy.srcOffset = (uploadOffsets[index] + uploads[index].FaceOffsets[submesh]) * sizeof(uvec2);
+                    stagingCopies.push_back(copy);
+                }
+                else
                 {
-                    minRegionOffset = offset;
-                    minRegionSize = betweenRegionSize;
+                    copy.srcOffset = (superChunk.FirstInstance + m_Repack.CurrentOffsets[index][submesh]) * sizeof(uvec2);
+                    vertexCopies.push_back(copy);
                 }
-                offset += regionSize;
             }
         }
+        if (not stagingCopies.empty())
+            vkCmdCopyBuffer(commandBuffer, stagingBuffer->GetBuffer(), m_VertexBuffer, u32(stagingCopies.size()), stagingCopies.data());
+        if (not vertexCopies.empty())
+            vkCmdCopyBuffer(commandBuffer, m_VertexBuffer, m_VertexBuffer, u32(vertexCopies.size()), vertexCopies.data());
+
+        if (superChunk.InstanceCount != 0)
+            RetireVertexRange(superChunk.FirstInstance, superChunk.InstanceCount);
 
-        // Add the submesh regions.
-        for (u8 i = 0; i < MeshType::_Count; i++)
+        // Add a region per submesh, each spanning every member.
+        for (u32 submesh = 0; submesh < s_TranslucentSubmeshBegin and not members.empty(); submesh++)
         {
-            if (submeshes[i].InstanceCount)
+            u32 submeshInstanceCount = 0;
+            for (auto& member : members)
+                submeshInstanceCount += member.QuadCounts[submesh];
+            ENG_ASSERT(submeshInstanceCount <= s_MaxRegionQuadCount);
+            if (submeshInstanceCount)
             {
                 m_ChunkSubmeshRegions.emplace_back(
-                    chunkMeshData.ChunkPos,
-                    submeshes[i].FirstInstance + u32(minRegionOffset / sizeof(uvec2)),
-                    submeshes[i].InstanceCount,
-                    MeshType(MeshType::_Begin + i)
+                    origin,
+                    firstInstance + m_Repack.Offsets[0][submesh],
+                    submeshInstanceCount,
+                    MeshType(MeshType::_Begin + submesh % MeshType::_Count),
+                    u8(submesh / MeshType::_Count % ChunkMeshData::LodCount),
+                    RenderLayer(RenderLayer::_Begin + submesh / (MeshType::_Count * ChunkMeshData::LodCount))
                 );
             }
         }
 
-        // Add the region.
-        m_UsedVertexBufferSize += meshVertexSize;
-        m_TotalInstanceCount += meshInstanceCount;
-        m_TotalChunkCount++;
+        // Gather the members' translucent quads, from the uploads or the super chunk's copy, and sort them
+        // from the camera here, since the super chunk's layout just changed.
+        auto& translucentQuads = m_Repack.TranslucentQuads;
+        translucentQuads.resize(translucentInstanceCount);
+        for (u32 submesh = s_TranslucentSubmeshBegin; submesh < s_SubmeshCount; submesh++)
+        {
+            // The copy's submeshes are sorted, which mixes up their members' quads, so each quad is
+            // told apart by its chunk offset. Quads of removed or replaced members have no destination.
+            std::array<u32, ChunkDrawPacking::SuperChunkSize * ChunkDrawPacking::SuperChunkSize * ChunkDrawPacking::SuperChunkSize> destinations;
+            destinations.fill(u32(-1));
+            for (u64 i = 0; i < members.size(); i++)
+            {
+                auto [uploaded, index] = sources[i];
+                u32 quadCount = members[i].QuadCounts[submesh];
+                u32 destination = m_Repack.Offsets[i][submesh];
+                if (not uploaded)
+                {
+                    destinations[ChunkDrawPacking::PackSuperChunkOffset(members[i].ChunkPos) >> 4] = destination;
+                    continue;
+                }
+
+                u32 superChunkOffset = ChunkDrawPacking::PackSuperChunkOffset(uploads[index].ChunkPos);
+                auto source = std::span(uploads[index].Quads).subspan(uploads[index].FaceOffsets[submesh], quadCount);
+                std::ranges::transform(source, translucentQuads.begin() + destination, [superChunkOffset](uvec2 quad)
+                {
+                    return uvec2(quad.x, quad.y | superChunkOffset);
+                });
+            }
 
-        // Copy the staging buffer to the vertex buffer.
+            u32 section = submesh - s_TranslucentSubmeshBegin;
+            auto& currentOffsets = superChunk.TranslucentOffsets;
+            for (uvec2 quad : std::span(superChunk.TranslucentQuads).subspan(currentOffsets[section], currentOffsets[section + 1] - currentOffsets[section]))
+            {
+                if (u32& destination = destinations[ChunkDrawPacking::GetSuperChunkIndex(quad)]; destination != u32(-1))
+                    translucentQuads[destination++] = quad;
+            }
+        }
+        u32 translucentOffset = 0;
+        for (u32 submesh = s_TranslucentSubmeshBegin; submesh < s_SubmeshCount; submesh++)
         {
-            VkBufferCopy region
+            superChunk.TranslucentOffsets[submesh - s_TranslucentSubmeshBegin] = translucentOffset;
+            for (auto& member : members)
+                translucentOffset += member.QuadCounts[submesh];
+        }
+        superChunk.TranslucentOffsets.back() = translucentOffset;
+        SortTranslucentQuads(origin, translucentQuads, superChunk.TranslucentOffsets, m_CameraPosition);
+        UploadTranslucentQuads(commandBuffer, origin, superChunk, translucentQuads);
+
+        m_UsedVertexBufferSize = m_UsedVertexBufferSize - superChunk.InstanceCount * sizeof(uvec2) + instanceCount * sizeof(uvec2); // sizeof vertex
+        m_TotalInstanceCount = m_TotalInstanceCount - superChunk.InstanceCount + instanceCount;
+        m_TotalChunkCount = m_TotalChunkCount - u32(superChunk.Members.size()) + u32(members.size());
+        m_FrameUploadSize += stagingSize;
+        m_UploadedBytes.Add(stagingSize);
+        m_VertexBufferLayoutChanged = true;
+
+        if (members.empty())
+        {
+            m_SuperChunks.erase(superChunkIt);
+            return;
+        }
+        superChunk.Members.assign(members.begin(), members.end());
+        superChunk.FirstInstance = firstInstance;
+        superChunk.InstanceCount = instanceCount;
+    }
+
+    void WorldRenderer::UploadTranslucentQuads(VkCommandBuffer commandBuffer, ChunkPos origin, SuperChunk& superChunk, std::vector<uvec2>& quads)
+    {
+        u32 oldInstanceCount = u32(superChunk.TranslucentQuads.size());
+        if (oldInstanceCount != 0)
+            RetireVertexRange(superChunk.TranslucentFirstInstance, oldInstanceCount);
+        superChunk.TranslucentQuads.swap(quads);
+        superChunk.TranslucentVersion = ++m_TranslucentVersion;
+
+        u32 instanceCount = u32(superChunk.TranslucentQuads.size());
+        u32 firstInstance = instanceCount != 0 ? FindFreeVertexRange(instanceCount) : 0;
+        VkDeviceSize stagingSize = instanceCount * sizeof(uvec2); // sizeof vertex
+        if (instanceCount != 0)
+        {
+            StagingBuffer stagingBuffer({&m_Context, stagingSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT});
+            std::memcpy(stagingBuffer.GetMappedMemory(), superChunk.TranslucentQuads.data(), stagingSize);
+            VkBufferCopy copy
             {
                 .srcOffset = 0,
-                .dstOffset = minRegionOffset,
-                .size = meshVertexSize,
+                .dstOffset = firstInstance * sizeof(uvec2), // sizeof vertex
+                .size = stagingSize,
             };
-            vkCmdCopyBuffer(commandBuffer, stagingBuffer, m_VertexBuffer, 1, &region);
+            vkCmdCopyBuffer(commandBuffer, stagingBuffer.GetBuffer(), m_VertexBuffer, 1, &copy);
+        }
+
+        // Add a region per translucent submesh, like the super chunk's other regions.
+        auto& offsets = superChunk.TranslucentOffsets;
+        for (u32 submesh = 0; submesh < s_TranslucentSubmeshCount; submesh++)
+        {
+            u32 submeshInstanceCount = offsets[submesh + 1] - offsets[submesh];
+            ENG_ASSERT(submeshInstanceCount <= s_MaxRegionQuadCount);
+            if (submeshInstanceCount)
+            {
+                m_ChunkSubmeshRegions.emplace_back(
+                    origin,
+                    firstInstance + offsets[submesh],
+                    submeshInstanceCount,
+                    MeshType(MeshType::_Begin + submesh % MeshType::_Count),
+                    u8(submesh / MeshType::_Count),
+                    RenderLayer(RenderLayer::Translucent)
+                );
+            }
         }
+
+        m_UsedVertexBufferSize = m_UsedVertexBufferSize - oldInstanceCount * sizeof(uvec2) + stagingSize;
+        m_TotalInstanceCount = m_TotalInstanceCount - oldInstanceCount + instanceCount;
+        m_FrameUploadSize += stagingSize;
+        m_UploadedBytes.Add(stagingSize);
+        m_VertexBufferLayoutChanged = true;
+        superChunk.TranslucentFirstInstance = firstInstance;
     }
 
-    void WorldRenderer::RemoveChunkMesh(ChunkPos chunkPos)
+    void WorldRenderer::QueueTranslucentSort(ChunkPos origin, SuperChunk& superChunk)
     {
-        auto predicate = [chunkPos](ChunkSubmeshRegion const& region)
+        superChunk.Sorting = true;
+        m_SortThreadPool.SubmitTask([
+            this,
+            origin,
+            version = superChunk.TranslucentVersion,
+            cameraPosition = m_CameraPosition,
+            cameraChunkPos = m_CameraChunkPos,
+            offsets = superChunk.TranslucentOffsets,
+            quads = superChunk.TranslucentQuads
+        ]() mutable
         {
-            return chunkPos == region.ChunkPos and not region.Removing;
-        };
-        auto beginIt = std::find_if(m_ChunkSubmeshRegions.begin(), m_ChunkSubmeshRegions.end(), predicate);
-        auto endIt = std::find_if_not(beginIt, m_ChunkSubmeshRegions.end(), predicate);
+            ENG_PROFILE_ZONE("WorldRenderer::SortTranslucentQuads");
+            SortTranslucentQuads(origin, quads, offsets, cameraPosition);
 
-        if (beginIt == m_ChunkSubmeshRegions.end())
-            return;
+            std::lock_guard lock(m_TranslucentSortMutex);
+            m_FinishedTranslucentSorts.emplace_back(origin, version, cameraChunkPos, std::move(quads));
+        });
+    }
 
-        for (auto it = beginIt; it != endIt; ++it)
+    u32 WorldRenderer::ApplyTranslucentSorts()
+    {
         {
-            u32 instanceCount = it->InstanceCount;
-            m_TotalInstanceCount -= instanceCount;
-            m_UsedVertexBufferSize -= instanceCount * sizeof(uvec2); // sizeof vertex
-            it->Removing = true;
+            std::lock_guard lock(m_TranslucentSortMutex);
+            m_TranslucentSorts.swap(m_FinishedTranslucentSorts);
         }
-        m_TotalChunkCount--;
+        if (m_TranslucentSorts.empty())
+            return 0;
+
+        ENG_PROFILE_FUNCTION();
 
-        // Wait until all previous frames have stopped using the old chunk data to remove its regions.
-        m_Context.DeferFree([this, chunkPos]
+        u32 sortedCount = 0;
+        VkCommandBuffer commandBuffer = m_Context.BeginOneTimeCommandBuffer();
+        for (auto& sort : m_TranslucentSorts)
         {
-            auto predicate = [chunkPos](ChunkSubmeshRegion const& region)
+            auto it = m_SuperChunks.find(sort.Origin);
+            if (it == m_SuperChunks.end())
+                continue;
+            SuperChunk& superChunk = it->second;
+            superChunk.Sorting = false;
+
+            // Sorts of quads that were replaced since are dropped, the replacement was sorted when it was repacked.
+            if (sort.Version == superChunk.TranslucentVersion)
             {
-                bool remove = chunkPos == region.ChunkPos;
-                if (remove)
-                    ENG_ASSERT(region.Removing);
-                return remove;
-            };
-            auto beginIt = std::find_if(m_ChunkSubmeshRegions.begin(), m_ChunkSubmeshRegions.end(), predicate);
-            auto endIt = std::find_if_not(beginIt, m_ChunkSubmeshRegions.end(), predicate);
-            // Remove all submesh regions this chunk has.
-            m_ChunkSubmeshRegions.erase(beginIt, endIt);
+                UploadTranslucentQuads(commandBuffer, sort.Origin, superChunk, sort.Quads);
+                sortedCount++;
+            }
+            // The camera moved on while this was sorting.
+            if (sort.CameraChunkPos != m_CameraChunkPos and not superChunk.TranslucentQuads.empty())
+                QueueTranslucentSort(sort.Origin, superChunk);
+        }
+        m_Context.EndOneTimeCommandBuffer(commandBuffer);
+        m_TranslucentSorts.clear();
+
+        return sortedCount;
+    }
+
+    void WorldRenderer::RetireVertexRange(u32 firstInstance, u32 instanceCount)
+    {
+        // No other range overlaps this one, even those being removed, so its regions are the ones starting in it.
+        u32 endInstance = firstInstance + instanceCount;
+        auto isInRange = [firstInstance, endInstance](ChunkSubmeshRegion const& region)
+        {
+            return region.FirstInstance >= firstInstance and region.FirstInstance < endInstance;
+        };
+        for (auto& region : m_ChunkSubmeshRegions)
+        {
+            if (isInRange(region))
+                region.Removing = true;
+        }
+
+        // Wait until all previous frames have stopped using the range to remove its regions.
+        m_Context.DeferFree([this, isInRange]
+        {
+            std::erase_if(m_ChunkSubmeshRegions, [&isInRange](ChunkSubmeshRegion const& region)
+            {
+                return region.Removing and isInRange(region);
+            });
+            m_VertexBufferLayoutChanged = true;
         });
     }
 
-    std::shared_ptr<Shader> WorldRenderer::LoadShaders()
+    u32 WorldRenderer::FindFreeVertexRange(u32 instanceCount)
+    {
+        CollectOccupiedVertexRanges();
+
+        // The smallest gap between occupied ranges that fits, else after the last one.
+        std::optional<u32> bestFirstInstance;
+        u32 bestSize = 0;
+        u32 offset = 0;
+        for (auto [firstInstance, count] : m_OccupiedVertexRanges)
+        {
+            u32 size = firstInstance > offset ? firstInstance - offset : 0;
+            if (size >= instanceCount and (not bestFirstInstance or size < bestSize))
+            {
+                bestFirstInstance = offset;
+                bestSize = size;
+            }
+            offset = std::max(offset, firstInstance + count);
+        }
+
+        u32 firstInstance = bestFirstInstance.value_or(offset);
+        ENG_ASSERT((firstInstance + instanceCount) * sizeof(uvec2) <= m_VertexBufferSize, "Out of vertex buffer space."); // sizeof vertex
+        return firstInstance;
+    }
+
+    void WorldRenderer::CollectOccupiedVertexRanges()
+    {
+        // Regions being removed still occupy their space until the frames using them finish.
+        m_OccupiedVertexRanges.clear();
+        for (auto& region : m_ChunkSubmeshRegions)
+            m_OccupiedVertexRanges.emplace_back(region.FirstInstance, region.InstanceCount);
+        std::ranges::sort(m_OccupiedVertexRanges);
+    }
+
+    void WorldRenderer::UpdateVertexBufferMetrics()
+    {
+        m_VertexBufferLayoutChanged = false;
+
+        CollectOccupiedVertexRanges();
+
+        VkDeviceSize totalFree = 0;
+        VkDeviceSize largestFree = 0;
+        VkDeviceSize offset = 0;
+        auto addFree = [&](VkDeviceSize end)
+        {
+            VkDeviceSize size = end > offset ? end - offset : 0;
+            totalFree += size;
+            largestFree = std::max(largestFree, size);
+        };
+        for (auto [firstInstance, count] : m_OccupiedVertexRanges)
+        {
+            VkDeviceSize regionOffset = firstInstance * sizeof(uvec2); // sizeof vertex
+            addFree(regionOffset);
+            offset = std::max(offset, regionOffset + count * sizeof(uvec2));
+        }
+        addFree(m_VertexBufferSize);
+
+        m_VertexBufferUsedGauge.Set(i64(m_UsedVertexBufferSize));
+        m_VertexBufferLargestFreeGauge.Set(i64(largestFree));
+        m_VertexBufferFragmentationGauge.Set(totalFree ? i64(1000 - largestFree * 1000 / totalFree) : 0);
+    }
+
+    std::shared_ptr<Shader> WorldRenderer::LoadShaders(RenderLayer layer, bool vertexPulling)
     {
+        // Vertex pulling reads the quads from a storage buffer instead, so it has no vertex inputs.
+        // Only the cutout layer discards texels, and the translucent layer is blended over what's behind it.
+        std::vector<ShaderDefine> defines;
+        if (vertexPulling)
+            defines.push_back({"VC_VERTEX_PULLING", "1"});
+        if (layer == RenderLayer::Cutout)
+            defines.push_back({"VC_ALPHA_TEST", "1"});
         auto bindings = std::to_array<ShaderVertexBufferBinding>
         ({
             {0, VK_VERTEX_INPUT_RATE_INSTANCE, {0}},
@@ -559,9 +1170,11 @@ namespace vc
         {
             .RenderContext = &m_Context,
             .Filepath = "Assets/Shaders/Chunk",
-            .VertexBufferBindings = bindings,
+            .Defines = defines,
+            .VertexBufferBindings = vertexPulling ? std::span<ShaderVertexBufferBinding>() : std::span<ShaderVertexBufferBinding>(bindings),
             .Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
             .RenderPass = m_RenderPass,
+            .DepthWrite = layer != RenderLayer::Translucent,
         };
         return std::make_shared<Shader>(info);
     }
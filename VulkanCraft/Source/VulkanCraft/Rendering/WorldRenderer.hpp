@@ -1,9 +1,18 @@
 #pragma once
 
+#include "VulkanCraft/Rendering/ChunkDrawPacking.hpp"
 #include "VulkanCraft/Rendering/ChunkMeshData.hpp"
 #include "VulkanCraft/Rendering/MeshType.hpp"
+#include "VulkanCraft/Rendering/RenderLayer.hpp"
 #include "VulkanCraft/Rendering/TextureAtlas.hpp"
+#include "VulkanCraft/World/ChunkEvent.hpp"
 #include <Engine.hpp>
+#include <array>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 using namespace eng;
 
@@ -11,37 +20,52 @@ namespace vc
 {
     class Chunk;
     class World;
-    class ChunkGenerator;
+
+    // Limits on the chunk mesh data uploaded each frame. Meshes over the limits wait for later frames,
+    // so a burst of finished chunks is spread out instead of stalling a single frame.
+    struct ChunkMeshUploadBudget
+    {
+        u64 MaxBytes = 2 * 1024 * 1024;
+        u32 MaxCount = 32;
+    };
 
     class WorldRenderer
     {
         ENG_IMMOVABLE_UNCOPYABLE_CLASS(WorldRenderer);
     public:
-        WorldRenderer(RenderContext& context, VkRenderPass renderPass, u16 maxChunkCount);
+        WorldRenderer(RenderContext& context, FileIOService& fileIO, VkRenderPass renderPass, u16 maxChunkCount, ChunkMeshUploadBudget uploadBudget = {});
         ~WorldRenderer();
 
         struct Statistics
         {
             u32 IndirectDrawCallCount = 0;
             u32 InstanceCount = 0;
+            u32 DrawnInstanceCount = 0; // Only the selected level of detail of each chunk is drawn.
             u32 ChunkCount = 0;
+            u32 DeferredChunkMeshCount = 0;
             u64 UsedVertexBufferSize = 0;
             u64 UsedUniformBufferSize = 0;
             u64 UsedStorageBufferSize = 0;
             u64 UsedIndirectBufferSize = 0;
+            u32 SortedSuperChunkCount = 0; // Super chunks whose translucent quads were re-sorted this frame.
+            bool VertexPulling = false;
         };
 
         Statistics Render(
             VkCommandBuffer commandBuffer,
             mat4 const& viewProjection,
-            World const& world,
-            ChunkGenerator& chunkGenerator
+            vec3 cameraPosition,
+            World& world
         );
 
         // Can be called from any thread.
         void ReloadShaders();
         // Can be called from any thread.
         void ToggleWireframe();
+        // Switches between instanced quads and pulling quads from a storage buffer, to compare them.
+        // Stays on instanced quads if the vertex buffer is larger than a storage buffer binding can be.
+        // Can be called from any thread.
+        void ToggleVertexPulling();
     private:
         struct LocalUniformBuffer
         {
@@ -55,24 +79,90 @@ namespace vc
             } BlockTextureAtlas;
         };
 
-        struct ChunkSubmeshRegion
+        struct PendingChunkMeshUpload
         {
+            u8 Rank; // Lower ranks are uploaded first.
+            f32 DistanceSquared;
             ChunkPos ChunkPos;
-            u32 FirstInstance;
-            u16 InstanceCount; // NOTE: max is 4096 = 2^12 < 2^16-1, so using u16 is fine.
-            MeshType Type;
-            bool Removing = false;
         };
-    private:
-        void AddOrReplaceChunkMesh(VkCommandBuffer commandBuffer, ChunkMeshData const& meshData);
-        // Removes a chunk mesh if one at the given position exists.
-        void RemoveChunkMesh(ChunkPos chunkPos);
 
-        std::shared_ptr<Shader> LoadShaders();
+        // One per render layer, level of detail and MeshType, in the order a super chunk lays them out.
+        inline static constexpr u32 s_SubmeshCount = ChunkMeshData::SubmeshCount;
+        // Translucent submeshes come last, and are kept in a range of their own so they can be re-sorted without moving the rest.
+        inline static constexpr u32 s_TranslucentSubmeshBegin = ChunkMeshData::GetSubmesh(MeshType::_Begin, 0, RenderLayer::Translucent);
+        inline static constexpr u32 s_TranslucentSubmeshCount = s_SubmeshCount - s_TranslucentSubmeshBegin;
+        using SubmeshCounts = std::array<u32, s_SubmeshCount>;
+
+        struct SuperChunkMember
+        {
+            ChunkPos ChunkPos;
+            SubmeshCounts QuadCounts{};
+        };
+
+        // A cube of chunks whose meshes share one range of the vertex buffer, laid out by submesh then chunk,
+        // so each face direction of the whole cube is one region and one draw.
+        struct SuperChunk
+        {
+            std::vector<SuperChunkMember> Members;
+            u32 FirstInstance = 0;
+            u32 InstanceCount = 0;
+            u8 Lod = 0; // Kept between frames for hysteresis.
+
+            // A copy of the translucent range, each submesh sorted back to front, to re-sort as the camera moves.
+            std::vector<uvec2> TranslucentQuads;
+            // Where each translucent submesh starts in TranslucentQuads, followed by the total quad count.
+            std::array<u32, s_TranslucentSubmeshCount + 1> TranslucentOffsets{};
+            u32 TranslucentFirstInstance = 0;
+            u64 TranslucentVersion = 0; // Changes with TranslucentQuads, so sorts of older ones are dropped.
+            bool Sorting = false;
+        };
+
+        // A super chunk's translucent quads, sorted on the sorting thread.
+        struct TranslucentSort
+        {
+            ChunkPos Origin;
+            u64 Version;
+            ChunkPos CameraChunkPos; // Where the camera was when the sort started.
+            std::vector<uvec2> Quads;
+        };
+
+        // Where a member of a repacked super chunk is copied from.
+        struct RepackSource
+        {
+            bool Uploaded; // Else from the super chunk's current range.
+            u32 Index;     // Into the uploads or the current members.
+        };
+    private:
+        // Moves the most important pending chunk meshes that fit in the budget to m_ChunkMeshUploads.
+        void SelectChunkMeshUploads(mat4 const& viewProjection, vec3 cameraPosition);
+        // Applies m_ChunkMeshUploads and m_ChunkMeshRemovals, repacking each changed super chunk once.
+        void UpdateSuperChunks();
+        // Copies the super chunk's members to a new range, replacing or removing the given chunks.
+        void RepackSuperChunk(VkCommandBuffer commandBuffer, ChunkPos origin, std::span<ChunkMeshData const> uploads, std::span<ChunkPos const> removals);
+        // Replaces the super chunk's translucent quads with the given ones, moving them to a new range.
+        // Leaves the old quads in the given vector.
+        void UploadTranslucentQuads(VkCommandBuffer commandBuffer, ChunkPos origin, SuperChunk& superChunk, std::vector<uvec2>& quads);
+        // Starts sorting the super chunk's translucent quads from the camera on the sorting thread.
+        void QueueTranslucentSort(ChunkPos origin, SuperChunk& superChunk);
+        // Uploads the translucent quads of the sorts that finished since the last frame, returning how many.
+        u32 ApplyTranslucentSorts();
+        // Marks the regions in the range as being removed, then removes them once no frame in flight uses them.
+        void RetireVertexRange(u32 firstInstance, u32 instanceCount);
+        // Returns the first instance of the smallest free range that fits.
+        u32 FindFreeVertexRange(u32 instanceCount);
+        // Fills m_OccupiedVertexRanges, sorted by first instance.
+        void CollectOccupiedVertexRanges();
+        void UpdateVertexBufferMetrics();
+
+        std::shared_ptr<Shader> LoadShaders(RenderLayer layer, bool vertexPulling);
     private:
         RenderContext& m_Context; // non-owning
         VkRenderPass m_RenderPass; // non-owning
         VkBuffer m_VertexBuffer = nullptr;
+        VkDeviceSize m_VertexBufferSize = 0;
+        // Vertex pulling binds the whole vertex buffer as one storage buffer, so it needs to fit in maxStorageBufferRange.
+        bool m_VertexPullingSupported = false;
+        VkBuffer m_QuadIndexBuffer = nullptr; // Shared by every vertex pulling draw.
         std::vector<VkBuffer> m_UniformBuffers;
         std::vector<VkBuffer> m_StorageBuffers;
         std::vector<VkBuffer> m_IndirectBuffers;
@@ -83,11 +173,47 @@ namespace vc
         VkDeviceMemory m_HostVisibleMemory = nullptr;
         std::span<u8> m_MappedMemory;
 
-        DynamicResource<std::shared_ptr<Shader>> m_Shader;
+        // One per render layer.
+        std::array<DynamicResource<std::shared_ptr<Shader>>, RenderLayer::_Count> m_Shaders;
+        std::array<DynamicResource<std::shared_ptr<Shader>>, RenderLayer::_Count> m_VertexPullingShaders;
         std::unique_ptr<TextureAtlas> m_BlockTextureAtlas;
 
-        // Maps of chunk positions to their regions.
+        // Maps of super chunk origins to their regions.
         std::vector<ChunkSubmeshRegion> m_ChunkSubmeshRegions;
+        std::unordered_map<ChunkPos, SuperChunk, ChunkPosHash> m_SuperChunks;
+
+        // The latest mesh of each chunk that's waiting for room in the upload budget.
+        std::unordered_map<ChunkPos, ChunkMeshData, ChunkPosHash> m_PendingChunkMeshes;
+        ChunkMeshUploadBudget m_UploadBudget;
+
+        // Reused every frame to avoid reallocating.
+        std::vector<ChunkEvent> m_ChunkEvents;
+        std::unordered_map<ChunkPos, u64, ChunkPosHash> m_LatestChunkEventSequences;
+        std::vector<PendingChunkMeshUpload> m_PendingChunkMeshUploads;
+        std::vector<ChunkMeshData> m_ChunkMeshUploads;
+        std::vector<ChunkPos> m_ChunkMeshRemovals;
+        std::array<std::vector<ChunkSubmeshRegion>, RenderLayer::_Count> m_RenderingRegions;
+        std::vector<std::pair<u32, u32>> m_OccupiedVertexRanges; // First instance and instance count.
+        struct
+        {
+            std::vector<SuperChunkMember> Members;
+            std::vector<RepackSource> Sources;
+            std::vector<SubmeshCounts> CurrentOffsets;
+            std::vector<SubmeshCounts> Offsets;
+            std::vector<u32> UploadOffsets;
+            std::vector<uvec2> TranslucentQuads;
+            std::vector<VkBufferCopy> StagingCopies;
+            std::vector<VkBufferCopy> VertexCopies;
+        } m_Repack;
+
+        // Translucent sorting
+
+        vec3 m_CameraPosition{};
+        ChunkPos m_CameraChunkPos{}; // Translucent quads are re-sorted when the camera moves to another chunk.
+        u64 m_TranslucentVersion = 0;
+        std::mutex m_TranslucentSortMutex;
+        std::vector<TranslucentSort> m_FinishedTranslucentSorts; // Guarded by the mutex.
+        std::vector<TranslucentSort> m_TranslucentSorts;          // Reused to take the finished sorts.
 
         // Statistics
 
@@ -95,8 +221,25 @@ namespace vc
         u32 m_TotalInstanceCount = 0;
         u32 m_TotalChunkCount = 0;
 
+        // Metrics
+
+        u64 m_FrameUploadSize = 0;
+        // Set when regions are added or removed, so the vertex buffer layout is only measured when it changes.
+        bool m_VertexBufferLayoutChanged = false;
+        MetricCounter& m_UploadedBytes = Metrics::GetCounter("world_renderer.uploaded_bytes");
+        MetricHistogram& m_UploadedBytesPerFrame = Metrics::GetHistogram("world_renderer.uploaded_bytes_per_frame");
+        MetricGauge& m_PendingChunkMeshGauge = Metrics::GetGauge("world_renderer.pending_chunk_meshes");
+        MetricGauge& m_VertexBufferUsedGauge = Metrics::GetGauge("world_renderer.vertex_buffer_used_bytes");
+        MetricGauge& m_VertexBufferLargestFreeGauge = Metrics::GetGauge("world_renderer.vertex_buffer_largest_free_bytes");
+        // 1 - largest free block / total free space, in thousandths.
+        MetricGauge& m_VertexBufferFragmentationGauge = Metrics::GetGauge("world_renderer.vertex_buffer_fragmentation_permille");
+
         // Debug visualization
 
         std::atomic<u8> m_Wireframe = 0;
+        std::atomic<u8> m_VertexPulling = 0;
+
+        // Last, so it's joined before anything its tasks use is destroyed.
+        ThreadPool m_SortThreadPool{1, false};
     };
 }
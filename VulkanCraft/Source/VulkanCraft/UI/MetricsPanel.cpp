@@ -0,0 +1,64 @@
+#include "MetricsPanel.hpp"
+#include <imgui.h>
+
+namespace vc
+{
+    MetricsPanel::MetricsPanel(FileIOService& fileIO)
+        : m_FileIO(fileIO)
+    {
+    }
+
+    MetricsPanel::~MetricsPanel()
+    {
+        if (m_CSVWritten.valid())
+            m_CSVWritten.wait();
+    }
+
+    void MetricsPanel::OnImGuiRender()
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_LastSampleTime >= std::chrono::seconds(1))
+        {
+            m_LastSampleTime = now;
+            Metrics::Sample();
+        }
+
+        if (ImGui::Begin("Metrics"))
+        {
+            if (m_CSVWritten.valid() and m_CSVWritten.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                if (not m_CSVWritten.get())
+                    ENG_LOG_WARN("Failed to write the metrics CSV.");
+
+            ImGui::BeginDisabled(m_CSVWritten.valid());
+            if (ImGui::Button("Write CSV"))
+            {
+                Metrics::FormatCSV(m_CSV);
+                m_CSVWritten = m_FileIO.WriteFile("VulkanCraft.metrics.csv", std::span((u8 const*)m_CSV.data(), m_CSV.size()));
+            }
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            ImGui::TextUnformatted("Histograms cover the last second.");
+
+            constexpr ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp;
+            if (ImGui::BeginTable("metrics table", 3, tableFlags))
+            {
+                small_string_view previousName;
+                for (auto& sample : Metrics::GetLatestSamples())
+                {
+                    // Only name the first row of each metric.
+                    ImGui::TableNextColumn();
+                    if (sample.Name != previousName)
+                        ImGui::TextUnformatted(sample.Name.data(), sample.Name.data() + sample.Name.size());
+                    previousName = sample.Name;
+
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(sample.Statistic.data(), sample.Statistic.data() + sample.Statistic.size());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", sample.Value);
+                }
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+    }
+}
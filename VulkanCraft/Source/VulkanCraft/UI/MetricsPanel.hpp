@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Engine.hpp>
+#include <chrono>
+#include <future>
+
+using namespace eng;
+
+namespace vc
+{
+    // Samples the metrics registry once a second and shows the latest samples.
+    // Only use from the render thread, since it owns sampling.
+    class MetricsPanel
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(MetricsPanel);
+    public:
+        MetricsPanel(FileIOService& fileIO);
+        // Waits for the CSV to be written.
+        ~MetricsPanel();
+
+        void OnImGuiRender();
+    private:
+        FileIOService& m_FileIO;
+        std::chrono::steady_clock::time_point m_LastSampleTime = std::chrono::steady_clock::now();
+
+        // Written in the background, so the CSV is kept until the write finishes.
+        string m_CSV;
+        std::future<bool> m_CSVWritten;
+    };
+}
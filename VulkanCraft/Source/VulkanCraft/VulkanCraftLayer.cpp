@@ -1,5 +1,6 @@
 #include "VulkanCraftLayer.hpp"
-#include "VulkanCraft/Rendering/BlockModel.hpp"
+#include "VulkanCraft/World/DefaultBlocks.hpp"
+#include <algorithm>
 #include <array>
 
 namespace vc
@@ -14,70 +15,13 @@ namespace vc
         m_ImGuiHelper = std::make_unique<ImGuiHelper>();
 
         m_Blocks = std::make_unique<BlockRegistry>();
-        {
-            // TODO: block model files using yaml-cpp
-
-            // air
-            {
-                m_Blocks->CreateBlock("minecraft:air");
-            }
-
-            // bedrock
-            {
-                BlockID block = m_Blocks->CreateBlock("minecraft:bedrock");
-                BlockModel& model = m_Blocks->EmplaceComponent<BlockModel>(block);
-                model.SolidBits = 0b111111;
-                model.Left = TextureID(0);
-                model.Right = TextureID(0);
-                model.Bottom = TextureID(0);
-                model.Top = TextureID(0);
-                model.Back = TextureID(0);
-                model.Front = TextureID(0);
-            }
-
-            // stone
-            {
-                BlockID block = m_Blocks->CreateBlock("minecraft:stone");
-                BlockModel& model = m_Blocks->EmplaceComponent<BlockModel>(block);
-                model.SolidBits = 0b111111;
-                model.Left = TextureID(1);
-                model.Right = TextureID(1);
-                model.Bottom = TextureID(1);
-                model.Top = TextureID(1);
-                model.Back = TextureID(1);
-                model.Front = TextureID(1);
-            }
-
-            // dirt
-            {
-                BlockID block = m_Blocks->CreateBlock("minecraft:dirt");
-                BlockModel& model = m_Blocks->EmplaceComponent<BlockModel>(block);
-                model.SolidBits = 0b111111;
-                model.Left = TextureID(2);
-                model.Right = TextureID(2);
-                model.Bottom = TextureID(2);
-                model.Top = TextureID(2);
-                model.Back = TextureID(2);
-                model.Front = TextureID(2);
-            }
-
-            // grass
-            {
-                BlockID block = m_Blocks->CreateBlock("minecraft:grass");
-                BlockModel& model = m_Blocks->EmplaceComponent<BlockModel>(block);
-                model.SolidBits = 0b111111;
-                model.Left = TextureID(3);
-                model.Right = TextureID(3);
-                model.Bottom = TextureID(2);
-                model.Top = TextureID(4);
-                model.Back = TextureID(3);
-                model.Front = TextureID(3);
-            }
-        }
+        RegisterDefaultBlocks(*m_Blocks);
 
-        m_World = std::make_unique<World>(*m_Blocks);
-        m_WorldRenderer = std::make_unique<WorldRenderer>(window.GetRenderContext(), m_RenderPass->GetRenderPass(), 4096); // TODO: render distance
-        m_ChunkGenerator = std::make_unique<ChunkGenerator>(*m_Blocks, 8); // TODO: determine how many worker threads there should be (dynamically?)
+        m_ChunkStorage = std::make_unique<ChunkStorage>(*m_Blocks, s_SaveDirectory);
+        m_World = std::make_unique<World>(*m_Blocks, s_HorizontalRenderDistance, s_VerticalRenderDistance, m_ChunkStorage.get());
+        u64 maxChunkCount = ChunkStreamer::GetMaxChunkCount(s_HorizontalRenderDistance, s_VerticalRenderDistance);
+        m_WorldRenderer = std::make_unique<WorldRenderer>(window.GetRenderContext(), m_FileIO, m_RenderPass->GetRenderPass(), u16(std::min<u64>(maxChunkCount, u16(-1))));
+        m_ChunkGenerator = std::make_unique<ChunkGenerator>(*m_Blocks, s_WorldSeed, 8, ChunkGenerator::StageTimingCallback{}, m_ChunkStorage.get()); // TODO: determine how many worker threads there should be (dynamically?)
 
         m_CameraController.SetPosition({0.0f, 64.0f, 0.0f});
         m_CameraController.SetRotation({glm::radians(-90.0f), 0.0f, 0.0f});
@@ -99,7 +43,7 @@ namespace vc
     void VulkanCraftLayer::OnUpdate(Timestep timestep)
     {
         m_CameraController.OnUpdate(timestep);
-        m_World->OnUpdate(timestep, *m_ChunkGenerator);
+        m_World->OnUpdate(timestep, *m_ChunkGenerator, m_CameraController.GetPosition());
     }
 
     void VulkanCraftLayer::OnRender(Timestep timestep)
@@ -130,7 +74,7 @@ namespace vc
         vkCmdBeginRenderPass(commandBuffer, &info, VK_SUBPASS_CONTENTS_INLINE);
 
         // Render world
-        m_WorldRendererStatistics = m_WorldRenderer->Render(commandBuffer, m_CameraController.GetViewProjection(), *m_World, *m_ChunkGenerator);
+        m_WorldRendererStatistics = m_WorldRenderer->Render(commandBuffer, m_CameraController.GetViewProjection(), m_CameraController.GetPosition(), *m_World);
 
         // Render ImGui
         // TODO: SetWindowLongW, called from ImGui_ImplGlfw_NewFrame,
@@ -138,10 +82,12 @@ namespace vc
         // RenderContext::BeginFrame() and RenderContext::EndFrame().
         if (Application::Get().IsRunning())
         {
+            ENG_PROFILE_ZONE("Render ImGui");
             ENG_GET_FUNC_VK_EXT(vkCmdSetPolygonModeEXT);
             vkCmdSetPolygonModeEXT(commandBuffer, VK_POLYGON_MODE_FILL);
             m_ImGuiRenderContext->BeginFrame();
             OnImGuiRender();
+            ENG_PROFILE_GPU_ZONE(context, commandBuffer, "ImGui");
             m_ImGuiRenderContext->EndFrame(commandBuffer);
         }
 
@@ -162,6 +108,10 @@ namespace vc
             {
                 case Keycode::F1: m_WorldRenderer->ReloadShaders(); break;
                 case Keycode::F2: m_WorldRenderer->ToggleWireframe(); break;
+                case Keycode::F4: m_WorldRenderer->ToggleVertexPulling(); break;
+#if ENG_ENABLE_PROFILING
+                case Keycode::F3: Profiler::WriteChromeTrace("VulkanCraft.trace.json"); break;
+#endif
             }
         }
     }
@@ -181,31 +131,56 @@ namespace vc
             constexpr ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp;
             if (ImGui::BeginTable("world renderer statistics table", 2, tableFlags))
             {
-                auto tableEntry = [](small_string_view name, small_string_view value)
+                auto tableName = [](char const* name)
                 {
                     ImGui::TableNextColumn();
-                    ImGui::Text(name.data());
+                    ImGui::TextUnformatted(name);
                     ImGui::TableNextColumn();
-                    ImGui::Text(value.data());
                 };
-                small_string indirectDrawCallCount = std::to_string(m_WorldRendererStatistics.IndirectDrawCallCount);
-                small_string instanceCount = std::to_string(m_WorldRendererStatistics.InstanceCount);
-                small_string chunkCount = std::to_string(m_WorldRendererStatistics.ChunkCount);
-                small_string usedVertexBufferSize = std::to_string(m_WorldRendererStatistics.UsedVertexBufferSize);
-                small_string usedUniformBufferSize = std::to_string(m_WorldRendererStatistics.UsedUniformBufferSize);
-                small_string usedStorageBufferSize = std::to_string(m_WorldRendererStatistics.UsedStorageBufferSize);
-                small_string usedIndirectBufferSize = std::to_string(m_WorldRendererStatistics.UsedIndirectBufferSize);
-                tableEntry("Indirect Draw Call Count", indirectDrawCallCount);
-                tableEntry("Instance Count", instanceCount);
-                tableEntry("Chunk Count", chunkCount);
-                tableEntry("Used Vertex Buffer Size", usedVertexBufferSize);
-                tableEntry("Used Uniform Buffer Size", usedUniformBufferSize);
-                tableEntry("Used Storage Buffer Size", usedStorageBufferSize);
-                tableEntry("Used Indirect Buffer Size", usedIndirectBufferSize);
+                // Formatted straight into ImGui's buffer, so nothing is allocated per frame.
+                tableName("Vertex Pulling");
+                ImGui::TextUnformatted(m_WorldRendererStatistics.VertexPulling ? "On" : "Off");
+                tableName("Indirect Draw Call Count");
+                ImGui::Text("%u", m_WorldRendererStatistics.IndirectDrawCallCount);
+                tableName("Instance Count");
+                ImGui::Text("%u", m_WorldRendererStatistics.InstanceCount);
+                tableName("Drawn Instance Count");
+                ImGui::Text("%u", m_WorldRendererStatistics.DrawnInstanceCount);
+                tableName("Chunk Count");
+                ImGui::Text("%u", m_WorldRendererStatistics.ChunkCount);
+                tableName("Deferred Chunk Mesh Count");
+                ImGui::Text("%u", m_WorldRendererStatistics.DeferredChunkMeshCount);
+                tableName("Sorted Super Chunk Count");
+                ImGui::Text("%u", m_WorldRendererStatistics.SortedSuperChunkCount);
+                tableName("Used Vertex Buffer Size");
+                ImGui::Text("%llu", (unsigned long long)m_WorldRendererStatistics.UsedVertexBufferSize);
+                tableName("Used Uniform Buffer Size");
+                ImGui::Text("%llu", (unsigned long long)m_WorldRendererStatistics.UsedUniformBufferSize);
+                tableName("Used Storage Buffer Size");
+                ImGui::Text("%llu", (unsigned long long)m_WorldRendererStatistics.UsedStorageBufferSize);
+                tableName("Used Indirect Buffer Size");
+                ImGui::Text("%llu", (unsigned long long)m_WorldRendererStatistics.UsedIndirectBufferSize);
+
+                // Timings of the most recent frame the GPU has finished.
+                auto& gpuProfiler = Layer::GetWindow().GetRenderContext().GetGPUProfiler();
+                if (not gpuProfiler.IsSupported())
+                {
+                    tableName("GPU Time");
+                    ImGui::TextUnformatted("Unsupported");
+                }
+                for (auto& zone : gpuProfiler.GetResults())
+                {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("GPU Time: %.*s", i32(zone.Name.size()), zone.Name.data());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f ms", zone.Milliseconds);
+                }
+                ImGui::EndTable();
             }
-            ImGui::EndTable();
         }
         ImGui::End();
+
+        m_MetricsPanel.OnImGuiRender();
     }
 
     void VulkanCraftLayer::CreateRenderPass()
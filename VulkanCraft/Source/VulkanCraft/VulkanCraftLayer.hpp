@@ -3,9 +3,11 @@
 #include "VulkanCraft/Input/CameraController.hpp"
 #include "VulkanCraft/UI/ImGuiRenderContext.hpp"
 #include "VulkanCraft/UI/ImGuiHelper.hpp"
+#include "VulkanCraft/UI/MetricsPanel.hpp"
 #include "VulkanCraft/World/World.hpp"
 #include "VulkanCraft/World/BlockRegistry.hpp"
 #include "VulkanCraft/World/ChunkGenerator.hpp"
+#include "VulkanCraft/World/ChunkStorage.hpp"
 #include "VulkanCraft/Rendering/WorldRenderer.hpp"
 #include <Engine.hpp>
 #include <memory>
@@ -33,6 +35,12 @@ namespace vc
         void CreateRenderPass();
         void CreateOrRecreateFramebuffers();
     private:
+        // In chunks.
+        static constexpr u32 s_HorizontalRenderDistance = 8;
+        static constexpr u32 s_VerticalRenderDistance = 8;
+        static constexpr char const* s_SaveDirectory = "Saves/World";
+        static constexpr u64 s_WorldSeed = 0;
+
         // TODO: there really needs to be some kind of allocator/ref system so new isn't
         // called that frequently (also increases cache performance).
         // It would have a section for temp allocations too? like scope-wise temp allocations.
@@ -44,8 +52,12 @@ namespace vc
 
         std::unique_ptr<ImGuiRenderContext> m_ImGuiRenderContext;
         std::unique_ptr<ImGuiHelper> m_ImGuiHelper;
+        FileIOService m_FileIO{2};
+        MetricsPanel m_MetricsPanel{m_FileIO};
 
         std::unique_ptr<BlockRegistry> m_Blocks;
+        // Outlives the world and generator, which save to it.
+        std::unique_ptr<ChunkStorage> m_ChunkStorage;
         std::unique_ptr<World> m_World;
         std::unique_ptr<WorldRenderer> m_WorldRenderer;
         std::unique_ptr<ChunkGenerator> m_ChunkGenerator;
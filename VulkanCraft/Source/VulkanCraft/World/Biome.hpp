@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Engine.hpp>
+
+using namespace eng;
+
+namespace vc
+{
+    ENG_DEFINE_BOUNDED_ENUM(
+        Biome, u8,
+
+        Plains,    // Deep dirt under grass.
+        Hills,     // Thin dirt under grass.
+        Mountains, // Bare stone above the tree line.
+    );
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "VulkanCraft/World/Block.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+#include <bit>
+#include <limits>
+#include <optional>
+
+using namespace eng;
+
+namespace vc
+{
+    struct RaycastHit
+    {
+        ivec3 BlockPos;
+        ivec3 Normal;   // Of the face the ray entered through, or zero if the ray started inside the block.
+        f32 Distance;   // Along the ray to where it entered the block.
+        BlockID BlockID;
+    };
+
+    // Block queries over any chunk storage, given as a function from a chunk position to a
+    // Chunk const*, or nullptr if that chunk isn't loaded. Chunks are only looked up when a
+    // query crosses into them, never per block.
+    class BlockQuery
+    {
+        ENG_STATIC_CLASS(BlockQuery);
+    public:
+        static constexpr i32 ChunkShift = std::countr_zero(Chunk::Size);
+
+        static ChunkPos GetChunkPos(ivec3 blockPos) noexcept { return blockPos >> ChunkShift; }
+        static uvec3 GetLocalBlockPos(ivec3 blockPos) noexcept { return uvec3(blockPos & i32(Chunk::Size - 1)); }
+
+        // Returns the block at the given world position, or void if its chunk isn't loaded.
+        template <typename GetChunk>
+        static BlockID GetBlock(GetChunk const& getChunk, ivec3 blockPos)
+        {
+            if (Chunk const* chunk = getChunk(GetChunkPos(blockPos)))
+                return chunk->GetBlock(GetLocalBlockPos(blockPos));
+            return BlockID(0);
+        }
+
+        // Steps through every block along the ray with a 3D DDA, until isHit(BlockID) returns true
+        // or maxDistance is passed. Blocks in unloaded chunks never hit.
+        template <typename GetChunk, typename IsHit>
+        static std::optional<RaycastHit> Raycast(GetChunk const& getChunk, vec3 origin, vec3 direction, f32 maxDistance, IsHit const& isHit)
+        {
+            if (glm::dot(direction, direction) == 0.0f)
+                return std::nullopt;
+            direction = glm::normalize(direction);
+
+            constexpr f32 infinity = std::numeric_limits<f32>::infinity();
+            ivec3 blockPos = glm::floor(origin);
+            ivec3 step{};
+            vec3 distanceDelta{infinity};  // Distance along the ray to cross one block on each axis.
+            vec3 distanceToNext{infinity}; // Distance along the ray to the next block boundary on each axis.
+            for (i32 axis = 0; axis < 3; axis++)
+            {
+                if (direction[axis] > 0.0f)
+                {
+                    step[axis] = 1;
+                    distanceDelta[axis] = 1.0f / direction[axis];
+                    distanceToNext[axis] = (f32(blockPos[axis] + 1) - origin[axis]) * distanceDelta[axis];
+                }
+                else if (direction[axis] < 0.0f)
+                {
+                    step[axis] = -1;
+                    distanceDelta[axis] = -1.0f / direction[axis];
+                    distanceToNext[axis] = (origin[axis] - f32(blockPos[axis])) * distanceDelta[axis];
+                }
+            }
+
+            ivec3 normal{};
+            f32 distance = 0.0f;
+            ChunkPos chunkPos = GetChunkPos(blockPos);
+            Chunk const* chunk = getChunk(chunkPos);
+            while (distance <= maxDistance)
+            {
+                if (ChunkPos blockChunkPos = GetChunkPos(blockPos); blockChunkPos != chunkPos)
+                {
+                    chunkPos = blockChunkPos;
+                    chunk = getChunk(chunkPos);
+                }
+
+                if (chunk)
+                {
+                    BlockID blockID = chunk->GetBlock(GetLocalBlockPos(blockPos));
+                    if (isHit(blockID))
+                        return RaycastHit{blockPos, normal, distance, blockID};
+                }
+
+                // Step to the closest block boundary.
+                i32 axis = distanceToNext.x < distanceToNext.y ?
+                    (distanceToNext.x < distanceToNext.z ? 0 : 2) :
+                    (distanceToNext.y < distanceToNext.z ? 1 : 2);
+                blockPos[axis] += step[axis];
+                distance = distanceToNext[axis];
+                distanceToNext[axis] += distanceDelta[axis];
+                normal = {};
+                normal[axis] = -step[axis];
+            }
+            return std::nullopt;
+        }
+
+        // Calls callback(ivec3 blockPos, BlockID) for every block in the inclusive box, chunk by chunk.
+        // Blocks in unloaded chunks are skipped.
+        template <typename GetChunk, typename Callback>
+        static void ForEachBlock(GetChunk const& getChunk, ivec3 minBlockPos, ivec3 maxBlockPos, Callback const& callback)
+        {
+            ChunkPos minChunkPos = GetChunkPos(minBlockPos);
+            ChunkPos maxChunkPos = GetChunkPos(maxBlockPos);
+            for (i32 chunkZ = minChunkPos.z; chunkZ <= maxChunkPos.z; chunkZ++)
+            {
+                for (i32 chunkY = minChunkPos.y; chunkY <= maxChunkPos.y; chunkY++)
+                {
+                    for (i32 chunkX = minChunkPos.x; chunkX <= maxChunkPos.x; chunkX++)
+                    {
+                        ChunkPos chunkPos{chunkX, chunkY, chunkZ};
+                        Chunk const* chunk = getChunk(chunkPos);
+                        if (not chunk)
+                            continue;
+
+                        // The part of the box inside this chunk.
+                        ivec3 chunkMinBlockPos = chunkPos * i32(Chunk::Size);
+                        ivec3 begin = glm::max(minBlockPos, chunkMinBlockPos);
+                        ivec3 end = glm::min(maxBlockPos, chunkMinBlockPos + i32(Chunk::Size - 1));
+                        for (i32 z = begin.z; z <= end.z; z++)
+                            for (i32 y = begin.y; y <= end.y; y++)
+                                for (i32 x = begin.x; x <= end.x; x++)
+                                    callback(ivec3{x, y, z}, chunk->GetBlock(GetLocalBlockPos({x, y, z})));
+                    }
+                }
+            }
+        }
+    };
+}
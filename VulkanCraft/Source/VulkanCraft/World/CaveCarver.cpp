@@ -0,0 +1,102 @@
+#include "CaveCarver.hpp"
+#include "VulkanCraft/World/SeededRandom.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace vc
+{
+    // Shape of the worms, in blocks and radians.
+    static constexpr u32 s_MaxWormsPerRegion = 3;
+    static constexpr u32 s_MinWormSteps = 12;
+    static constexpr u32 s_MaxWormSteps = 28;
+    static constexpr f32 s_WormStepLength = 2.0f;
+    static constexpr f32 s_MinWormRadius = 1.5f;
+    static constexpr f32 s_MaxWormRadius = 3.5f;
+    static constexpr f32 s_MaxWormPitch = 0.6f;
+
+    // Worms start inside their region, so this keeps them within the adjacent regions.
+    static_assert(f32(s_MaxWormSteps) * s_WormStepLength + s_MaxWormRadius < f32(CaveCarver::RegionBlockSize));
+
+    CaveCarver::CaveCarver(u64 seed)
+        : m_Seed(SeededRandom::SplitMix64(seed ^ 0xCA7EC0DE))
+    {
+
+    }
+
+    void CaveCarver::TraceRegion(ivec3 regionPos, CaveRegion& region) const
+    {
+        ENG_PROFILE_FUNCTION();
+
+        SeededRandom random{m_Seed ^ (u64(u32(regionPos.x)) << 40) ^ (u64(u32(regionPos.y)) << 20) ^ u64(u32(regionPos.z))};
+        random.NextU32(); // Spread the region position through the state before anything is drawn.
+
+        u32 wormCount = random.NextU32() % (s_MaxWormsPerRegion + 1);
+        for (u32 worm = 0; worm < wormCount; worm++)
+        {
+            vec3 position = vec3{random.NextF32(), random.NextF32(), random.NextF32()} * f32(RegionBlockSize);
+            f32 yaw = random.NextF32() * 2.0f * std::numbers::pi_v<f32>;
+            f32 pitch = random.NextSigned() * 0.25f;
+            f32 yawVelocity = 0.0f;
+            f32 pitchVelocity = 0.0f;
+            f32 radius = s_MinWormRadius + (s_MaxWormRadius - s_MinWormRadius) * random.NextF32();
+            u32 stepCount = s_MinWormSteps + random.NextU32() % (s_MaxWormSteps - s_MinWormSteps + 1);
+
+            for (u32 step = 0; step < stepCount; step++)
+            {
+                // Narrow at the ends, so tunnels don't stop in a flat wall.
+                f32 taper = 0.5f + 0.5f * std::sin(std::numbers::pi_v<f32> * f32(step + 1) / f32(stepCount + 1));
+                vec3 direction{std::cos(pitch) * std::cos(yaw), std::sin(pitch), std::cos(pitch) * std::sin(yaw)};
+                vec3 next = position + direction * s_WormStepLength;
+                region.Segments.push_back({position, next, radius * taper});
+                position = next;
+
+                // Wander smoothly, and mostly horizontally.
+                yaw += yawVelocity;
+                pitch = std::clamp(pitch * 0.9f + pitchVelocity, -s_MaxWormPitch, s_MaxWormPitch);
+                yawVelocity = yawVelocity * 0.75f + random.NextSigned() * 0.2f;
+                pitchVelocity = pitchVelocity * 0.75f + random.NextSigned() * 0.1f;
+            }
+        }
+    }
+
+    void CaveCarver::Carve(ChunkPos chunkPos, ivec3 regionPos, CaveRegion const& region, CarveMask& mask)
+    {
+        // The region's origin relative to the chunk's is exact, so precision doesn't drop far from the world's origin.
+        vec3 offset = (regionPos * RegionSize - chunkPos) * i32(Chunk::Size);
+
+        for (CaveSegment const& segment : region.Segments)
+        {
+            vec3 start = segment.Start + offset;
+            vec3 end = segment.End + offset;
+
+            // Skip segments whose bounds don't touch the chunk.
+            vec3 lower = glm::min(start, end) - segment.Radius;
+            vec3 upper = glm::max(start, end) + segment.Radius;
+            if (glm::any(glm::greaterThanEqual(lower, vec3(Chunk::Size))) or glm::any(glm::lessThan(upper, vec3(0.0f))))
+                continue;
+
+            ivec3 begin = glm::max(ivec3(glm::floor(lower)), ivec3(0));
+            ivec3 last = glm::min(ivec3(glm::floor(upper)), ivec3(Chunk::Size - 1));
+            vec3 axis = end - start;
+            f32 inverseLengthSquared = 1.0f / glm::dot(axis, axis);
+            f32 radiusSquared = segment.Radius * segment.Radius;
+
+            // Carve the blocks whose centers are inside the capsule.
+            for (i32 z = begin.z; z <= last.z; z++)
+            {
+                for (i32 y = begin.y; y <= last.y; y++)
+                {
+                    for (i32 x = begin.x; x <= last.x; x++)
+                    {
+                        vec3 center = vec3(x, y, z) + 0.5f;
+                        f32 t = std::clamp(glm::dot(center - start, axis) * inverseLengthSquared, 0.0f, 1.0f);
+                        vec3 distance = center - (start + axis * t);
+                        if (glm::dot(distance, distance) < radiusSquared)
+                            mask[Chunk::GetBlockIndex(uvec3(x, y, z))] = true;
+                    }
+                }
+            }
+        }
+    }
+}
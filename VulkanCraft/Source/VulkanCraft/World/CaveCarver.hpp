@@ -0,0 +1,53 @@
+#pragma once
+
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+#include <array>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    // A straight piece of a worm tunnel: a capsule between two points, relative to its region's origin.
+    struct CaveSegment
+    {
+        vec3 Start;
+        vec3 End;
+        f32 Radius;
+    };
+
+    // The worm tunnels that start in a region.
+    struct CaveRegion
+    {
+        std::vector<CaveSegment> Segments;
+    };
+
+    // Seeded worm tunnels. Worms are traced a whole region of chunks at a time, from the seed and the
+    // region position alone, and never reach further than one region from where they start. A chunk
+    // only has to rasterize the segments of the regions around its own, so tunnels cross chunk borders
+    // seamlessly without the chunk ever needing its neighbours.
+    class CaveCarver
+    {
+    public:
+        static constexpr i32 RegionShift = 2;
+        static constexpr i32 RegionSize = 1 << RegionShift; // In chunks.
+        static constexpr i32 RegionBlockSize = RegionSize * i32(Chunk::Size);
+
+        // Per block in block index order; true where a tunnel is carved.
+        using CarveMask = std::array<bool, Chunk::Size3>;
+    public:
+        CaveCarver(u64 seed);
+
+        // Returns the region the chunk is in.
+        static ivec3 GetRegionPos(ChunkPos chunkPos) noexcept { return chunkPos >> RegionShift; }
+
+        void TraceRegion(ivec3 regionPos, CaveRegion& region) const;
+        // Marks the blocks of the chunk carved by the region's tunnels. Only the regions
+        // adjacent to the chunk's region, including itself, can carve it.
+        static void Carve(ChunkPos chunkPos, ivec3 regionPos, CaveRegion const& region, CarveMask& mask);
+    private:
+        u64 m_Seed;
+    };
+}
@@ -19,4 +19,19 @@ namespace vc
     {
         return m_Position;
     }
+
+    BlockStateRegistry const& Chunk::GetBlockStates() const
+    {
+        return m_BlockStates;
+    }
+
+    BlockID Chunk::GetBlock(uvec3 blockPos) const
+    {
+        return m_BlockStates.GetComponent<BlockState>(BlockStateID(GetBlockIndex(blockPos))).BlockID;
+    }
+
+    void Chunk::SetBlock(uvec3 blockPos, BlockID blockID)
+    {
+        m_BlockStates.GetComponent<BlockState>(BlockStateID(GetBlockIndex(blockPos))).BlockID = blockID;
+    }
 }
@@ -22,6 +22,15 @@ namespace vc
         ~Chunk();
 
         ChunkPos GetPosition() const;
+        BlockStateRegistry const& GetBlockStates() const;
+
+        // Block positions are local to the chunk.
+        BlockID GetBlock(uvec3 blockPos) const;
+        // Chunks are shared with worker threads once they're in the world, so only
+        // set blocks on a chunk that isn't shared yet, e.g. a fresh copy.
+        void SetBlock(uvec3 blockPos, BlockID blockID);
+
+        static constexpr u32 GetBlockIndex(uvec3 blockPos) noexcept { return blockPos.x + blockPos.y * Size + blockPos.z * Size2; }
     private:
         BlockRegistry const& m_Blocks; // non-owning
         BlockStateRegistry m_BlockStates;
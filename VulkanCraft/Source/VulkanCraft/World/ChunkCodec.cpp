@@ -0,0 +1,115 @@
+#include "ChunkCodec.hpp"
+#include <algorithm>
+
+namespace vc
+{
+    // Encoding:
+    //  u16 RunsSize  Size of the runs before LZ compression.
+    //  LZ compressed runs of indices, in column order, i.e. z, then x, then y:
+    //      u8 Length - 1
+    //      u8 or u16 Index  u8 if the palette has at most 256 blocks.
+
+    static constexpr u32 s_MaxRunLength = 256;
+    static constexpr u32 s_MaxRunsSize = Chunk::Size3 * (sizeof(u8) + sizeof(u16));
+
+    // Maps an index in column order to the block index.
+    static u32 GetColumnBlockIndex(u32 columnIndex) noexcept
+    {
+        u32 y = columnIndex & (Chunk::Size - 1);
+        u32 x = (columnIndex / Chunk::Size) & (Chunk::Size - 1);
+        u32 z = columnIndex / Chunk::Size2;
+        return Chunk::GetBlockIndex({x, y, z});
+    }
+
+    void PalettedBlocks::Assign(BlockStateRegistry const& blockStates)
+    {
+        static constexpr u16 s_NoPaletteIndex = u16(-1);
+
+        Palette.clear();
+        // Block IDs are registry indices, so they're small enough to map directly.
+        std::vector<u16> paletteIndices;
+        for (u32 i = 0; i < Chunk::Size3; i++)
+        {
+            u32 blockID = u32(blockStates.GetComponent<BlockState>(BlockStateID(i)).BlockID);
+            if (blockID >= paletteIndices.size())
+                paletteIndices.resize(blockID + 1, s_NoPaletteIndex);
+            if (paletteIndices[blockID] == s_NoPaletteIndex)
+            {
+                paletteIndices[blockID] = u16(Palette.size());
+                Palette.push_back(BlockID(blockID));
+            }
+            Indices[i] = paletteIndices[blockID];
+        }
+    }
+
+    void PalettedBlocks::CreateBlockStates(BlockStateRegistry& blockStates) const
+    {
+        for (u16 index : Indices)
+            blockStates.CreateBlockState(Palette[index]);
+    }
+
+    void ChunkCodec::Encode(PalettedBlocks const& blocks, std::vector<u8>& bytes)
+    {
+        bool wideIndices = blocks.Palette.size() > 256;
+
+        std::array<u8, s_MaxRunsSize> runs;
+        u32 runsSize = 0;
+        for (u32 columnIndex = 0; columnIndex < Chunk::Size3;)
+        {
+            u16 index = blocks.Indices[GetColumnBlockIndex(columnIndex)];
+            u32 length = 1;
+            while (length < s_MaxRunLength and columnIndex + length < Chunk::Size3 and
+                blocks.Indices[GetColumnBlockIndex(columnIndex + length)] == index)
+                length++;
+            columnIndex += length;
+
+            runs[runsSize++] = u8(length - 1);
+            runs[runsSize++] = u8(index);
+            if (wideIndices)
+                runs[runsSize++] = u8(index >> 8);
+        }
+
+        bytes.push_back(u8(runsSize));
+        bytes.push_back(u8(runsSize >> 8));
+        LZ::Compress({runs.data(), runsSize}, bytes);
+    }
+
+    bool ChunkCodec::Decode(std::span<u8 const> bytes, PalettedBlocks& blocks)
+    {
+        bool wideIndices = blocks.Palette.size() > 256;
+        u32 paletteSize = u32(blocks.Palette.size());
+
+        if (bytes.size() < sizeof(u16))
+            return false;
+        u32 runsSize = u32(bytes[0]) | u32(bytes[1]) << 8;
+        if (runsSize > s_MaxRunsSize)
+            return false;
+
+        std::array<u8, s_MaxRunsSize> runs;
+        if (not LZ::Decompress(bytes.subspan(sizeof(u16)), {runs.data(), runsSize}))
+            return false;
+
+        // Runs are written straight into block index order, a column at a time.
+        u32 runSize = wideIndices ? 3 : 2;
+        u32 columnIndex = 0;
+        for (u32 i = 0; i + runSize <= runsSize; i += runSize)
+        {
+            u32 length = u32(runs[i]) + 1;
+            u16 index = wideIndices ? u16(runs[i + 1] | runs[i + 2] << 8) : runs[i + 1];
+            if (index >= paletteSize or columnIndex + length > Chunk::Size3)
+                return false;
+
+            while (length > 0)
+            {
+                u32 y = columnIndex & (Chunk::Size - 1);
+                u32 count = std::min(length, Chunk::Size - y);
+                u16* column = blocks.Indices.data() + GetColumnBlockIndex(columnIndex);
+                for (u32 j = 0; j < count; j++)
+                    column[j * Chunk::Size] = index;
+                columnIndex += count;
+                length -= count;
+            }
+        }
+        return columnIndex == Chunk::Size3 and runsSize % runSize == 0;
+    }
+}
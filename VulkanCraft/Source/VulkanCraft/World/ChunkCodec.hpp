@@ -0,0 +1,38 @@
+#pragma once
+
+#include "VulkanCraft/World/BlockStateRegistry.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include <Engine.hpp>
+#include <array>
+#include <span>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    // A chunk's blocks as indices into a palette of the blocks it has.
+    struct PalettedBlocks
+    {
+        std::vector<BlockID> Palette;             // In order of first appearance.
+        std::array<u16, Chunk::Size3> Indices;   // In block index order.
+
+        void Assign(BlockStateRegistry const& blockStates);
+        // Creates every block state, in block index order, into an empty registry.
+        void CreateBlockStates(BlockStateRegistry& blockStates) const;
+    };
+
+    // Compression for palette indexed chunk blocks.
+    // Blocks are run-length encoded along the Y axis, where terrain changes least, and the runs
+    // are compressed with LZ, which catches columns repeating each other.
+    class ChunkCodec
+    {
+        ENG_STATIC_CLASS(ChunkCodec);
+    public:
+        // Appends the compressed indices to bytes.
+        static void Encode(PalettedBlocks const& blocks, std::vector<u8>& bytes);
+        // Decompresses the indices, and checks they're within the palette, which must already be set.
+        // Returns true if they were decompressed, or false if bytes are invalid.
+        ENG_NO_DISCARD static bool Decode(std::span<u8 const> bytes, PalettedBlocks& blocks);
+    };
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "VulkanCraft/Rendering/ChunkMeshData.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+
+using namespace eng;
+
+namespace vc
+{
+    ENG_DEFINE_BOUNDED_ENUM(
+        ChunkEventType, u8,
+
+        Added,    // The chunk's block data was loaded.
+        Remeshed, // The chunk has a new mesh, including its first one.
+        Removed,  // The chunk was unloaded.
+    );
+
+    // A change to a chunk, published by the world in the order the changes happened.
+    struct ChunkEvent
+    {
+        ChunkEventType Type;
+        ChunkPos ChunkPos;
+        u64 Sequence;       // Increases with every event the world publishes.
+        ChunkMeshData Mesh; // Only for Remeshed.
+    };
+}
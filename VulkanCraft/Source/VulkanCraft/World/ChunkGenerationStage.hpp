@@ -11,10 +11,10 @@ namespace vc
 
         StoneMap,   // Initial stone map.
         Topsoil,    // Replace some top layers of stone with dirt/sandstone/biome-specific blocks.
-        //Caves,      // Caves.
+        Caves,      // Noise caves and worm tunnels.
         Surface,    // Replace fewer top layers of topsoil with grass/sand/bione-specific blocks.
-        //Structures, // Villages, sea temples, mineshafts, etc.
-        //Features,   // Trees, cacti, stumps/fallen trees?
+        Structures, // Villages, sea temples, mineshafts, etc.
+        Features,   // Trees, cacti, stumps/fallen trees?
         //Foliage,    // Flowers, short/tall grass, other small blocks.
 
         Mesh,       // A renderable mesh once world generation is complete.
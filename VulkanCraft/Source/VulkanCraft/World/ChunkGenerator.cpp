@@ -1,26 +1,53 @@
 #include "ChunkGenerator.hpp"
 #include "VulkanCraft/World/Chunk.hpp"
-#include "VulkanCraft/Rendering/BlockModel.hpp"
+#include "VulkanCraft/World/ChunkCodec.hpp"
+#include "VulkanCraft/World/ChunkMesher.hpp"
+#include "VulkanCraft/World/ChunkStorage.hpp"
 
 namespace vc
 {
     // Chunk flow:
     //  QueueChunkLoads => m_QueuedChunkLoads => m_DelegatorThread
-    //  QueueChunkUnloads => m_QueuedChunkUnloads => m_DelegatorThread
-    //  QueueChunkRemeshes => m_QueuedChunkRemeshes => m_DelegatorThread
+    //  QueueChunkUnloads => m_QueuedChunkLoads => m_DelegatorThread
+    //  QueueChunkRemeshes => m_RemeshableChunks => m_WorkerThreadPool => m_GeneratedChunkMeshes
+    //  QueueChunkEdits => m_QueuedChunkEdits => m_DelegatorThread => m_EditedChunks => m_ChunkStageCache
     //
-    //  m_DelegatorThread => LoadChunk or UnloadChunk or RemeshChunk
+    //  m_DelegatorThread => LoadChunk or UnloadChunk
     //      m_PendingChunks => m_GeneratableChunks
     //      m_UnloadingChunks => /dev/null
     //
     //  LoadChunk => m_PendingChunks or m_GeneratableChunks
+    //      Saved chunks skip their prerequisites => m_GeneratableChunks => LoadStoredChunk
+    //      Reloaded chunks still in m_ChunkStageCache => m_GeneratableChunks => OutputCachedChunk => m_GeneratedChunks
     //  UnloadChunk => m_UnloadingChunks => m_DelegatorThread
-    //  RemeshChunk => TODO
     //
-    //  m_GeneratableChunks => m_WorkerThreadPool => m_GeneratedChunks and m_GeneratedChunkMeshes and m_ChunkStageCache
+    //  m_GeneratableChunks => m_WorkerThreadPool (in batches) => m_GeneratedChunks and m_GeneratedChunkMeshes and m_ChunkStageCache
+    //      Workers reserve slots in m_GeneratedChunks or m_GeneratedChunkMeshes first, and wait while they're full
+    //      Newly generated chunks => m_ChunkStorage
     //      m_GeneratedChunks => ConsumeGeneratedChunks
     //      m_GeneratedChunkMeshes => ConsumeGeneratedChunkMeshes
     //      m_ChunkStageCache => LoadChunk
+    //      Unused m_ChunkStageCache entries => CompressColdChunkStages => GetPrerequisites decompresses them
+    //      Terrain stages => GetTerrainColumn => m_TerrainColumns => EvictColdGenerationCaches
+    //      Cave stages => GetCaveRegion => m_CaveRegions => EvictColdGenerationCaches
+    //      Structure and feature stages => GetPlacementRegion => m_PlacementRegions => EvictColdGenerationCaches
+
+    // How many delegator iterations a cache entry goes unused for before it's compressed,
+    // and how often entries are checked.
+    static constexpr u64 s_ColdChunkStageAge = 256;
+    static constexpr u64 s_ColdChunkStageCheckInterval = 64;
+    // The same for terrain columns and cave and placement regions, which are evicted instead.
+    static constexpr u64 s_ColdGenerationCacheAge = 256;
+    // Noise caves are kept this many blocks under the surface, so they don't pock it. Worms are free to break through it.
+    static constexpr i32 s_NoiseCaveRoofDepth = 6;
+
+    // How many chunks and meshes can wait to be consumed before workers stop generating more.
+    static constexpr u64 s_GeneratedChunkCapacity = 4096;
+    static constexpr u64 s_GeneratedChunkMeshCapacity = 2048;
+
+    // Batches are taken from aligned blocks of this many chunks on each axis, so the chunks
+    // in a batch share terrain columns and cave and placement regions.
+    static constexpr i32 s_BatchBlockSize = 4;
 
     // Define a bunch of chunk generation stage prerequisites.
 
@@ -37,20 +64,29 @@ namespace vc
     // No prerequisites for the first stage, otherwise nothing would ever be generated.
     static constexpr std::array<PrerequisiteData, 0> s_StoneMapPrerequisiteData{};
 
+    // Surface stages find the surface from the terrain column instead of the chunk above.
     static constexpr auto s_TopsoilPrerequisiteData = std::to_array<PrerequisiteData>({
         {{0, 0, 0}, ChunkGenerationStage::Topsoil - 1, true},
-        {{0, 1, 0}, ChunkGenerationStage::Topsoil - 1, true},
     });
 
-    // TODO: s_CaveStagePrerequisites
+    // Worms come from cached cave regions instead of neighbouring chunks.
+    static constexpr auto s_CavePrerequisiteData = std::to_array<PrerequisiteData>({
+        {{0, 0, 0}, ChunkGenerationStage::Caves - 1, true},
+    });
 
     static constexpr auto s_SurfacePrerequisiteData = std::to_array<PrerequisiteData>({
         {{0, 0, 0}, ChunkGenerationStage::Surface - 1, true},
-        {{0, 1, 0}, ChunkGenerationStage::Surface - 1, true},
     });
 
-    // TODO: s_StructureStagePrerequisites
-    // TODO: s_FeatureStagePrerequisites
+    // Placements come from cached placement regions instead of neighbouring chunks.
+    static constexpr auto s_StructurePrerequisiteData = std::to_array<PrerequisiteData>({
+        {{0, 0, 0}, ChunkGenerationStage::Structures - 1, true},
+    });
+
+    static constexpr auto s_FeaturePrerequisiteData = std::to_array<PrerequisiteData>({
+        {{0, 0, 0}, ChunkGenerationStage::Features - 1, true},
+    });
+
     // TODO: s_FoliageStagePrerequisites
 
     static constexpr auto s_MeshPrerequisiteData = std::to_array<PrerequisiteData>({
@@ -66,16 +102,24 @@ namespace vc
     static constexpr auto s_PrerequisiteData = std::to_array({
         std::span{s_StoneMapPrerequisiteData.data(), s_StoneMapPrerequisiteData.size()},
         std::span{s_TopsoilPrerequisiteData.data(), s_TopsoilPrerequisiteData.size()},
-        //std::span{s_CavePrerequisiteData.data(), s_CavePrerequisiteData.size()},
+        std::span{s_CavePrerequisiteData.data(), s_CavePrerequisiteData.size()},
         std::span{s_SurfacePrerequisiteData.data(), s_SurfacePrerequisiteData.size()},
-        //std::span{s_StructurePrerequisiteData.data(), s_StructurePrerequisiteData.size()},
-        //std::span{s_FeaturePrerequisiteData.data(), s_FeaturePrerequisiteData.size()},
+        std::span{s_StructurePrerequisiteData.data(), s_StructurePrerequisiteData.size()},
+        std::span{s_FeaturePrerequisiteData.data(), s_FeaturePrerequisiteData.size()},
         //std::span{s_FoliagePrerequisiteData.data(), s_FoliagePrerequisiteData.size()},
         std::span{s_MeshPrerequisiteData.data(), s_MeshPrerequisiteData.size()},
     });
 
-    ChunkGenerator::ChunkGenerator(BlockRegistry const& blocks, u8 workerThreadCount)
+    ChunkGenerator::ChunkGenerator(BlockRegistry const& blocks, u64 seed, u8 workerThreadCount, StageTimingCallback stageTimingCallback, ChunkStorage* chunkStorage, u8 maxBatchSize)
         : m_Blocks(blocks)
+        , m_TerrainNoise(seed)
+        , m_CaveCarver(seed)
+        , m_FeaturePlacer(blocks, seed)
+        , m_StageTimingCallback(std::move(stageTimingCallback))
+        , m_ChunkStorage(chunkStorage)
+        , m_MaxBatchSize(std::max<u8>(maxBatchSize, 1))
+        , m_GeneratedChunks(s_GeneratedChunkCapacity)
+        , m_GeneratedChunkMeshes(s_GeneratedChunkMeshCapacity)
         , m_DelegatorThread([this] { DelegatorThread(); })
     {
         m_WorkerThreads.reserve(workerThreadCount);
@@ -85,56 +129,170 @@ namespace vc
 
     ChunkGenerator::~ChunkGenerator()
     {
-        m_Running.store(false, std::memory_order_relaxed);
+        // Stop running under the lock the workers wait with, so none of them miss the notification.
+        {
+            std::unique_lock lock(m_GeneratableChunkMutex);
+            m_Running.store(false, std::memory_order_relaxed);
+        }
         m_GeneratableChunkCondition.notify_all();
-        m_QueuedChunkCondition.notify_one();
+        WakeDelegator();
     }
 
-    template <typename T>
-    void ChunkGenerator::Queue(std::span<T> chunks, std::vector<T>& queuedChunks)
+    void ChunkGenerator::QueueLoadsOrUnloads(std::span<ChunkPos> chunks, bool unload)
     {
-        // Enqueue chunks.
         {
             std::unique_lock lock(m_QueuedChunkMutex);
-            queuedChunks.append_range(chunks);
+            m_QueuedChunkLoads.reserve(m_QueuedChunkLoads.size() + chunks.size());
+            for (ChunkPos chunkPos : chunks)
+                m_QueuedChunkLoads.emplace_back(chunkPos, unload);
+            m_DelegatorWakeRequested = true;
         }
-        // Tell the delegating thread there's queued chunks to process.
         m_QueuedChunkCondition.notify_one();
     }
 
     void ChunkGenerator::QueueChunkLoads(std::span<ChunkPos> chunks)
     {
-        Queue(chunks, m_QueuedChunkLoads);
+        QueueLoadsOrUnloads(chunks, false);
     }
 
     void ChunkGenerator::QueueChunkUnloads(std::span<ChunkPos> chunks)
     {
-        Queue(chunks, m_QueuedChunkUnloads);
+        QueueLoadsOrUnloads(chunks, true);
     }
 
     void ChunkGenerator::QueueChunkRemeshes(std::span<QueuedChunkRemeshData> chunks)
     {
-        Queue(chunks, m_QueuedChunkRemeshes);
+        // Remeshes skip the delegator, since they have no prerequisites and should start as soon as possible.
+        {
+            std::unique_lock lock(m_GeneratableChunkMutex);
+            m_RemeshableChunks.insert(m_RemeshableChunks.end(), chunks.begin(), chunks.end());
+        }
+        m_GeneratableChunkCondition.notify_all();
     }
 
     template<typename T>
-    void ChunkGenerator::Consume(std::function<void(T&&)> const& consumer, u64 maxCount, std::mutex& mutex, std::vector<T>& output)
+    void ChunkGenerator::Consume(std::function<void(T&&)> const& consumer, u64 maxCount, OutputQueue<T>& output)
+    {
+        // Pop the whole batch first, so workers can refill the freed slots while the consumer runs.
+        std::vector<T> values;
+        values.reserve(std::min(output.ReservedCount.load(std::memory_order_relaxed), maxCount));
+        T value;
+        while (values.size() < maxCount and output.Queue.TryPop(value))
+            values.push_back(std::move(value));
+        ReleaseOutput(output, values.size());
+
+        for (T& value : values)
+            consumer(std::move(value));
+    }
+
+    template<typename T>
+    u64 ChunkGenerator::ReserveOutput(OutputQueue<T>& output, u64 count)
+    {
+        u64 reservedCount = output.ReservedCount.load(std::memory_order_relaxed);
+        u64 reserving;
+        do
+        {
+            reserving = std::min(output.Queue.Capacity() - reservedCount, count);
+            if (reserving == 0)
+                return 0;
+        }
+        while (not output.ReservedCount.compare_exchange_weak(reservedCount, reservedCount + reserving, std::memory_order_relaxed));
+        return reserving;
+    }
+
+    template<typename T>
+    void ChunkGenerator::ReleaseOutput(OutputQueue<T>& output, u64 count)
+    {
+        if (count == 0)
+            return;
+
+        // Workers only wait for slots while the output is full. They check under the lock they wait
+        // with, so taking it before notifying means none of them can miss the notification.
+        u64 reservedCount = output.ReservedCount.fetch_sub(count, std::memory_order_relaxed);
+        if (reservedCount == output.Queue.Capacity())
+        {
+            {
+                std::unique_lock lock(m_GeneratableChunkMutex);
+            }
+            m_GeneratableChunkCondition.notify_all();
+        }
+    }
+
+    template<typename T>
+    void ChunkGenerator::PushOutput(OutputQueue<T>& output, T&& value)
+    {
+        bool pushed = output.Queue.TryPush(std::move(value));
+        ENG_ASSERT(pushed, "Pushed an output without reserving a slot for it.");
+    }
+
+    u64 ChunkGenerator::ReserveStageOutputs(ChunkGenerationStage stage, u64 count)
     {
-        std::unique_lock lock(mutex);
-        u64 count = std::min(output.size(), maxCount);
-        for (u64 i = 0; i < count; i++)
-            consumer(std::move(output[i]));
-        output.erase(output.begin(), output.begin() + count);
+        if (stage == ChunkGenerationStage::Mesh)
+            return ReserveOutput(m_GeneratedChunkMeshes, count);
+        if (stage == ChunkGenerationStage::Mesh - 1)
+            return ReserveOutput(m_GeneratedChunks, count);
+        return count; // Intermediate stages only output to the stage cache.
+    }
+
+    void ChunkGenerator::ReleaseStageOutputs(ChunkGenerationStage stage, u64 count)
+    {
+        if (stage == ChunkGenerationStage::Mesh)
+            ReleaseOutput(m_GeneratedChunkMeshes, count);
+        else if (stage == ChunkGenerationStage::Mesh - 1)
+            ReleaseOutput(m_GeneratedChunks, count);
     }
 
     void ChunkGenerator::ConsumeGeneratedChunks(std::function<void(std::shared_ptr<Chunk>&&)> const& consumer, u64 maxCount)
     {
-        Consume(consumer, maxCount, m_GeneratedChunkMutex, m_GeneratedChunks);
+        Consume(consumer, maxCount, m_GeneratedChunks);
     }
 
     void ChunkGenerator::ConsumeGeneratedChunkMeshes(std::function<void(ChunkMeshData&&)> const& consumer, u64 maxCount)
     {
-        Consume(consumer, maxCount, m_GeneratedChunkMeshMutex, m_GeneratedChunkMeshes);
+        Consume(consumer, maxCount, m_GeneratedChunkMeshes);
+    }
+
+    void ChunkGenerator::WakeDelegator()
+    {
+        {
+            std::unique_lock lock(m_QueuedChunkMutex);
+            m_DelegatorWakeRequested = true;
+        }
+        m_QueuedChunkCondition.notify_one();
+    }
+
+    ChunkGenerator::StageGauges ChunkGenerator::GetStageGauges(small_string_view queueName)
+    {
+        StageGauges gauges;
+        for (ChunkGenerationStage stage : ChunkGenerationStages)
+            gauges[stage.Index()] = &Metrics::GetGauge(fmt::format("chunk_generator.{}.{}", queueName, stage.Name()));
+        return gauges;
+    }
+
+    void ChunkGenerator::UpdateMetrics()
+    {
+        std::array<i64, ChunkGenerationStage::_Count> pendingCounts{};
+        for (ChunkStageKey key : m_PendingChunks)
+            pendingCounts[key.Stage.Index()]++;
+
+        std::array<i64, ChunkGenerationStage::_Count> generatableCounts{};
+        {
+            std::unique_lock lock(m_GeneratableChunkMutex);
+            for (auto& [key, generatableChunk] : m_GeneratableChunks)
+                generatableCounts[key.Stage.Index()]++;
+        }
+
+        for (u64 i = 0; i < ChunkGenerationStage::_Count; i++)
+        {
+            m_PendingChunkGauges[i]->Set(pendingCounts[i]);
+            m_GeneratableChunkGauges[i]->Set(generatableCounts[i]);
+        }
+
+        m_GeneratedChunkGauge.Set(i64(m_GeneratedChunks.ReservedCount.load(std::memory_order_relaxed)));
+        m_GeneratedChunkMeshGauge.Set(i64(m_GeneratedChunkMeshes.ReservedCount.load(std::memory_order_relaxed)));
+
+        std::unique_lock lock(m_ChunkStageCacheMutex);
+        m_ChunkStageCacheGauge.Set(i64(m_ChunkStageCache.size()));
     }
 
     void ChunkGenerator::DelegatorThread()
@@ -144,19 +302,23 @@ namespace vc
         while (true)
         {
             // Wait for chunks to be queued or finished generating.
-            std::vector<ChunkPos> queuedChunkLoads;
-            std::vector<ChunkPos> queuedChunkUnloads;
-            std::vector<QueuedChunkRemeshData> queuedChunkRemeshes;
+            std::vector<QueuedChunkLoad> queuedChunkLoads;
             {
                 std::unique_lock lock(m_QueuedChunkMutex);
-                m_QueuedChunkCondition.wait(lock);
+                m_QueuedChunkCondition.wait(lock, [this] { return m_DelegatorWakeRequested; });
+                m_DelegatorWakeRequested = false;
                 if (not m_Running.load(std::memory_order_relaxed))
                     break;
                 queuedChunkLoads = std::move(m_QueuedChunkLoads);
-                queuedChunkUnloads = std::move(m_QueuedChunkUnloads);
-                queuedChunkRemeshes = std::move(m_QueuedChunkRemeshes);
+                m_EditedChunks.insert(m_EditedChunks.end(), m_QueuedChunkEdits.begin(), m_QueuedChunkEdits.end());
+                m_QueuedChunkEdits.clear();
             }
 
+            ENG_PROFILE_ZONE("ChunkGenerator::Delegate");
+
+            // Replace the cached stages of edited chunks before anything new is handed the old ones.
+            std::erase_if(m_EditedChunks, [this](std::shared_ptr<Chunk const> const& chunk) { return ApplyChunkEdit(*chunk); });
+
             // Check if all currently pending chunks can now be generated.
             std::erase_if(m_PendingChunks, [this](ChunkStageKey key)
             {
@@ -185,13 +347,15 @@ namespace vc
                 return true;
             });
 
-            // Process the queued chunk loads.
-            for (ChunkPos chunkPos : queuedChunkLoads)
-                LoadChunk({chunkPos, ChunkGenerationStage::_End - 1});
-
-            // Process the queued chunk remeshes.
-            for (auto& data : queuedChunkRemeshes)
-                RemeshChunk(data.ChunkPos, data.UpdatedBlockStates);
+            // Process the queued chunk loads and unloads in order, so a chunk that's
+            // quickly unloaded and loaded again ends up in the state it was last queued for.
+            for (auto& queued : queuedChunkLoads)
+            {
+                if (queued.Unload)
+                    UnloadChunk(queued.ChunkPos);
+                else
+                    LoadChunk({queued.ChunkPos, ChunkGenerationStage::_End - 1});
+            }
 
             // Tell worker threads that there are generatable chunks.
             {
@@ -204,10 +368,6 @@ namespace vc
                     m_GeneratableChunkCondition.notify_all();
             }
 
-            // Process the queued chunk unloads.
-            for (ChunkPos chunkPos : queuedChunkUnloads)
-                UnloadChunk(chunkPos);
-
             // Unload all unused chunks.
             {
                 std::erase_if(m_UnloadingChunks, [this](ChunkPos chunkPos)
@@ -221,49 +381,273 @@ namespace vc
                             if (it->second.UsageCount != 0)
                                 inUse = true;
                             else
+                            {
+                                if (not it->second.CompressedBlockStates.empty())
+                                {
+                                    m_CompressedChunkStageGauge.Add(-1);
+                                    m_CompressedChunkStageBytesGauge.Add(-i64(it->second.CompressedBlockStates.size()));
+                                }
                                 m_ChunkStageCache.erase(it);
+                            }
                         }
                     }
                     return not inUse;
                 });
             }
+
+            u64 iteration = m_DelegatorIteration.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (iteration % s_ColdChunkStageCheckInterval == 0)
+            {
+                CompressColdChunkStages();
+                EvictColdGenerationCaches();
+            }
+
+            UpdateMetrics();
+        }
+    }
+
+    void ChunkGenerator::CompressColdChunkStages()
+    {
+        ENG_PROFILE_FUNCTION();
+
+        // Find the entries that have gone unused for a while.
+        u64 iteration = m_DelegatorIteration.load(std::memory_order_relaxed);
+        std::vector<ChunkStageData*> coldStages;
+        {
+            std::unique_lock lock(m_ChunkStageCacheMutex);
+            for (auto& [key, stageData] : m_ChunkStageCache)
+                if (stageData.UsageCount == 0 and stageData.CompressedBlockStates.empty() and stageData.LastUsedIteration + s_ColdChunkStageAge < iteration)
+                    coldStages.push_back(&stageData);
+        }
+
+        // Only the delegator uses or erases unused entries, and cache nodes never move,
+        // so they can be compressed without holding the lock.
+        PalettedBlocks blocks;
+        for (ChunkStageData* stageData : coldStages)
+        {
+            blocks.Assign(stageData->BlockStates);
+            ChunkCodec::Encode(blocks, stageData->CompressedBlockStates);
+            stageData->CompressedPalette = std::move(blocks.Palette);
+            stageData->BlockStates = {};
+            m_CompressedChunkStageGauge.Add(1);
+            m_CompressedChunkStageBytesGauge.Add(i64(stageData->CompressedBlockStates.size()));
         }
     }
 
+    void ChunkGenerator::EvictColdGenerationCaches()
+    {
+        ENG_PROFILE_FUNCTION();
+
+        u64 iteration = m_DelegatorIteration.load(std::memory_order_relaxed);
+        m_TerrainColumnGauge.Set(i64(m_TerrainColumns.EvictCold(iteration, s_ColdGenerationCacheAge)));
+        m_CaveRegionGauge.Set(i64(m_CaveRegions.EvictCold(iteration, s_ColdGenerationCacheAge)));
+        m_PlacementRegionGauge.Set(i64(m_PlacementRegions.EvictCold(iteration, s_ColdGenerationCacheAge)));
+    }
+
+    std::shared_ptr<TerrainColumn const> ChunkGenerator::GetTerrainColumn(ChunkPos chunkPos)
+    {
+        u64 iteration = m_DelegatorIteration.load(std::memory_order_relaxed);
+        return m_TerrainColumns.Get({chunkPos.x, 0, chunkPos.z}, iteration, [this](ChunkPos columnPos, TerrainColumn& column)
+        {
+            m_TerrainNoise.GenerateColumn(columnPos, column);
+        });
+    }
+
+    std::shared_ptr<CaveRegion const> ChunkGenerator::GetCaveRegion(ivec3 regionPos)
+    {
+        u64 iteration = m_DelegatorIteration.load(std::memory_order_relaxed);
+        return m_CaveRegions.Get(regionPos, iteration, [this](ivec3 position, CaveRegion& region)
+        {
+            m_CaveCarver.TraceRegion(position, region);
+        });
+    }
+
+    std::shared_ptr<PlacementRegion const> ChunkGenerator::GetPlacementRegion(ivec3 regionPos)
+    {
+        u64 iteration = m_DelegatorIteration.load(std::memory_order_relaxed);
+        return m_PlacementRegions.Get(regionPos, iteration, [this](ivec3 position, PlacementRegion& region)
+        {
+            m_FeaturePlacer.PlaceRegion(position, [this](ChunkPos chunkPos) { return GetTerrainColumn(chunkPos); }, region);
+        });
+    }
+
+    void ChunkGenerator::DecompressChunkStage(ChunkStageData& stageData)
+    {
+        PalettedBlocks blocks;
+        blocks.Palette = std::move(stageData.CompressedPalette);
+        bool decoded = ChunkCodec::Decode(stageData.CompressedBlockStates, blocks);
+        ENG_ASSERT(decoded, "Compressed chunk stages are only ever decoded by the generator that encoded them.");
+        blocks.CreateBlockStates(stageData.BlockStates);
+
+        m_CompressedChunkStageGauge.Add(-1);
+        m_CompressedChunkStageBytesGauge.Add(-i64(stageData.CompressedBlockStates.size()));
+        stageData.CompressedPalette = {};
+        stageData.CompressedBlockStates = {};
+    }
+
     void ChunkGenerator::WorkerThread()
     {
         ThreadTracer tracer("chunk generator worker");
 
+        std::vector<ChunkStageJob> batch;
+        batch.reserve(m_MaxBatchSize);
+
         while (true)
         {
-            // Wait for a generatable chunk to be available.
-            ChunkStageKey key;
-            GeneratableChunk generatableChunk;
+            // Wait for a remeshable or generatable chunk to be available, with room in the output for it.
+            std::optional<QueuedChunkRemeshData> remeshableChunk;
+            batch.clear();
+            u64 reservedCount = 0;
             {
-                decltype(m_GeneratableChunks)::node_type node;
+                bool running = true;
+                std::unique_lock lock(m_GeneratableChunkMutex);
+                while ((running = m_Running.load(std::memory_order_relaxed)))
                 {
-                    bool running = true, chunkAvailable = false;
-                    std::unique_lock lock(m_GeneratableChunkMutex);
-                    while ((running = m_Running.load(std::memory_order_relaxed)) and not (chunkAvailable = not m_GeneratableChunks.empty()))
-                        m_GeneratableChunkCondition.wait(lock);
+                    // Remeshes are edits the player is waiting to see, so they go first.
+                    if (not m_RemeshableChunks.empty() and ReserveOutput(m_GeneratedChunkMeshes, 1) != 0)
+                    {
+                        remeshableChunk = std::move(m_RemeshableChunks.front());
+                        m_RemeshableChunks.pop_front();
+                        break;
+                    }
 
-                    if (not running)
+                    // Hold off stages whose output is full while the consumer is behind, instead of letting
+                    // outputs pile up, but keep generating the stages that still have room.
+                    std::array<bool, ChunkGenerationStage::_Count> fullStages{};
+                    for (auto it = m_GeneratableChunks.begin(); it != m_GeneratableChunks.end(); ++it)
+                    {
+                        ChunkGenerationStage stage = it->first.Stage;
+                        if (fullStages[stage.Index()])
+                            continue;
+                        reservedCount = ReserveStageOutputs(stage, m_MaxBatchSize);
+                        if (reservedCount != 0)
+                        {
+                            TakeBatch(batch, it, reservedCount);
+                            break;
+                        }
+                        fullStages[stage.Index()] = true;
+                    }
+                    if (not batch.empty())
                         break;
 
-                    node = m_GeneratableChunks.extract(m_GeneratableChunks.begin());
+                    m_GeneratableChunkCondition.wait(lock);
+                }
+
+                if (not running)
+                    break;
+            }
+
+            // Give back the slots the batch didn't fill.
+            if (not batch.empty())
+                ReleaseStageOutputs(batch.front().Key.Stage, reservedCount - batch.size());
+
+            if (remeshableChunk)
+            {
+                ENG_PROFILE_ZONE("Remesh");
+                RemeshChunk(*remeshableChunk);
+                continue;
+            }
+
+            // Stored and cached chunks are never batched.
+            if (batch.front().Data.Stored)
+            {
+                ENG_PROFILE_ZONE("LoadStored");
+                LoadStoredChunk(batch.front());
+                continue;
+            }
+            if (batch.front().Data.Cached)
+            {
+                ENG_PROFILE_ZONE("OutputCached");
+                OutputCachedChunk(batch.front());
+                continue;
+            }
+
+            // Generate the appropriate stage of each chunk.
+            for (ChunkStageJob& job : batch)
+            {
+                auto startTime = std::chrono::steady_clock::now();
+                {
+                    ENG_PROFILE_ZONE(job.Key.Stage.Name());
+                    (this->*s_GenerationFunctions[job.Key.Stage.Index()])(job.Key, job.Data, job.Output);
+                }
+
+                if (m_StageTimingCallback)
+                {
+                    std::chrono::duration<f64> duration = std::chrono::steady_clock::now() - startTime;
+                    m_StageTimingCallback(job.Key.ChunkPos, job.Key.Stage, duration.count());
                 }
-                key = node.key();
-                generatableChunk = std::move(node.mapped());
             }
 
-            // Generate the appropriate stage.
-            Timer timer(fmt::format("ChunkGenerator(x={}, y={}, z={}, stage={})", key.ChunkPos.x, key.ChunkPos.y, key.ChunkPos.z, key.Stage.Name()));
-            (this->*s_GenerationFunctions[key.Stage.Index()])(key, generatableChunk);
+            FinishGeneratingStages(batch);
+        }
+    }
+
+    void ChunkGenerator::TakeBatch(std::vector<ChunkStageJob>& batch, GeneratableChunkMap::iterator first, u64 maxCount)
+    {
+        auto node = m_GeneratableChunks.extract(first);
+        ChunkStageKey firstKey = node.key();
+        batch.emplace_back(firstKey, std::move(node.mapped()));
+        if (batch.front().Data.Stored or batch.front().Data.Cached)
+            return;
+
+        // Fill the batch from the aligned block of chunks the first one is in, a column at a time.
+        ivec3 blockOrigin = firstKey.ChunkPos & ~(s_BatchBlockSize - 1);
+        for (i32 z = 0; z < s_BatchBlockSize; z++)
+        {
+            for (i32 x = 0; x < s_BatchBlockSize; x++)
+            {
+                for (i32 y = 0; y < s_BatchBlockSize; y++)
+                {
+                    if (batch.size() >= maxCount)
+                        return;
+
+                    node = m_GeneratableChunks.extract(ChunkStageKey{blockOrigin + ivec3{x, y, z}, firstKey.Stage});
+                    if (not node)
+                        continue;
+                    if (node.mapped().Stored or node.mapped().Cached)
+                    {
+                        m_GeneratableChunks.insert(std::move(node));
+                        continue;
+                    }
+                    batch.emplace_back(node.key(), std::move(node.mapped()));
+                }
+            }
         }
     }
 
     void ChunkGenerator::LoadChunk(ChunkStageKey key)
     {
+        CancelUnload(key.ChunkPos);
+
+        // A chunk reloaded before its final stage left the cache isn't generated again, and only its
+        // mesh would be, so it's output again from the cache.
+        if (key.Stage == ChunkGenerationStage::_End - 1)
+        {
+            ChunkStageKey finalStageKey{key.ChunkPos, ChunkGenerationStage::Mesh - 1};
+            bool cached;
+            {
+                std::unique_lock lock(m_ChunkStageCacheMutex);
+                cached = m_ChunkStageCache.contains(finalStageKey);
+            }
+            std::unique_lock lock(m_GeneratableChunkMutex);
+            if (cached and not m_GeneratableChunks.contains(finalStageKey))
+            {
+                lock.unlock();
+                // The mesh stage's first prerequisite is the chunk's own final stage.
+                auto prerequisites = GetPrerequisites(key, 1);
+                lock.lock();
+                m_GeneratableChunks.try_emplace(finalStageKey, GeneratableChunk{.Prerequisites = std::move(prerequisites), .Cached = true});
+            }
+        }
+
+        // Saved chunks are read instead of generated, so none of their earlier stages are needed.
+        if (key.Stage == ChunkGenerationStage::Mesh - 1 and m_ChunkStorage and m_ChunkStorage->Contains(key.ChunkPos))
+        {
+            std::unique_lock lock(m_GeneratableChunkMutex);
+            m_GeneratableChunks.try_emplace(key, GeneratableChunk{.Stored = true});
+            return;
+        }
+
         // Make sure all required prerequisites are satisfied first.
         bool allPrerequisitesSatisfied = true;
         for (auto& prerequisite : s_PrerequisiteData[key.Stage.Index()])
@@ -276,12 +660,14 @@ namespace vc
                     std::unique_lock lock(m_ChunkStageCacheMutex);
                     prerequisiteExists = m_ChunkStageCache.contains(prerequisiteKey);
                 }
-                // Load the required prerequisite if it doesn't exist.
+                // Load the required prerequisite if it doesn't exist, otherwise keep it from being unloaded.
                 if (not prerequisiteExists)
                 {
                     allPrerequisitesSatisfied = false;
                     LoadChunk(prerequisiteKey);
                 }
+                else
+                    CancelUnload(prerequisiteKey.ChunkPos);
             }
         }
 
@@ -302,382 +688,325 @@ namespace vc
 
     void ChunkGenerator::UnloadChunk(ChunkPos chunkPos)
     {
+        // Cancel the chunk if it hasn't started generating yet.
+        ChunkStageKey key{chunkPos, ChunkGenerationStage::_End - 1};
+        m_PendingChunks.erase(key);
+
+        // Along with outputting it again from the cache, if it was reloaded.
+        std::array<decltype(m_GeneratableChunks)::node_type, 2> nodes;
+        {
+            std::unique_lock lock(m_GeneratableChunkMutex);
+            nodes[0] = m_GeneratableChunks.extract(key);
+            if (auto it = m_GeneratableChunks.find({chunkPos, ChunkGenerationStage::Mesh - 1}); it != m_GeneratableChunks.end() and it->second.Cached)
+                nodes[1] = m_GeneratableChunks.extract(it);
+        }
+        {
+            // Release the prerequisites they would have used.
+            std::unique_lock lock(m_ChunkStageCacheMutex);
+            for (auto& node : nodes)
+                if (node)
+                    for (auto& prerequisite : node.mapped().Prerequisites)
+                        if (prerequisite.BlockStates)
+                            m_ChunkStageCache[prerequisite.Key].UsageCount--;
+        }
+
         m_UnloadingChunks.push_back(chunkPos);
     }
 
-    void ChunkGenerator::RemeshChunk(ChunkPos chunkPos, BlockStateRegistry const* updatedBlockStates)
+    void ChunkGenerator::CancelUnload(ChunkPos chunkPos)
+    {
+        std::erase(m_UnloadingChunks, chunkPos);
+    }
+
+    bool ChunkGenerator::ApplyChunkEdit(Chunk const& chunk)
+    {
+        std::unique_lock lock(m_ChunkStageCacheMutex);
+        auto it = m_ChunkStageCache.find({chunk.GetPosition(), ChunkGenerationStage::Mesh - 1});
+        // Unloaded chunks are read back from storage, which already has the edits.
+        if (it == m_ChunkStageCache.end())
+            return true;
+        // Workers read the block states without the lock, so wait for them to finish with it.
+        auto& stageData = it->second;
+        if (stageData.UsageCount != 0)
+            return false;
+
+        if (not stageData.CompressedBlockStates.empty())
+        {
+            m_CompressedChunkStageGauge.Add(-1);
+            m_CompressedChunkStageBytesGauge.Add(-i64(stageData.CompressedBlockStates.size()));
+            stageData.CompressedPalette = {};
+            stageData.CompressedBlockStates = {};
+        }
+        stageData.BlockStates = BlockStateRegistry{chunk.GetBlockStates()};
+        stageData.LastUsedIteration = m_DelegatorIteration.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    void ChunkGenerator::RemeshChunk(QueuedChunkRemeshData const& data)
+    {
+        ChunkMesher::Neighbours neighbours;
+        for (u8 face = 0; face < ChunkMesher::FaceCount; face++)
+            neighbours[face] = data.Neighbours[face] ? &data.Neighbours[face]->GetBlockStates() : nullptr;
+
+        ChunkPos chunkPos = data.Chunk->GetPosition();
+        ChunkMeshData chunkMeshData = ChunkMesher::GenerateMesh(m_Blocks, chunkPos, data.Chunk->GetBlockStates(), neighbours);
+        chunkMeshData.Version = data.Version;
+        FinishGeneratingChunkMesh(std::move(chunkMeshData));
+    }
+
+    void ChunkGenerator::LoadStoredChunk(ChunkStageJob& job)
+    {
+        BlockStateRegistry blockStates;
+        if (m_ChunkStorage->LoadChunk(job.Key.ChunkPos, blockStates))
+        {
+            job.Output.BlockStates = std::move(blockStates);
+            FinishGeneratingStages({&job, 1});
+            return;
+        }
+
+        // The chunk couldn't be read and has been forgotten by the storage, so queue the
+        // chunk again for the delegator to generate it from scratch.
+        ReleaseOutput(m_GeneratedChunks, 1);
+        ChunkPos chunkPos = job.Key.ChunkPos;
+        QueueChunkLoads({&chunkPos, 1});
+    }
+
+    void ChunkGenerator::OutputCachedChunk(ChunkStageJob& job)
     {
-        // TODO
+        // Using the cached stage keeps it from being unloaded or edited meanwhile.
+        Prerequisite const& prerequisite = job.Data.Prerequisites.front();
+        PushOutput(m_GeneratedChunks, std::make_shared<Chunk>(m_Blocks, BlockStateRegistry{*prerequisite.BlockStates}, job.Key.ChunkPos));
+        {
+            std::unique_lock lock(m_ChunkStageCacheMutex);
+            m_ChunkStageCache[prerequisite.Key].UsageCount--;
+        }
+        WakeDelegator();
     }
 
-    auto ChunkGenerator::GetPrerequisites(ChunkStageKey key) -> std::vector<Prerequisite>
+    auto ChunkGenerator::GetPrerequisites(ChunkStageKey key, u64 maxCount) -> std::vector<Prerequisite>
     {
         // Get all the prerequisite's block states.
+        auto prerequisiteData = s_PrerequisiteData[key.Stage.Index()];
+        prerequisiteData = prerequisiteData.first(std::min<u64>(prerequisiteData.size(), maxCount));
         std::vector<Prerequisite> prerequisites;
-        prerequisites.reserve(s_PrerequisiteData[key.Stage.Index()].size());
+        prerequisites.reserve(prerequisiteData.size());
 
-        for (auto& prerequisite : s_PrerequisiteData[key.Stage.Index()])
+        for (auto& prerequisite : prerequisiteData)
         {
             ChunkStageKey prerequisiteKey{key.ChunkPos + prerequisite.RelativeChunkPosition, prerequisite.Stage};
-            BlockStateRegistry const* prerequisiteBlockStates = nullptr;
+            ChunkStageData* stageData = nullptr;
+            bool compressed = false;
             {
                 std::unique_lock lock(m_ChunkStageCacheMutex);
                 if (auto it = m_ChunkStageCache.find(prerequisiteKey); it != m_ChunkStageCache.end())
                 {
-                    it->second.UsageCount++;
-                    prerequisiteBlockStates = &it->second.BlockStates;
+                    stageData = &it->second;
+                    compressed = stageData->UsageCount == 0 and not stageData->CompressedBlockStates.empty();
+                    stageData->UsageCount++;
+                    stageData->LastUsedIteration = m_DelegatorIteration.load(std::memory_order_relaxed);
                 }
             }
-            prerequisites.emplace_back(prerequisiteKey, prerequisiteBlockStates);
+            // Nothing else uses the entry until it's handed to a worker, so it's decompressed without holding the lock.
+            if (compressed)
+                DecompressChunkStage(*stageData);
+            prerequisites.emplace_back(prerequisiteKey, stageData ? &stageData->BlockStates : nullptr);
         }
 
         return prerequisites;
     }
 
-    void ChunkGenerator::GenerateStoneMap(ChunkStageKey key, GeneratableChunk const& data)
+    void ChunkGenerator::GenerateStoneMap(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output)
     {
         BlockID air = m_Blocks.GetBlock("minecraft:air");
         BlockID stone = m_Blocks.GetBlock("minecraft:stone");
 
-        BlockStateRegistry blockStates;
+        TerrainNoise::Densities densities;
+        m_TerrainNoise.GenerateDensities(key.ChunkPos, GetTerrainColumn(key.ChunkPos)->LatticeHeights, densities);
 
+        BlockStateRegistry blockStates;
         for (u16 i = 0; i < Chunk::Size3; i++)
-        {
-            ivec3 blockPos = ivec3{i, i >> 4, i >> 8} & i32(Chunk::Size - 1);
-            BlockID blockID = air;
-            if (blockPos.y < 10 and
-                0 < blockPos.x and
-                0 < blockPos.z)
-                blockID = stone;
-            blockStates.CreateBlockState(blockID);
-        }
+            blockStates.CreateBlockState(densities[i] > 0.0f ? stone : air);
 
-        FinishGeneratingStage(key, data, &blockStates);
+        output.BlockStates = std::move(blockStates);
     }
 
-    void ChunkGenerator::GenerateTopsoil(ChunkStageKey key, GeneratableChunk const& data)
+    void ChunkGenerator::GenerateTopsoil(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output)
     {
-        BlockID air = m_Blocks.GetBlock("minecraft:air");
         BlockID stone = m_Blocks.GetBlock("minecraft:stone");
         BlockID dirt = m_Blocks.GetBlock("minecraft:dirt");
 
-        auto getLastStageBlock = [&data](ivec3 blockOffset)
-        {
-            BlockStateRegistry const* blockStates = data.Prerequisites[blockOffset.y >= Chunk::Size].BlockStates;
-            blockOffset.y %= Chunk::Size;
-            BlockStateID id{blockOffset.x + Chunk::Size * blockOffset.y + Chunk::Size2 * blockOffset.z};
-            return blockStates->GetComponent<BlockState>(id).BlockID;
-        };
+        // How many blocks of dirt are under the surface in each biome.
+        static constexpr auto s_TopsoilDepths = std::to_array<i32>({4, 2, 0});
+        static_assert(s_TopsoilDepths.size() == Biome::_Count);
+
+        auto column = GetTerrainColumn(key.ChunkPos);
+        BlockStateRegistry const& lastBlockStates = *data.Prerequisites[0].BlockStates;
+        i32 originY = key.ChunkPos.y * i32(Chunk::Size);
 
         BlockStateRegistry blockStates;
 
         for (u16 i = 0; i < Chunk::Size3; i++)
         {
             ivec3 blockPos = ivec3{i, i >> 4, i >> 8} & i32(Chunk::Size - 1);
+            u32 columnIndex = u32(blockPos.x) + Chunk::Size * u32(blockPos.z);
 
-            BlockID blockID = getLastStageBlock(blockPos);
-            if (blockID == stone and (
-                getLastStageBlock(blockPos + ivec3{0, 4, 0}) == air or
-                getLastStageBlock(blockPos + ivec3{0, 3, 0}) == air or
-                getLastStageBlock(blockPos + ivec3{0, 2, 0}) == air or
-                getLastStageBlock(blockPos + ivec3{0, 1, 0}) == air))
+            BlockID blockID = lastBlockStates.GetComponent<BlockState>(BlockStateID(i)).BlockID;
+            i32 depth = column->SurfaceHeights[columnIndex] - (originY + blockPos.y);
+            if (blockID == stone and 0 <= depth and depth < s_TopsoilDepths[column->Biomes[columnIndex].Index()])
                 blockID = dirt;
             blockStates.CreateBlockState(blockID);
         }
 
-        FinishGeneratingStage(key, data, &blockStates);
+        output.BlockStates = std::move(blockStates);
     }
 
-    void ChunkGenerator::GenerateSurface(ChunkStageKey key, GeneratableChunk const& data)
+    void ChunkGenerator::GenerateCaves(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output)
     {
         BlockID air = m_Blocks.GetBlock("minecraft:air");
-        BlockID dirt = m_Blocks.GetBlock("minecraft:dirt");
-        BlockID grass = m_Blocks.GetBlock("minecraft:grass");
 
-        auto getLastStageBlock = [&data](ivec3 blockOffset)
-        {
-            BlockStateRegistry const* blockStates = data.Prerequisites[blockOffset.y >= Chunk::Size].BlockStates;
-            blockOffset.y %= Chunk::Size;
-            BlockStateID id{blockOffset.x + Chunk::Size * blockOffset.y + Chunk::Size2 * blockOffset.z};
-            return blockStates->GetComponent<BlockState>(id).BlockID;
-        };
+        // Worms can reach into the chunk from its own region and any adjacent one.
+        CaveCarver::CarveMask tunnels{};
+        ivec3 regionPos = CaveCarver::GetRegionPos(key.ChunkPos);
+        for (i32 z = -1; z <= 1; z++)
+            for (i32 y = -1; y <= 1; y++)
+                for (i32 x = -1; x <= 1; x++)
+                    CaveCarver::Carve(key.ChunkPos, regionPos + ivec3{x, y, z}, *GetCaveRegion(regionPos + ivec3{x, y, z}), tunnels);
+
+        TerrainNoise::Densities caveDensities;
+        m_TerrainNoise.GenerateCaveDensities(key.ChunkPos, caveDensities);
+
+        auto column = GetTerrainColumn(key.ChunkPos);
+        BlockStateRegistry const& lastBlockStates = *data.Prerequisites[0].BlockStates;
+        i32 originY = key.ChunkPos.y * i32(Chunk::Size);
 
         BlockStateRegistry blockStates;
 
         for (u16 i = 0; i < Chunk::Size3; i++)
         {
-            ivec3 blockPos = ivec3{i, i >> 4, i >> 8} &i32(Chunk::Size - 1);
+            ivec3 blockPos = ivec3{i, i >> 4, i >> 8} & i32(Chunk::Size - 1);
+            u32 columnIndex = u32(blockPos.x) + Chunk::Size * u32(blockPos.z);
 
-            BlockID blockID = getLastStageBlock(blockPos);
-            if (getLastStageBlock(blockPos) == dirt and getLastStageBlock(blockPos + ivec3{0, 1, 0}) == air)
-                blockID = grass;
+            BlockID blockID = lastBlockStates.GetComponent<BlockState>(BlockStateID(i)).BlockID;
+            i32 depth = column->SurfaceHeights[columnIndex] - (originY + blockPos.y);
+            if (tunnels[i] or (caveDensities[i] > 0.0f and depth >= s_NoiseCaveRoofDepth))
+                blockID = air;
             blockStates.CreateBlockState(blockID);
         }
 
-        FinishGeneratingStage(key, data, &blockStates);
+        output.BlockStates = std::move(blockStates);
     }
 
-    void ChunkGenerator::GenerateMesh(ChunkStageKey key, GeneratableChunk const& data)
+    void ChunkGenerator::GenerateSurface(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output)
     {
-        BlockStateRegistry const* blockStateRegistry       = data.Prerequisites[0].BlockStates;
-        BlockStateRegistry const* leftBlockStateRegistry   = data.Prerequisites[1].BlockStates;
-        BlockStateRegistry const* rightBlockStateRegistry  = data.Prerequisites[2].BlockStates;
-        BlockStateRegistry const* bottomBlockStateRegistry = data.Prerequisites[3].BlockStates;
-        BlockStateRegistry const* topBlockStateRegistry    = data.Prerequisites[4].BlockStates;
-        BlockStateRegistry const* backBlockStateRegistry   = data.Prerequisites[5].BlockStates;
-        BlockStateRegistry const* frontBlockStateRegistry  = data.Prerequisites[6].BlockStates;
-
-        std::vector<u32> faceSolidMasks(Chunk::Size2 * 6);
+        BlockID dirt = m_Blocks.GetBlock("minecraft:dirt");
+        BlockID grass = m_Blocks.GetBlock("minecraft:grass");
 
-        // Represent the solid state of block faces in binary.
-        auto blockStates = blockStateRegistry->GetView<BlockState>(); // NOTE: These block states will be used later too.
-        for (auto e : blockStates)
-        {
-            // TODO: variants
-            auto& blockState = blockStates.get<BlockState>(e);
-            // Only sample block states with a model.
-            if (auto* model = m_Blocks.TryGetComponent<BlockModel>(blockState.BlockID))
-            {
-                // Use the entt::entity/id_type as the block index.
-                u32 index = std::to_underlying(e);
-                u8 x = index % Chunk::Size;
-                u8 y = index / Chunk::Size % Chunk::Size;
-                u8 z = index / Chunk::Size2;
+        auto column = GetTerrainColumn(key.ChunkPos);
+        BlockStateRegistry const& lastBlockStates = *data.Prerequisites[0].BlockStates;
+        i32 originY = key.ChunkPos.y * i32(Chunk::Size);
 
-                auto constructMask = [&faceSolidMasks, &model = *model](u8 face, u8 px, u8 py, u8 pz)
-                {
-                    faceSolidMasks[px + Chunk::Size * py + Chunk::Size2 * face] |= (model.SolidBits >> (face ^ 1) & 1) << pz;
-                };
-
-                constructMask(0, z, y, x + 1);  // left
-                constructMask(1, z, y, 16 - x); // right
-                constructMask(2, x, z, y + 1);  // bottom
-                constructMask(3, x, z, 16 - y); // top
-                constructMask(4, x, y, z + 1);  // back
-                constructMask(5, x, y, 16 - z); // front
-            }
-        }
-
-        ChunkMeshData chunkMeshData
-        {
-            .ChunkPos = key.ChunkPos,
-        };
+        BlockStateRegistry blockStates;
 
-        // If the whole chunk has no solid faces, there is no mesh.
-        // NOTE: this checks if faceSolidMasks is all zeros.
-        if (faceSolidMasks.front() != 0 or
-            std::memcmp(faceSolidMasks.data(), faceSolidMasks.data() + 1, faceSolidMasks.size() - 1) != 0)
+        for (u16 i = 0; i < Chunk::Size3; i++)
         {
-            // TODO: the order { front back bottom left right top } seems optimal for cache (profile).
+            ivec3 blockPos = ivec3{i, i >> 4, i >> 8} & i32(Chunk::Size - 1);
+            u32 columnIndex = u32(blockPos.x) + Chunk::Size * u32(blockPos.z);
 
-            auto insertChunkEdge = [this, &faceSolidMasks](BlockStateRegistry const* chunkBlockStateRegistry, u8 face, u8 x, u8 y, u8 z, u8 px, u8 py)
-            {
-                auto& mask = faceSolidMasks[px + Chunk::Size * py + Chunk::Size2 * face];
-                if (chunkBlockStateRegistry)
-                {
-                    auto blockStates = chunkBlockStateRegistry->GetView<BlockState>();
-                    auto e = static_cast<entt::entity>(x + Chunk::Size * (y + Chunk::Size * z));
-                    auto& blockState = blockStates.get<BlockState>(e);
-                    if (auto* model = m_Blocks.TryGetComponent<BlockModel>(blockState.BlockID))
-                        mask |= model->SolidBits >> (face ^ 1) & 1;
-                }
-                // Treat non-existent chunks as solid.
-                else
-                    mask |= 1;
-            };
+            BlockID blockID = lastBlockStates.GetComponent<BlockState>(BlockStateID(i)).BlockID;
+            if (blockID == dirt and column->SurfaceHeights[columnIndex] == originY + blockPos.y)
+                blockID = grass;
+            blockStates.CreateBlockState(blockID);
+        }
 
-            for (u8 py = 0; py < Chunk::Size; py++)
-            {
-                for (u8 px = 0; px < Chunk::Size; px++)
-                {
-                    insertChunkEdge(leftBlockStateRegistry,   0, 15, py, px, px, py);
-                    insertChunkEdge(rightBlockStateRegistry,  1, 0,  py, px, px, py);
-                    insertChunkEdge(bottomBlockStateRegistry, 2, px, 15, py, px, py);
-                    insertChunkEdge(topBlockStateRegistry,    3, px, 0,  py, px, py);
-                    insertChunkEdge(backBlockStateRegistry,   4, px, py, 15, px, py);
-                    insertChunkEdge(frontBlockStateRegistry,  5, px, py, 0,  px, py);
-                }
-            }
+        output.BlockStates = std::move(blockStates);
+    }
 
-            // Face culling. Yes, it's this simple.
-            for (auto& mask : faceSolidMasks)
-                mask = u16((mask & ~(mask << 1)) >> 1);
+    void ChunkGenerator::GenerateStructures(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output)
+    {
+        GeneratePlacements(key, data, output, &PlacementRegion::Structures);
+    }
 
-            // Populate greedy meshing planes.
-            // TODO: variants, e.g. rotations, will be added to the hashed key type.
-            // NOTE: These are stored using std::array since they will already be on the heap from std::unordered_map.
-            std::unordered_map<TextureID, std::array<u16, Chunk::Size2 * 6>> greedyMeshingPlanes;
+    void ChunkGenerator::GenerateFeatures(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output)
+    {
+        GeneratePlacements(key, data, output, &PlacementRegion::Features);
+    }
 
-            u16 maskIndex = 0;
-            for (u8 face = 0; face < 6; face++)
-            {
-                for (u8 py = 0; py < Chunk::Size; py++)
-                {
-                    for (u8 px = 0; px < Chunk::Size; px++)
-                    {
-                        // Get the current mask.
-                        u16 mask = faceSolidMasks[maskIndex++];
-                        while (mask)
-                        {
-                            // Calculate the block plane z coord.
-                            u8 pz = std::countr_zero(mask);
-                            // Mark this bit as completed (unset it).
-                            mask &= mask - 1;
-
-                            // Get the true local block position.
-                            auto planeToLocal = std::to_array({
-                                u16(u16(pz     ) | u16(py     ) << 4 | u16(px     ) << 8), // left
-                                u16(u16(15 - pz) | u16(py     ) << 4 | u16(px     ) << 8), // right
-                                u16(u16(px     ) | u16(pz     ) << 4 | u16(py     ) << 8), // bottom
-                                u16(u16(px     ) | u16(15 - pz) << 4 | u16(py     ) << 8), // top
-                                u16(u16(px     ) | u16(py     ) << 4 | u16(pz     ) << 8), // back
-                                u16(u16(px     ) | u16(py     ) << 4 | u16(15 - pz) << 8), // front
-                            });
-                            u16 index = planeToLocal[face];
-
-                            auto e = static_cast<entt::entity>(index);
-                            auto& blockState = blockStates.get<BlockState>(e);
-                            // NOTE: No need to try get again, it was already checked and does exist.
-                            // TODO: How to not sample twice? Can't exactly cache the texture ids since
-                            // that would just move the problem and add overhead.
-                            auto& model = m_Blocks.GetComponent<BlockModel>(blockState.BlockID);
-                            // Put this face in the appropriate greedy meshing plane.
-                            TextureID textureID = (&model.Left)[face];
-                            greedyMeshingPlanes[textureID][py + Chunk::Size * pz + Chunk::Size2 * face] |= u16(1 << px);
-                        }
-                    }
-                }
-            }
+    void ChunkGenerator::GeneratePlacements(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output, std::vector<Placement> PlacementRegion::* placements)
+    {
+        BlockStateRegistry const& lastBlockStates = *data.Prerequisites[0].BlockStates;
+        FeaturePlacer::Blocks blocks;
+        for (u16 i = 0; i < Chunk::Size3; i++)
+            blocks[i] = lastBlockStates.GetComponent<BlockState>(BlockStateID(i)).BlockID;
 
-            // Greedy mesh each plane.
-            struct GreedyQuad
-            {
-                u8 x, y, z, w, h;
-            };
-
-            //                   packedFaceData.y                 packedFaceData.x
-            // 64  60  56  52  48  44  40  36  32   28  24  20  16  12   8   4   0
-            //   ----------------------------hhhh wwwwzzzzyyyyxxxxtttttttttttttttt
-            // t = texture id, x = local x, y = local y, z = local z, w = width, h = height
-            auto packVertex = [](TextureID textureID, GreedyQuad quad) -> uvec2
-            {
-                return
-                {
-                    (quad.w - 1) << 28 | quad.z << 24 | quad.y << 20 | quad.x << 16 | std::to_underlying(textureID),
-                    /* extra 24 bits */ (quad.h - 1),
-                };
-            };
+        // Placements can reach into the chunk from its own region and any adjacent one.
+        ivec3 regionPos = FeaturePlacer::GetRegionPos(key.ChunkPos);
+        for (i32 z = -1; z <= 1; z++)
+            for (i32 x = -1; x <= 1; x++)
+                m_FeaturePlacer.Place(key.ChunkPos, regionPos + ivec3{x, 0, z}, (*GetPlacementRegion(regionPos + ivec3{x, 0, z})).*placements, blocks);
 
-            for (auto& [textureID, facePlanes] : greedyMeshingPlanes)
-            {
-                for (u8 face = 0; face < 6; face++)
-                {
-                    auto& packedVertices = (&chunkMeshData.Left)[face];
-                    for (u8 pz = 0; pz < Chunk::Size; pz++)
-                    {
-                        auto plane = std::span(facePlanes).subspan(Chunk::Size * pz + Chunk::Size2 * face, Chunk::Size);
+        BlockStateRegistry blockStates;
+        for (u16 i = 0; i < Chunk::Size3; i++)
+            blockStates.CreateBlockState(blocks[i]);
 
-                        for (u8 py = 0; py < Chunk::Size; py++)
-                        {
-                            for (u8 px = 0; px < Chunk::Size; )
-                            {
-                                // Expand the quad horizontally.
-                                px += std::countr_zero<u16>(plane[py] >> px);
-                                // If there's no solid faces left, stop advancing.
-                                if (px >= Chunk::Size)
-                                    break;
-
-                                u8 width = std::countr_one<u16>(plane[py] >> px);
-                                u16 widthMask = ((1 << width) - 1) << px;
-                                // Consume this mask.
-                                plane[py] &= ~widthMask;
-
-                                // Expand the quad vertically.
-                                u8 height = 1;
-                                while (py + height < Chunk::Size)
-                                {
-                                    u16 nextMask = plane[py + height] & widthMask;
-                                    // Stop expanding if the next mask doesn't have all
-                                    // solid faces set as the initial width mask.
-                                    if (nextMask != widthMask)
-                                        break;
-                                    // Expand into the next mask.
-                                    plane[py + height] &= ~widthMask;
-                                    height++;
-                                }
+        output.BlockStates = std::move(blockStates);
+    }
 
-                                // Convert plane coords to chunk coords.
-                                // TODO: try to not duplicate this work.
-                                auto planeToLocal = std::to_array({
-                                    u16(u16(pz)      | u16(py)      << 4 | u16(px)      << 8), // left
-                                    u16(u16(15 - pz) | u16(py)      << 4 | u16(px)      << 8), // right
-                                    u16(u16(px)      | u16(pz)      << 4 | u16(py)      << 8), // bottom
-                                    u16(u16(px)      | u16(15 - pz) << 4 | u16(py)      << 8), // top
-                                    u16(u16(px)      | u16(py)      << 4 | u16(pz)      << 8), // back
-                                    u16(u16(px)      | u16(py)      << 4 | u16(15 - pz) << 8), // front
-                                });
-                                u16 index = planeToLocal[face];
-                                u8 x = index % Chunk::Size;
-                                u8 y = index / Chunk::Size % Chunk::Size;
-                                u8 z = index / Chunk::Size2;
-
-                                // Pack the quad into the appropriate submesh.
-                                packedVertices.push_back(packVertex(textureID, {x, y, z, width, height}));
-
-                                px += width;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    void ChunkGenerator::GenerateMesh(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output)
+    {
+        ChunkMesher::Neighbours neighbours;
+        for (u8 face = 0; face < ChunkMesher::FaceCount; face++)
+            neighbours[face] = data.Prerequisites[face + 1].BlockStates;
 
-        FinishGeneratingChunkMesh(std::move(chunkMeshData));
-        FinishGeneratingStage(key, data, nullptr);
+        output.Mesh = ChunkMesher::GenerateMesh(m_Blocks, key.ChunkPos, *data.Prerequisites[0].BlockStates, neighbours);
     }
 
-    void ChunkGenerator::FinishGeneratingStage(ChunkStageKey key, GeneratableChunk const& data, BlockStateRegistry* blockStates)
+    void ChunkGenerator::FinishGeneratingStages(std::span<ChunkStageJob> jobs)
     {
-        if (blockStates)
+        // Add chunks from the final stages and meshes to the output, saving the newly generated chunks.
+        // Their slots were reserved before the jobs were taken.
+        for (ChunkStageJob& job : jobs)
         {
-            if (key.Stage == ChunkGenerationStage::Mesh - 1)
-                FinishGeneratingChunk(key, *blockStates);
-
-            // Add the generated stage to the cache.
+            if (job.Output.BlockStates and job.Key.Stage == ChunkGenerationStage::Mesh - 1)
             {
-                std::unique_lock lock(m_ChunkStageCacheMutex);
-                ENG_ASSERT(not m_ChunkStageCache.contains(key));
-                m_ChunkStageCache[key].BlockStates = std::move(*blockStates);
+                // Make a copy of the block states. The original will be used for the cache.
+                auto chunk = std::make_shared<Chunk>(m_Blocks, BlockStateRegistry{*job.Output.BlockStates}, job.Key.ChunkPos);
+                if (not job.Data.Stored and m_ChunkStorage)
+                    m_ChunkStorage->SaveChunk(chunk);
+                PushOutput(m_GeneratedChunks, std::move(chunk));
             }
+            if (job.Output.Mesh)
+                PushOutput(m_GeneratedChunkMeshes, std::move(*job.Output.Mesh));
         }
 
-        // Mark this chunk as no longer using its prerequisites.
-        for (auto& prerequisite : data.Prerequisites)
         {
-            if (prerequisite.BlockStates)
+            std::unique_lock lock(m_ChunkStageCacheMutex);
+            u64 iteration = m_DelegatorIteration.load(std::memory_order_relaxed);
+            for (ChunkStageJob& job : jobs)
             {
-                std::unique_lock lock(m_ChunkStageCacheMutex);
-                m_ChunkStageCache[prerequisite.Key].UsageCount--;
+                // Add the generated stage to the cache.
+                if (job.Output.BlockStates)
+                {
+                    ENG_ASSERT(not m_ChunkStageCache.contains(job.Key));
+                    auto& stageData = m_ChunkStageCache[job.Key];
+                    stageData.BlockStates = std::move(*job.Output.BlockStates);
+                    stageData.LastUsedIteration = iteration;
+                }
+
+                // Mark this chunk as no longer using its prerequisites.
+                for (auto& prerequisite : job.Data.Prerequisites)
+                    if (prerequisite.BlockStates)
+                        m_ChunkStageCache[prerequisite.Key].UsageCount--;
             }
         }
 
         // Tell the delegator thread it can recheck pending chunks.
-        m_QueuedChunkCondition.notify_one();
-    }
-
-    void ChunkGenerator::FinishGeneratingChunk(ChunkStageKey key, BlockStateRegistry const& blockStates)
-    {
-        // Add the generated chunk to the output.
-        std::unique_lock lock(m_GeneratedChunkMutex);
-        // Make a copy of the block states. The original will be used for the cache.
-        m_GeneratedChunks.push_back(std::make_shared<Chunk>(m_Blocks, BlockStateRegistry{blockStates}, key.ChunkPos));
+        WakeDelegator();
     }
 
     void ChunkGenerator::FinishGeneratingChunkMesh(ChunkMeshData&& chunkMeshData)
     {
-        // Add the generated mesh to the output.
-        std::unique_lock lock(m_GeneratedChunkMeshMutex);
-        m_GeneratedChunkMeshes.push_back(std::move(chunkMeshData));
+        // Add the generated mesh to the output. Its slot was reserved before the remesh was taken.
+        PushOutput(m_GeneratedChunkMeshes, std::move(chunkMeshData));
     }
 
     u64 ChunkGenerator::ChunkStageHashEq::operator()(ChunkStageKey const& key) const noexcept
@@ -3,14 +3,20 @@
 #include "VulkanCraft/Rendering/ChunkMeshData.hpp"
 #include "VulkanCraft/World/BlockRegistry.hpp"
 #include "VulkanCraft/World/BlockStateRegistry.hpp"
+#include "VulkanCraft/World/CaveCarver.hpp"
 #include "VulkanCraft/World/ChunkGenerationStage.hpp"
 #include "VulkanCraft/World/ChunkPos.hpp"
+#include "VulkanCraft/World/FeaturePlacer.hpp"
+#include "VulkanCraft/World/GenerationCache.hpp"
+#include "VulkanCraft/World/TerrainNoise.hpp"
 #include <Engine.hpp>
 #include <array>
 #include <atomic>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <semaphore>
+#include <optional>
 #include <span>
 #include <thread>
 #include <unordered_map>
@@ -22,6 +28,7 @@ using namespace eng;
 namespace vc
 {
     class Chunk;
+    class ChunkStorage;
 
     class ChunkGenerator
     {
@@ -29,20 +36,32 @@ namespace vc
     public:
         struct QueuedChunkRemeshData
         {
-            ChunkPos ChunkPos;                            // The position to update a chunk mesh.
-            BlockStateRegistry const* UpdatedBlockStates; // The block states to mesh with (makes a local copy).
+            std::shared_ptr<Chunk const> Chunk; // The chunk to remesh; must not be modified while shared.
+            std::array<std::shared_ptr<vc::Chunk const>, 6> Neighbours; // In ChunkMesher face order, or nullptr if not loaded.
+            u64 Version;                        // Copied into the mesh, so stale meshes can be told apart.
         };
+
+        // Called from the worker threads each time a chunk stage finishes generating, with how long it took.
+        using StageTimingCallback = std::function<void(ChunkPos chunkPos, ChunkGenerationStage stage, f64 seconds)>;
     public:
-        ChunkGenerator(BlockRegistry const& blocks, u8 workerThreadCount);
+        // Terrain is generated from the seed, so the same seed always generates the same chunks.
+        // Chunks saved in the given storage are loaded from it instead of being generated, and generated chunks are saved to it.
+        // Workers take up to maxBatchSize nearby chunks of the same stage at once; 1 disables batching.
+        ChunkGenerator(BlockRegistry const& blocks, u64 seed, u8 workerThreadCount, StageTimingCallback stageTimingCallback = {}, ChunkStorage* chunkStorage = nullptr, u8 maxBatchSize = 16);
         ~ChunkGenerator();
 
         // Queues the chunks at the given positions to be loaded.
         void QueueChunkLoads(std::span<ChunkPos> chunks);
         // Queues the chunks at the given positions to be unloaded.
         void QueueChunkUnloads(std::span<ChunkPos> chunks);
-        // Queues the chunks at the given positions to be remeshed with the given block states.
+        // Queues the given chunks to be remeshed ahead of any generation.
         void QueueChunkRemeshes(std::span<QueuedChunkRemeshData> chunks);
+        // Queues the cached final stages of the given edited chunks to be replaced by them,
+        // so chunks loaded or meshed against them later see the edits.
+        void QueueChunkEdits(std::span<std::shared_ptr<Chunk const>> chunks);
 
+        // The outputs are bounded, and workers hold off generating while they're full, so consume them regularly.
+        // Consumers are called without any lock held.
         void ConsumeGeneratedChunks(std::function<void(std::shared_ptr<Chunk>&&)> const& consumer, u64 maxCount = u64(-1));
         void ConsumeGeneratedChunkMeshes(std::function<void(ChunkMeshData&&)> const& consumer, u64 maxCount = u64(-1));
     private:
@@ -57,6 +76,12 @@ namespace vc
         {
             BlockStateRegistry BlockStates;
             u64 UsageCount = 0;
+            // Delegator iteration it was last generated or used in.
+            u64 LastUsedIteration = 0;
+            // Block states of entries that went unused for a while, compressed by ChunkCodec, and
+            // decompressed when used again. BlockStates is empty while they're set.
+            std::vector<BlockID> CompressedPalette;
+            std::vector<u8> CompressedBlockStates;
         };
         struct ChunkStageHashEq
         {
@@ -76,53 +101,137 @@ namespace vc
         struct GeneratableChunk
         {
             std::vector<Prerequisite> Prerequisites;
+            bool Stored = false; // Loaded from storage instead of generated, so it has no prerequisites.
+            bool Cached = false; // Reloaded while its final stage was still cached, so it's only output again.
         };
-    private:
+        using GeneratableChunkMap = std::unordered_map<ChunkStageKey, GeneratableChunk, ChunkStageHashEq, ChunkStageHashEq>;
+
+        // What a chunk stage generated.
+        struct GeneratedStage
+        {
+            std::optional<BlockStateRegistry> BlockStates; // Cached for later stages; the mesh stage has none.
+            std::optional<ChunkMeshData> Mesh;
+        };
+
+        // A chunk stage a worker took to generate, in a batch with others.
+        struct ChunkStageJob
+        {
+            ChunkStageKey Key;
+            GeneratableChunk Data;
+            GeneratedStage Output;
+        };
+
+        // Generated chunks or meshes waiting to be consumed.
         template <typename T>
-        void Queue(std::span<T> chunks, std::vector<T>& queuedChunks);
+        struct OutputQueue
+        {
+            OutputQueue(u64 capacity)
+                : Queue(capacity) {}
+
+            BoundedQueue<T> Queue;
+            // Slots taken by queued outputs, and by outputs workers reserved before generating them.
+            // Never more than the capacity, so pushes into reserved slots never fail.
+            std::atomic<u64> ReservedCount = 0;
+        };
+    private:
+        void QueueLoadsOrUnloads(std::span<ChunkPos> chunks, bool unload);
 
         template <typename T>
-        void Consume(std::function<void(T&&)> const& consumer, u64 maxCount, std::mutex& mutex, std::vector<T>& output);
+        void Consume(std::function<void(T&&)> const& consumer, u64 maxCount, OutputQueue<T>& output);
+        // Reserves up to count slots in the output, and returns how many were reserved.
+        template <typename T>
+        u64 ReserveOutput(OutputQueue<T>& output, u64 count);
+        // Frees reserved slots, waking workers that were waiting for them.
+        template <typename T>
+        void ReleaseOutput(OutputQueue<T>& output, u64 count);
+        template <typename T>
+        void PushOutput(OutputQueue<T>& output, T&& value);
+        // The same for the output of the stage's final chunks or meshes, if it has one.
+        u64 ReserveStageOutputs(ChunkGenerationStage stage, u64 count);
+        void ReleaseStageOutputs(ChunkGenerationStage stage, u64 count);
 
+        void WakeDelegator();
+        void UpdateMetrics();
+        void CompressColdChunkStages();
+        void EvictColdGenerationCaches();
+        // Returns the terrain column the chunk is in, generating it if it isn't cached.
+        std::shared_ptr<TerrainColumn const> GetTerrainColumn(ChunkPos chunkPos);
+        // Returns the cave region at the region position, tracing it if it isn't cached.
+        std::shared_ptr<CaveRegion const> GetCaveRegion(ivec3 regionPos);
+        // Returns the placement region at the region position, placing it if it isn't cached.
+        std::shared_ptr<PlacementRegion const> GetPlacementRegion(ivec3 regionPos);
+        void DecompressChunkStage(ChunkStageData& stageData);
         void DelegatorThread();
         void WorkerThread();
+        // Takes the given generatable chunk, and others of the same stage near it to fill the batch up to maxCount.
+        // Must be called with m_GeneratableChunkMutex locked.
+        void TakeBatch(std::vector<ChunkStageJob>& batch, GeneratableChunkMap::iterator first, u64 maxCount);
         void LoadChunk(ChunkStageKey key);
         void UnloadChunk(ChunkPos chunkPos);
-        void RemeshChunk(ChunkPos chunkPos, BlockStateRegistry const* updatedBlockStates);
-        std::vector<Prerequisite> GetPrerequisites(ChunkStageKey key);
+        void CancelUnload(ChunkPos chunkPos);
+        // Replaces the chunk's cached final stage with its edited blocks, unless workers are using it.
+        // Returns false if it has to be tried again later.
+        bool ApplyChunkEdit(Chunk const& chunk);
+        void RemeshChunk(QueuedChunkRemeshData const& data);
+        void LoadStoredChunk(ChunkStageJob& job);
+        // Outputs a copy of the chunk's cached final stage, its only prerequisite.
+        void OutputCachedChunk(ChunkStageJob& job);
+        // Takes the first maxCount of the stage's prerequisites, marking them used.
+        std::vector<Prerequisite> GetPrerequisites(ChunkStageKey key, u64 maxCount = u64(-1));
     private:
-        void GenerateStoneMap(ChunkStageKey key, GeneratableChunk const& data);
-        void GenerateTopsoil(ChunkStageKey key, GeneratableChunk const& data);
-        //void GenerateCaves(ChunkStageKey key, GeneratableChunk const& data);
-        void GenerateSurface(ChunkStageKey key, GeneratableChunk const& data);
-        //void GenerateStructures(ChunkStageKey key, GeneratableChunk const& data);
-        //void GenerateFeatures(ChunkStageKey key, GeneratableChunk const& data);
-        //void GenerateFoliage(ChunkStageKey key, GeneratableChunk const& data);
-        void GenerateMesh(ChunkStageKey key, GeneratableChunk const& data);
+        void GenerateStoneMap(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output);
+        void GenerateTopsoil(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output);
+        void GenerateCaves(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output);
+        void GenerateSurface(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output);
+        void GenerateStructures(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output);
+        void GenerateFeatures(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output);
+        //void GenerateFoliage(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output);
+        void GenerateMesh(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output);
 
         static constexpr auto s_GenerationFunctions = std::to_array({
             &ChunkGenerator::GenerateStoneMap,
             &ChunkGenerator::GenerateTopsoil,
-            //&ChunkGenerator::GenerateCaves,
+            &ChunkGenerator::GenerateCaves,
             &ChunkGenerator::GenerateSurface,
-            //&ChunkGenerator::GenerateStructures,
-            //&ChunkGenerator::GenerateFeatures,
+            &ChunkGenerator::GenerateStructures,
+            &ChunkGenerator::GenerateFeatures,
             //&ChunkGenerator::GenerateFoliage,
             &ChunkGenerator::GenerateMesh,
         });
 
-        void FinishGeneratingStage(ChunkStageKey key, GeneratableChunk const& data, BlockStateRegistry* blockStates);
-        void FinishGeneratingChunk(ChunkStageKey key, BlockStateRegistry const& blockStates);
+        // Writes the chunk's blocks of either the structures or features of the regions around it.
+        void GeneratePlacements(ChunkStageKey key, GeneratableChunk const& data, GeneratedStage& output, std::vector<Placement> PlacementRegion::* placements);
+
+        // Publishes everything the jobs generated, taking each output lock once.
+        void FinishGeneratingStages(std::span<ChunkStageJob> jobs);
         void FinishGeneratingChunkMesh(ChunkMeshData&& meshData);
     private:
         BlockRegistry const& m_Blocks; // non-owning
+        TerrainNoise m_TerrainNoise;
+        CaveCarver m_CaveCarver;
+        FeaturePlacer m_FeaturePlacer;
+        StageTimingCallback m_StageTimingCallback;
+        ChunkStorage* m_ChunkStorage; // non-owning
+        u8 m_MaxBatchSize;
+
+        struct QueuedChunkLoad
+        {
+            ChunkPos ChunkPos;
+            bool Unload;
+        };
 
         // Input chunks to load/unload/remesh.
-        std::vector<ChunkPos> m_QueuedChunkLoads;
-        std::vector<ChunkPos> m_QueuedChunkUnloads;
-        std::vector<QueuedChunkRemeshData> m_QueuedChunkRemeshes;
+        // Loads and unloads share a queue so they're processed in the order they were queued.
+        std::vector<QueuedChunkLoad> m_QueuedChunkLoads;
         std::mutex m_QueuedChunkMutex;
         std::condition_variable m_QueuedChunkCondition;
+        // Edited chunks whose cached final stages are to be replaced. Shares the mutex and condition.
+        std::vector<std::shared_ptr<Chunk const>> m_QueuedChunkEdits;
+        // Set when the delegator has work to do, so wakes between its waits aren't lost.
+        bool m_DelegatorWakeRequested = false;
+
+        // Edited chunks whose cached final stages were in use, tried again each iteration.
+        std::vector<std::shared_ptr<Chunk const>> m_EditedChunks;
 
         // Chunks to unload when they are no longer used.
         std::vector<ChunkPos> m_UnloadingChunks;
@@ -131,21 +240,45 @@ namespace vc
         std::unordered_set<ChunkStageKey, ChunkStageHashEq, ChunkStageHashEq> m_PendingChunks;
 
         // Chunks to load whose prerequisites are satisfied.
-        std::unordered_map<ChunkStageKey, GeneratableChunk, ChunkStageHashEq, ChunkStageHashEq> m_GeneratableChunks;
+        GeneratableChunkMap m_GeneratableChunks;
+        // Chunks to remesh, which workers take before any generatable chunk. Shares its mutex and condition.
+        std::deque<QueuedChunkRemeshData> m_RemeshableChunks;
         std::mutex m_GeneratableChunkMutex;
         std::condition_variable m_GeneratableChunkCondition;
 
         // Loaded chunks.
-        std::vector<std::shared_ptr<Chunk>> m_GeneratedChunks;
-        std::mutex m_GeneratedChunkMutex;
+        OutputQueue<std::shared_ptr<Chunk>> m_GeneratedChunks;
 
         // Loaded chunk meshes.
-        std::vector<ChunkMeshData> m_GeneratedChunkMeshes;
-        std::mutex m_GeneratedChunkMeshMutex;
+        OutputQueue<ChunkMeshData> m_GeneratedChunkMeshes;
 
         // Cache of intermediate chunk generation block states.
         ChunkStageCache m_ChunkStageCache;
         std::mutex m_ChunkStageCacheMutex;
+        // Counts delegator iterations, to tell how long ago cache entries were used.
+        std::atomic<u64> m_DelegatorIteration = 0;
+
+        // Cache of terrain columns, keyed by chunk position with y = 0, so each column's
+        // heightmap and biomes are generated once for the whole vertical stack of chunks.
+        GenerationCache<ChunkPos, TerrainColumn, ChunkPosHash> m_TerrainColumns;
+        // Cache of cave regions, so each region's worms are traced once for all the chunks they pass through.
+        GenerationCache<ivec3, CaveRegion, ChunkPosHash> m_CaveRegions;
+        // Cache of placement regions, so each region's structures and features are placed once for all the chunks they span.
+        GenerationCache<ivec3, PlacementRegion, ChunkPosHash> m_PlacementRegions;
+
+        // Queue depths of each stage, and the stage cache size.
+        using StageGauges = std::array<MetricGauge*, ChunkGenerationStage::_Count>;
+        static StageGauges GetStageGauges(small_string_view queueName);
+        StageGauges m_PendingChunkGauges = GetStageGauges("pending");         // non-owning
+        StageGauges m_GeneratableChunkGauges = GetStageGauges("generatable"); // non-owning
+        MetricGauge& m_ChunkStageCacheGauge = Metrics::GetGauge("chunk_generator.stage_cache_entries");
+        MetricGauge& m_CompressedChunkStageGauge = Metrics::GetGauge("chunk_generator.stage_cache_compressed_entries");
+        MetricGauge& m_CompressedChunkStageBytesGauge = Metrics::GetGauge("chunk_generator.stage_cache_compressed_bytes");
+        MetricGauge& m_TerrainColumnGauge = Metrics::GetGauge("chunk_generator.terrain_columns");
+        MetricGauge& m_CaveRegionGauge = Metrics::GetGauge("chunk_generator.cave_regions");
+        MetricGauge& m_PlacementRegionGauge = Metrics::GetGauge("chunk_generator.placement_regions");
+        MetricGauge& m_GeneratedChunkGauge = Metrics::GetGauge("chunk_generator.generated_chunks");
+        MetricGauge& m_GeneratedChunkMeshGauge = Metrics::GetGauge("chunk_generator.generated_chunk_meshes");
 
         // Flag for if the threads should continue running.
         std::atomic_bool m_Running = true;
@@ -0,0 +1,102 @@
+#include "ChunkGrid.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace vc
+{
+    ChunkGrid::ChunkGrid(u32 horizontalRenderDistance, u32 verticalRenderDistance)
+    {
+        Resize(horizontalRenderDistance, verticalRenderDistance);
+    }
+
+    void ChunkGrid::Resize(u32 horizontalRenderDistance, u32 verticalRenderDistance)
+    {
+        // Power of two sizes, so wrapping is a mask.
+        u32 horizontalSize = std::bit_ceil(2 * horizontalRenderDistance + 1);
+        u32 verticalSize = std::bit_ceil(2 * verticalRenderDistance + 1);
+
+        std::vector<Slot> oldSlots = std::move(m_Slots);
+        auto oldFallback = std::move(m_Fallback);
+
+        m_Slots.clear();
+        m_Slots.resize(u64(horizontalSize) * horizontalSize * verticalSize);
+        m_Mask = {horizontalSize - 1, verticalSize - 1, horizontalSize - 1};
+        m_ShiftZ = u32(std::countr_zero(horizontalSize));
+        m_ShiftY = m_ShiftZ * 2;
+        m_Count = 0;
+        m_Fallback.clear();
+
+        for (auto& slot : oldSlots)
+            if (slot.Chunk)
+                Insert(std::move(slot.Chunk));
+        for (auto& [chunkPos, chunk] : oldFallback)
+            Insert(std::move(chunk));
+    }
+
+    std::shared_ptr<Chunk> ChunkGrid::GetShared(ChunkPos chunkPos) const
+    {
+        Slot const& slot = m_Slots[GetSlotIndex(chunkPos)];
+        if (slot.Chunk and slot.Position == chunkPos)
+            return slot.Chunk;
+        if (auto it = m_Fallback.find(chunkPos); it != m_Fallback.end())
+            return it->second;
+        return nullptr;
+    }
+
+    void ChunkGrid::Insert(std::shared_ptr<Chunk>&& chunk)
+    {
+        ChunkPos chunkPos = chunk->GetPosition();
+        Slot& slot = m_Slots[GetSlotIndex(chunkPos)];
+        if (not slot.Chunk or slot.Position == chunkPos)
+        {
+            m_Count += not slot.Chunk;
+            slot.Position = chunkPos;
+            slot.Chunk = std::move(chunk);
+            return;
+        }
+
+        auto [it, inserted] = m_Fallback.insert_or_assign(chunkPos, std::move(chunk));
+        m_Count += inserted;
+    }
+
+    bool ChunkGrid::Erase(ChunkPos chunkPos)
+    {
+        Slot& slot = m_Slots[GetSlotIndex(chunkPos)];
+        if (slot.Chunk and slot.Position == chunkPos)
+        {
+            slot.Chunk.reset();
+            m_Count--;
+
+            // Move a chunk waiting for this slot into it, so lookups go back to being direct.
+            if (not m_Fallback.empty()) ENG_UNLIKELY
+            {
+                u64 slotIndex = GetSlotIndex(chunkPos);
+                auto it = std::find_if(m_Fallback.begin(), m_Fallback.end(), [&](auto const& entry)
+                {
+                    return GetSlotIndex(entry.first) == slotIndex;
+                });
+                if (it != m_Fallback.end())
+                {
+                    slot.Position = it->first;
+                    slot.Chunk = std::move(it->second);
+                    m_Fallback.erase(it);
+                }
+            }
+            return true;
+        }
+
+        if (m_Fallback.erase(chunkPos))
+        {
+            m_Count--;
+            return true;
+        }
+        return false;
+    }
+
+    Chunk* ChunkGrid::GetFallback(ChunkPos chunkPos) const noexcept
+    {
+        if (auto it = m_Fallback.find(chunkPos); it != m_Fallback.end())
+            return it->second.get();
+        return nullptr;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    // Ring-buffer grid of loaded chunks, sized to fit the render distance.
+    // Chunk positions wrap around the grid, so it never has to be recentered as the camera moves,
+    // and lookups are a masked index and a position compare. Chunks whose slot is already taken
+    // by another chunk, i.e. ones outside the render distance, go into a hash map instead.
+    class ChunkGrid
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(ChunkGrid);
+    public:
+        ChunkGrid(u32 horizontalRenderDistance, u32 verticalRenderDistance);
+
+        // Resizes the grid to fit the render distances, keeping all chunks.
+        void Resize(u32 horizontalRenderDistance, u32 verticalRenderDistance);
+
+        // Returns the chunk at the given position, or nullptr if it isn't loaded.
+        ENG_NO_DISCARD Chunk* Get(ChunkPos chunkPos) const noexcept
+        {
+            Slot const& slot = m_Slots[GetSlotIndex(chunkPos)];
+            if (slot.Chunk and slot.Position == chunkPos) ENG_LIKELY
+                return slot.Chunk.get();
+            if (m_Fallback.empty()) ENG_LIKELY
+                return nullptr;
+            return GetFallback(chunkPos);
+        }
+        ENG_NO_DISCARD bool Contains(ChunkPos chunkPos) const noexcept { return Get(chunkPos); }
+        // Returns shared ownership of the chunk at the given position, or nullptr if it isn't loaded.
+        ENG_NO_DISCARD std::shared_ptr<Chunk> GetShared(ChunkPos chunkPos) const;
+
+        // Adds the chunk, replacing any chunk already at its position.
+        void Insert(std::shared_ptr<Chunk>&& chunk);
+        // Removes the chunk at the given position; returns true if there was one.
+        bool Erase(ChunkPos chunkPos);
+
+        ENG_NO_DISCARD u64 GetCount() const noexcept { return m_Count; }
+        ENG_NO_DISCARD u64 GetFallbackCount() const noexcept { return m_Fallback.size(); }
+    private:
+        struct Slot
+        {
+            ChunkPos Position{};
+            std::shared_ptr<Chunk> Chunk;
+        };
+
+        ENG_NO_DISCARD u64 GetSlotIndex(ChunkPos chunkPos) const noexcept
+        {
+            return (u32(chunkPos.x) & m_Mask.x) |
+                ((u32(chunkPos.z) & m_Mask.z) << m_ShiftZ) |
+                (u64(u32(chunkPos.y) & m_Mask.y) << m_ShiftY);
+        }
+        Chunk* GetFallback(ChunkPos chunkPos) const noexcept;
+    private:
+        std::vector<Slot> m_Slots;
+        uvec3 m_Mask{};
+        u32 m_ShiftZ = 0;
+        u32 m_ShiftY = 0;
+        u64 m_Count = 0;
+        std::unordered_map<ChunkPos, std::shared_ptr<Chunk>, ChunkPosHash> m_Fallback;
+    };
+}
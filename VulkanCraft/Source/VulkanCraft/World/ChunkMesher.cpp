@@ -0,0 +1,333 @@
+#include "ChunkMesher.hpp"
+#include "VulkanCraft/Rendering/BlockModel.hpp"
+#include <algorithm>
+
+namespace vc
+{
+    // Sets the solid bits of a block's faces in their face masks.
+    static void AddBlockFaces(std::span<u32> faceSolidMasks, BlockModel const& model, u32 index)
+    {
+        u8 x = index % Chunk::Size;
+        u8 y = index / Chunk::Size % Chunk::Size;
+        u8 z = index / Chunk::Size2;
+
+        auto constructMask = [&faceSolidMasks, &model](u8 face, u8 px, u8 py, u8 pz)
+        {
+            faceSolidMasks[px + Chunk::Size * py + Chunk::Size2 * face] |= (model.SolidBits >> (face ^ 1) & 1) << pz;
+        };
+
+        constructMask(0, z, y, x + 1);  // left
+        constructMask(1, z, y, 16 - x); // right
+        constructMask(2, x, z, y + 1);  // bottom
+        constructMask(3, x, z, 16 - y); // top
+        constructMask(4, x, y, z + 1);  // back
+        constructMask(5, x, y, 16 - z); // front
+    }
+
+    ChunkMeshData ChunkMesher::GenerateMesh(
+        BlockRegistry const& blocks,
+        ChunkPos chunkPos,
+        BlockStateRegistry const& blockStates,
+        Neighbours const& neighbours
+    )
+    {
+        // Each worker thread keeps its own.
+        static thread_local Arena s_Arena;
+        return GenerateMesh(blocks, chunkPos, blockStates, neighbours, s_Arena);
+    }
+
+    ChunkMeshData ChunkMesher::GenerateMesh(
+        BlockRegistry const& blocks,
+        ChunkPos chunkPos,
+        BlockStateRegistry const& blockStates,
+        Neighbours const& neighbours,
+        Arena& arena
+    )
+    {
+        ChunkMeshData chunkMeshData
+        {
+            .ChunkPos = chunkPos,
+        };
+
+        auto& faceSolidMasks = arena.FaceSolidMasks;
+        faceSolidMasks.assign(LayerFaceMaskCount, 0);
+        {
+            ENG_PROFILE_ZONE("ChunkMesher::BuildFaceMasks");
+            BuildFaceMasks(blocks, blockStates, faceSolidMasks);
+        }
+
+        // If the whole chunk has no solid faces, there is no mesh.
+        if (not HasSolidFaces(faceSolidMasks))
+            return chunkMeshData;
+
+        for (auto& face : arena.Faces)
+            face.clear();
+        MeshLayers(blocks, blockStates, &neighbours, 0, arena);
+
+        {
+            ENG_PROFILE_ZONE("ChunkMesher::GenerateLods");
+            arena.LodBlocks.resize(Chunk::Size3);
+            auto lodBlocks = std::span<BlockID const>(arena.LodBlocks);
+            for (u8 lod = 1; lod < ChunkMeshData::LodCount; lod++)
+            {
+                faceSolidMasks.assign(LayerFaceMaskCount, 0);
+                BuildLodBlocks(blocks, blockStates, lod, arena.LodBlocks);
+                BuildFaceMasks(blocks, lodBlocks, faceSolidMasks);
+                // Merged blocks are still emitted as full resolution quads, so they pack and draw like any other.
+                MeshLayers(blocks, lodBlocks, nullptr, lod, arena);
+            }
+        }
+
+        // Gather the faces into the mesh's buffer, with a single allocation of the exact size.
+        u32 quadCount = 0;
+        for (u32 i = 0; i < arena.Faces.size(); i++)
+        {
+            chunkMeshData.FaceOffsets[i] = quadCount;
+            quadCount += u32(arena.Faces[i].size());
+        }
+        chunkMeshData.FaceOffsets.back() = quadCount;
+        chunkMeshData.Quads.reserve(quadCount);
+        for (auto& face : arena.Faces)
+            chunkMeshData.Quads.insert(chunkMeshData.Quads.end(), face.begin(), face.end());
+
+        return chunkMeshData;
+    }
+
+    void ChunkMesher::BuildFaceMasks(BlockRegistry const& blocks, BlockStateRegistry const& blockStates, std::span<u32> faceSolidMasks)
+    {
+        auto view = blockStates.GetView<BlockState>();
+        for (auto e : view)
+        {
+            // TODO: variants
+            auto& blockState = view.get<BlockState>(e);
+            // Only sample block states with a model.
+            // Use the entt::entity/id_type as the block index.
+            if (auto* model = blocks.TryGetComponent<BlockModel>(blockState.BlockID))
+                AddBlockFaces(faceSolidMasks.subspan(model->Layer.Index() * FaceMaskCount, FaceMaskCount), *model, std::to_underlying(e));
+        }
+    }
+
+    void ChunkMesher::BuildFaceMasks(BlockRegistry const& blocks, std::span<BlockID const> blockIDs, std::span<u32> faceSolidMasks)
+    {
+        for (u32 index = 0; index < Chunk::Size3; index++)
+        {
+            if (auto* model = blocks.TryGetComponent<BlockModel>(blockIDs[index]))
+                AddBlockFaces(faceSolidMasks.subspan(model->Layer.Index() * FaceMaskCount, FaceMaskCount), *model, index);
+        }
+    }
+
+    void ChunkMesher::BuildLodBlocks(BlockRegistry const& blocks, BlockStateRegistry const& blockStates, u8 lod, std::span<BlockID> lodBlocks)
+    {
+        ENG_ASSERT(lod > 0 and lod < ChunkMeshData::LodCount);
+        u32 cellsPerAxis = Chunk::Size >> lod;
+        auto getCellIndex = [lod, cellsPerAxis](u32 index)
+        {
+            u32 x = index % Chunk::Size >> lod;
+            u32 y = index / Chunk::Size % Chunk::Size >> lod;
+            u32 z = index / Chunk::Size2 >> lod;
+            return x + cellsPerAxis * (y + cellsPerAxis * z);
+        };
+
+        // The height of each cell's chosen block, -1 if it isn't solid or -2 if none is chosen yet. Any solid
+        // block beats a non-solid one, and higher solid blocks beat lower ones, so surfaces keep their top texture.
+        std::array<BlockID, Chunk::Size3 / 8> cellBlocks;
+        std::array<i8, Chunk::Size3 / 8> cellHeights;
+        std::ranges::fill(cellHeights, i8(-2));
+
+        auto view = blockStates.GetView<BlockState>();
+        for (auto e : view)
+        {
+            u32 index = std::to_underlying(e);
+            BlockID blockID = view.get<BlockState>(e).BlockID;
+            i8 height = blocks.HasComponent<BlockModel>(blockID) ? i8(index / Chunk::Size % Chunk::Size) : i8(-1);
+            u32 cellIndex = getCellIndex(index);
+            if (height > cellHeights[cellIndex])
+            {
+                cellBlocks[cellIndex] = blockID;
+                cellHeights[cellIndex] = height;
+            }
+        }
+
+        for (u32 index = 0; index < Chunk::Size3; index++)
+            lodBlocks[index] = cellBlocks[getCellIndex(index)];
+    }
+
+    bool ChunkMesher::HasSolidFaces(std::span<u32 const> faceSolidMasks)
+    {
+        return std::ranges::any_of(faceSolidMasks, [](u32 mask) { return mask != 0; });
+    }
+
+    void ChunkMesher::InsertChunkEdges(
+        BlockRegistry const& blocks,
+        Neighbours const& neighbours,
+        std::span<u32> faceSolidMasks,
+        RenderLayer layer
+    )
+    {
+        auto insertChunkEdge = [&blocks, faceSolidMasks, layer](BlockStateRegistry const* chunkBlockStateRegistry, u8 face, u8 x, u8 y, u8 z, u8 px, u8 py)
+        {
+            auto& mask = faceSolidMasks[px + Chunk::Size * py + Chunk::Size2 * face];
+            if (chunkBlockStateRegistry)
+            {
+                auto view = chunkBlockStateRegistry->GetView<BlockState>();
+                auto e = static_cast<entt::entity>(x + Chunk::Size * (y + Chunk::Size * z));
+                auto& blockState = view.get<BlockState>(e);
+                auto* model = blocks.TryGetComponent<BlockModel>(blockState.BlockID);
+                if (model and model->Layer == layer)
+                    mask |= model->SolidBits >> (face ^ 1) & 1;
+            }
+            // Treat non-existent chunks as solid.
+            else
+                mask |= 1;
+        };
+
+        for (u8 py = 0; py < Chunk::Size; py++)
+        {
+            for (u8 px = 0; px < Chunk::Size; px++)
+            {
+                insertChunkEdge(neighbours[0], 0, 15, py, px, px, py);
+                insertChunkEdge(neighbours[1], 1, 0,  py, px, px, py);
+                insertChunkEdge(neighbours[2], 2, px, 15, py, px, py);
+                insertChunkEdge(neighbours[3], 3, px, 0,  py, px, py);
+                insertChunkEdge(neighbours[4], 4, px, py, 15, px, py);
+                insertChunkEdge(neighbours[5], 5, px, py, 0,  px, py);
+            }
+        }
+    }
+
+    void ChunkMesher::CullFaces(std::span<u32> faceSolidMasks)
+    {
+        // Face culling. Yes, it's this simple.
+        for (auto& mask : faceSolidMasks)
+            mask = u16((mask & ~(mask << 1)) >> 1);
+    }
+
+    void ChunkMesher::CullFaces(std::span<u32> faceSolidMasks, std::span<u32 const> occluderMasks)
+    {
+        for (u32 i = 0; i < faceSolidMasks.size(); i++)
+            faceSolidMasks[i] = u16((faceSolidMasks[i] & ~(occluderMasks[i] << 1)) >> 1);
+    }
+
+    template <typename B>
+    void ChunkMesher::MeshLayers(BlockRegistry const& blocks, B const& blockSource, Neighbours const* neighbours, u8 lod, Arena& arena)
+    {
+        auto getLayerMasks = [&arena](RenderLayer layer)
+        {
+            return std::span(arena.FaceSolidMasks).subspan(layer.Index() * FaceMaskCount, FaceMaskCount);
+        };
+        auto opaqueMasks = getLayerMasks(RenderLayer::Opaque);
+        auto cutoutMasks = getLayerMasks(RenderLayer::Cutout);
+        auto translucentMasks = getLayerMasks(RenderLayer::Translucent);
+
+        // TODO: the order { front back bottom left right top } seems optimal for cache (profile).
+        {
+            ENG_PROFILE_ZONE("ChunkMesher::CullFaces");
+            if (neighbours)
+                InsertChunkEdges(blocks, *neighbours, opaqueMasks);
+
+            // Most chunks are only opaque, so the other layers' occluders are only kept when needed.
+            bool hasCutout = HasSolidFaces(cutoutMasks);
+            bool hasTranslucent = HasSolidFaces(translucentMasks);
+            auto& occluderMasks = arena.OccluderMasks;
+            if (hasCutout or hasTranslucent)
+                occluderMasks.assign(opaqueMasks.begin(), opaqueMasks.end());
+
+            CullFaces(opaqueMasks);
+            if (hasCutout)
+                CullFaces(cutoutMasks, occluderMasks);
+            if (hasTranslucent)
+            {
+                for (u32 i = 0; i < FaceMaskCount; i++)
+                    occluderMasks[i] |= translucentMasks[i];
+                if (neighbours)
+                    InsertChunkEdges(blocks, *neighbours, occluderMasks, RenderLayer::Translucent);
+                CullFaces(translucentMasks, occluderMasks);
+            }
+        }
+
+        for (RenderLayer layer : RenderLayers)
+        {
+            auto layerMasks = getLayerMasks(layer);
+            if (not HasSolidFaces(layerMasks))
+                continue;
+
+            {
+                ENG_PROFILE_ZONE("ChunkMesher::BuildGreedyMeshingPlanes");
+                BuildGreedyMeshingPlanes(blocks, blockSource, layerMasks, arena.GreedyMeshingPlanes);
+            }
+
+            // Pack each quad into the appropriate face.
+            {
+                ENG_PROFILE_ZONE("ChunkMesher::GreedyMerge");
+                auto faces = std::span(arena.Faces).subspan(ChunkMeshData::GetSubmesh(MeshType::_Begin, lod, layer), FaceCount);
+                GreedyMerge(arena.GreedyMeshingPlanes, [faces](u8 face, TextureID textureID, GreedyQuad quad)
+                {
+                    faces[face].push_back(PackQuad(textureID, quad));
+                });
+            }
+        }
+    }
+
+    template <typename F>
+    void ChunkMesher::FillGreedyMeshingPlanes(
+        BlockRegistry const& blocks,
+        F&& getBlockID,
+        std::span<u32 const> faceSolidMasks,
+        GreedyMeshingPlanes& greedyMeshingPlanes
+    )
+    {
+        u16 maskIndex = 0;
+        for (u8 face = 0; face < FaceCount; face++)
+        {
+            for (u8 py = 0; py < Chunk::Size; py++)
+            {
+                for (u8 px = 0; px < Chunk::Size; px++)
+                {
+                    // Get the current mask.
+                    u16 mask = u16(faceSolidMasks[maskIndex++]);
+                    while (mask)
+                    {
+                        // Calculate the block plane z coord.
+                        u8 pz = std::countr_zero(mask);
+                        // Mark this bit as completed (unset it).
+                        mask &= mask - 1;
+
+                        // Get the true local block position.
+                        BlockID blockID = getBlockID(PlaneToLocal(face, px, py, pz));
+                        // NOTE: No need to try get again, it was already checked and does exist.
+                        // TODO: How to not sample twice? Can't exactly cache the texture ids since
+                        // that would just move the problem and add overhead.
+                        auto& model = blocks.GetComponent<BlockModel>(blockID);
+                        // Put this face in the appropriate greedy meshing plane.
+                        TextureID textureID = (&model.Left)[face];
+                        greedyMeshingPlanes[textureID][py + Chunk::Size * pz + Chunk::Size2 * face] |= u16(1 << px);
+                    }
+                }
+            }
+        }
+    }
+    void ChunkMesher::BuildGreedyMeshingPlanes(
+        BlockRegistry const& blocks,
+        BlockStateRegistry const& blockStates,
+        std::span<u32 const> faceSolidMasks,
+        GreedyMeshingPlanes& greedyMeshingPlanes
+    )
+    {
+        auto view = blockStates.GetView<BlockState>();
+        FillGreedyMeshingPlanes(blocks, [&view](u16 index)
+        {
+            return view.get<BlockState>(static_cast<entt::entity>(index)).BlockID;
+        }, faceSolidMasks, greedyMeshingPlanes);
+    }
+
+    void ChunkMesher::BuildGreedyMeshingPlanes(
+        BlockRegistry const& blocks,
+        std::span<BlockID const> blockIDs,
+        std::span<u32 const> faceSolidMasks,
+        GreedyMeshingPlanes& greedyMeshingPlanes
+    )
+    {
+        FillGreedyMeshingPlanes(blocks, [blockIDs](u16 index) { return blockIDs[index]; }, faceSolidMasks, greedyMeshingPlanes);
+    }
+
+}
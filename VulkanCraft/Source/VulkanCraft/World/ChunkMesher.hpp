@@ -0,0 +1,213 @@
+#pragma once
+
+#include "VulkanCraft/Rendering/ChunkMeshData.hpp"
+#include "VulkanCraft/Rendering/TextureID.hpp"
+#include "VulkanCraft/World/BlockRegistry.hpp"
+#include "VulkanCraft/World/BlockStateRegistry.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+#include <array>
+#include <bit>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    // Binary greedy mesher for a single chunk.
+    // The individual kernels are exposed so they can be benchmarked and swapped in isolation.
+    class ChunkMesher
+    {
+        ENG_STATIC_CLASS(ChunkMesher);
+    public:
+        // Face order matches MeshType and BlockModel: left, right, bottom, top, back, front.
+        inline static constexpr u32 FaceCount = 6;
+        // One mask per face plane row. The 16 bits along the face's normal are padded
+        // on both ends by a bit for the neighbouring chunk's edge block.
+        inline static constexpr u32 FaceMaskCount = Chunk::Size2 * FaceCount;
+        // A set of face masks per render layer, in RenderLayer order.
+        inline static constexpr u32 LayerFaceMaskCount = FaceMaskCount * RenderLayer::_Count;
+
+        // Block states of the six neighbouring chunks, in face order.
+        // Missing neighbours are treated as solid.
+        using Neighbours = std::array<BlockStateRegistry const*, FaceCount>;
+
+        // NOTE: These are stored using std::array since they will already be on the heap from std::unordered_map.
+        // TODO: variants, e.g. rotations, will be added to the hashed key type.
+        using GreedyMeshingPlanes = std::unordered_map<TextureID, std::array<u16, FaceMaskCount>>;
+
+        struct GreedyQuad
+        {
+            u8 x, y, z, w, h;
+        };
+
+        // Scratch memory reused from mesh to mesh, so once it has grown to fit, meshing a chunk
+        // only allocates the finished mesh's buffer.
+        struct Arena
+        {
+            std::vector<u32> FaceSolidMasks; // A set per render layer.
+            std::vector<u32> OccluderMasks;
+            GreedyMeshingPlanes GreedyMeshingPlanes; // GreedyMerge leaves every plane empty for the next mesh.
+            std::vector<BlockID> LodBlocks;
+            std::array<std::vector<uvec2>, ChunkMeshData::SubmeshCount> Faces; // By render layer, then level of detail, then face.
+        };
+    public:
+        // Runs every kernel below in order, using the calling thread's arena.
+        // Levels of detail after the first are meshed from BuildLodBlocks without InsertChunkEdges,
+        // so their faces along the chunk's edges are kept as skirts over the seams to other levels.
+        static ChunkMeshData GenerateMesh(
+            BlockRegistry const& blocks,
+            ChunkPos chunkPos,
+            BlockStateRegistry const& blockStates,
+            Neighbours const& neighbours
+        );
+        static ChunkMeshData GenerateMesh(
+            BlockRegistry const& blocks,
+            ChunkPos chunkPos,
+            BlockStateRegistry const& blockStates,
+            Neighbours const& neighbours,
+            Arena& arena
+        );
+
+        // Represents the solid state of block faces in binary, each in the set of its block model's render layer.
+        static void BuildFaceMasks(BlockRegistry const& blocks, BlockStateRegistry const& blockStates, std::span<u32> faceSolidMasks);
+        // The same as above, from a block per block index rather than the chunk's block states.
+        static void BuildFaceMasks(BlockRegistry const& blocks, std::span<BlockID const> blockIDs, std::span<u32> faceSolidMasks);
+        // Merges cells of 2^lod blocks along every axis into the topmost solid block in them, for every block in the cell.
+        // Cells with any solid block stay solid, so a level of detail never sinks below the finer ones next to it.
+        static void BuildLodBlocks(BlockRegistry const& blocks, BlockStateRegistry const& blockStates, u8 lod, std::span<BlockID> lodBlocks);
+        // Returns if any face mask has a solid bit, i.e. if the chunk could have a mesh at all.
+        static bool HasSolidFaces(std::span<u32 const> faceSolidMasks);
+        // Sets the padding bits from the neighbouring chunks' edge blocks in the given render layer.
+        static void InsertChunkEdges(
+            BlockRegistry const& blocks,
+            Neighbours const& neighbours,
+            std::span<u32> faceSolidMasks,
+            RenderLayer layer = RenderLayer::Opaque
+        );
+        // Leaves only the faces that aren't covered by the next block along their normal.
+        static void CullFaces(std::span<u32> faceSolidMasks);
+        // The same as above, with the covering blocks from another set of masks, e.g. for faces that only opaque blocks cover.
+        static void CullFaces(std::span<u32> faceSolidMasks, std::span<u32 const> occluderMasks);
+        // Sorts the visible faces into planes by texture.
+        static void BuildGreedyMeshingPlanes(
+            BlockRegistry const& blocks,
+            BlockStateRegistry const& blockStates,
+            std::span<u32 const> faceSolidMasks,
+            GreedyMeshingPlanes& greedyMeshingPlanes
+        );
+        static void BuildGreedyMeshingPlanes(
+            BlockRegistry const& blocks,
+            std::span<BlockID const> blockIDs,
+            std::span<u32 const> faceSolidMasks,
+            GreedyMeshingPlanes& greedyMeshingPlanes
+        );
+        // Merges each plane into as few quads as possible, consuming the planes.
+        // Calls emit(face, textureID, quad) for each quad, in chunk coordinates.
+        template <typename F>
+        static void GreedyMerge(GreedyMeshingPlanes& greedyMeshingPlanes, F&& emit);
+
+        //                   packedFaceData.y                 packedFaceData.x
+        // 64  60  56  52  48  44  40  36  32   28  24  20  16  12   8   4   0
+        //   ----------------------cccccchhhh wwwwzzzzyyyyxxxxtttttttttttttttt
+        // t = texture id, x = local x, y = local y, z = local z, w = width, h = height,
+        // c = chunk offset in its super chunk, left as 0 here (see ChunkDrawPacking::PackSuperChunkOffset)
+        static constexpr uvec2 PackQuad(TextureID textureID, GreedyQuad quad)
+        {
+            return
+            {
+                u32(quad.w - 1) << 28 | u32(quad.z) << 24 | u32(quad.y) << 20 | u32(quad.x) << 16 | std::to_underlying(textureID),
+                /* extra 18 bits */ u32(quad.h - 1),
+            };
+        }
+    private:
+        // Culls every render layer's face masks and merges them into the arena's faces for the level of detail.
+        // Cutout faces are only covered by opaque blocks, and translucent faces by opaque and translucent blocks.
+        // Without neighbours, the padding bits are left as air.
+        template <typename B>
+        static void MeshLayers(BlockRegistry const& blocks, B const& blockSource, Neighbours const* neighbours, u8 lod, Arena& arena);
+
+        // Shared by both BuildGreedyMeshingPlanes, with getBlockID(index) returning the block at a local block index.
+        template <typename F>
+        static void FillGreedyMeshingPlanes(
+            BlockRegistry const& blocks,
+            F&& getBlockID,
+            std::span<u32 const> faceSolidMasks,
+            GreedyMeshingPlanes& greedyMeshingPlanes
+        );
+
+        // Converts plane coords to a local block index.
+        static constexpr u16 PlaneToLocal(u8 face, u8 px, u8 py, u8 pz)
+        {
+            switch (face)
+            {
+                case 0:  return u16(u16(pz)      | u16(py)      << 4 | u16(px)      << 8); // left
+                case 1:  return u16(u16(15 - pz) | u16(py)      << 4 | u16(px)      << 8); // right
+                case 2:  return u16(u16(px)      | u16(pz)      << 4 | u16(py)      << 8); // bottom
+                case 3:  return u16(u16(px)      | u16(15 - pz) << 4 | u16(py)      << 8); // top
+                case 4:  return u16(u16(px)      | u16(py)      << 4 | u16(pz)      << 8); // back
+                default: return u16(u16(px)      | u16(py)      << 4 | u16(15 - pz) << 8); // front
+            }
+        }
+    };
+
+    template <typename F>
+    void ChunkMesher::GreedyMerge(GreedyMeshingPlanes& greedyMeshingPlanes, F&& emit)
+    {
+        for (auto& [textureID, facePlanes] : greedyMeshingPlanes)
+        {
+            for (u8 face = 0; face < FaceCount; face++)
+            {
+                for (u8 pz = 0; pz < Chunk::Size; pz++)
+                {
+                    auto plane = std::span(facePlanes).subspan(Chunk::Size * pz + Chunk::Size2 * face, Chunk::Size);
+
+                    for (u8 py = 0; py < Chunk::Size; py++)
+                    {
+                        for (u8 px = 0; px < Chunk::Size; )
+                        {
+                            // Expand the quad horizontally.
+                            px += std::countr_zero<u16>(plane[py] >> px);
+                            // If there's no solid faces left, stop advancing.
+                            if (px >= Chunk::Size)
+                                break;
+
+                            u8 width = std::countr_one<u16>(plane[py] >> px);
+                            u16 widthMask = ((1 << width) - 1) << px;
+                            // Consume this mask.
+                            plane[py] &= ~widthMask;
+
+                            // Expand the quad vertically.
+                            u8 height = 1;
+                            while (py + height < Chunk::Size)
+                            {
+                                u16 nextMask = plane[py + height] & widthMask;
+                                // Stop expanding if the next mask doesn't have all
+                                // solid faces set as the initial width mask.
+                                if (nextMask != widthMask)
+                                    break;
+                                // Expand into the next mask.
+                                plane[py + height] &= ~widthMask;
+                                height++;
+                            }
+
+                            // Convert plane coords to chunk coords.
+                            u16 index = PlaneToLocal(face, px, py, pz);
+                            u8 x = index % Chunk::Size;
+                            u8 y = index / Chunk::Size % Chunk::Size;
+                            u8 z = index / Chunk::Size2;
+
+                            emit(face, textureID, GreedyQuad{x, y, z, width, height});
+
+                            px += width;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
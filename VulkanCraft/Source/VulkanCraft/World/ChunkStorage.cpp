@@ -0,0 +1,206 @@
+#include "ChunkStorage.hpp"
+#include <cstring>
+
+namespace vc
+{
+    // Chunk format:
+    //  u16 PaletteSize
+    //  PaletteSize * {u8 IDSize, char ID[IDSize]}  Block IDs, so saves don't depend on block registration order.
+    //  Blocks as palette indices, compressed by ChunkCodec.
+
+    ChunkStorage::ChunkStorage(BlockRegistry const& blocks, path const& directory)
+        : m_Blocks(blocks)
+        , m_Directory(directory)
+        , m_WriterThread([this] { WriterThread(); })
+    {
+
+    }
+
+    ChunkStorage::~ChunkStorage()
+    {
+        {
+            std::unique_lock lock(m_QueuedSaveMutex);
+            m_Running = false;
+        }
+        m_QueuedSaveCondition.notify_one();
+    }
+
+    bool ChunkStorage::Contains(ChunkPos chunkPos)
+    {
+        {
+            std::unique_lock lock(m_QueuedSaveMutex);
+            if (m_QueuedSaves.contains(chunkPos))
+                return true;
+        }
+
+        auto regionFile = GetRegionFile(RegionFile::GetRegionPos(chunkPos), false);
+        return regionFile and regionFile->Contains(RegionFile::GetLocalChunkPos(chunkPos));
+    }
+
+    bool ChunkStorage::LoadChunk(ChunkPos chunkPos, BlockStateRegistry& blockStates)
+    {
+        ENG_PROFILE_FUNCTION();
+
+        // Chunks that haven't been written yet are copied from the queue.
+        std::shared_ptr<Chunk const> queuedChunk;
+        {
+            std::unique_lock lock(m_QueuedSaveMutex);
+            if (auto it = m_QueuedSaves.find(chunkPos); it != m_QueuedSaves.end())
+                queuedChunk = it->second;
+        }
+        if (queuedChunk)
+        {
+            blockStates = queuedChunk->GetBlockStates();
+            return true;
+        }
+
+        auto regionFile = GetRegionFile(RegionFile::GetRegionPos(chunkPos), false);
+        if (not regionFile)
+            return false;
+
+        uvec3 localChunkPos = RegionFile::GetLocalChunkPos(chunkPos);
+        u64 byteSize = 0;
+        bool read = regionFile->Read(localChunkPos, [&](std::span<u8 const> bytes)
+        {
+            byteSize = bytes.size();
+            return DeserializeChunk(bytes, blockStates);
+        });
+        if (not read)
+        {
+            if (regionFile->Contains(localChunkPos))
+            {
+                ENG_LOG_WARN("Failed to read saved chunk ({}, {}, {}), it will be generated again.", chunkPos.x, chunkPos.y, chunkPos.z);
+                regionFile->Erase(localChunkPos);
+            }
+            return false;
+        }
+
+        m_LoadedChunkCounter.Add();
+        m_LoadedByteCounter.Add(byteSize);
+        return true;
+    }
+
+    void ChunkStorage::SaveChunk(std::shared_ptr<Chunk const> chunk)
+    {
+        {
+            std::unique_lock lock(m_QueuedSaveMutex);
+            m_QueuedSaves[chunk->GetPosition()] = std::move(chunk);
+            m_QueuedSaveGauge.Set(i64(m_QueuedSaves.size()));
+        }
+        m_QueuedSaveCondition.notify_one();
+    }
+
+    std::shared_ptr<RegionFile> ChunkStorage::GetRegionFile(ivec3 regionPos, bool create)
+    {
+        std::unique_lock lock(m_RegionFileMutex);
+        auto [it, inserted] = m_RegionFiles.try_emplace(regionPos);
+        if (inserted or (create and not it->second))
+        {
+            path filepath = m_Directory / fmt::format("r.{}.{}.{}.vcr", regionPos.x, regionPos.y, regionPos.z);
+            it->second = RegionFile::Open(filepath, create);
+        }
+        return it->second;
+    }
+
+    void ChunkStorage::SerializeChunk(Chunk const& chunk, std::vector<u8>& bytes) const
+    {
+        PalettedBlocks blocks;
+        blocks.Assign(chunk.GetBlockStates());
+
+        bytes.clear();
+        auto append = [&bytes](void const* data, u64 size)
+        {
+            bytes.insert(bytes.end(), static_cast<u8 const*>(data), static_cast<u8 const*>(data) + size);
+        };
+
+        u16 paletteSize = u16(blocks.Palette.size());
+        append(&paletteSize, sizeof(paletteSize));
+        for (BlockID blockID : blocks.Palette)
+        {
+            small_string const& id = m_Blocks.GetComponent<Block>(blockID).ID;
+            u8 idSize = u8(std::min<u64>(id.size(), u8(-1)));
+            append(&idSize, sizeof(idSize));
+            append(id.data(), idSize);
+        }
+        ChunkCodec::Encode(blocks, bytes);
+    }
+
+    bool ChunkStorage::DeserializeChunk(std::span<u8 const> bytes, BlockStateRegistry& blockStates) const
+    {
+        auto read = [&bytes](void* data, u64 size)
+        {
+            if (bytes.size() < size)
+                return false;
+            std::memcpy(data, bytes.data(), size);
+            bytes = bytes.subspan(size);
+            return true;
+        };
+
+        u16 paletteSize = 0;
+        if (not read(&paletteSize, sizeof(paletteSize)))
+            return false;
+
+        PalettedBlocks blocks;
+        blocks.Palette.resize(paletteSize);
+        for (BlockID& blockID : blocks.Palette)
+        {
+            u8 idSize = 0;
+            small_string id;
+            if (not read(&idSize, sizeof(idSize)))
+                return false;
+            id.resize(idSize);
+            if (not read(id.data(), idSize))
+                return false;
+            // Blocks that no longer exist become void.
+            blockID = m_Blocks.GetBlock(id);
+        }
+
+        if (not ChunkCodec::Decode(bytes, blocks))
+            return false;
+
+        BlockStateRegistry loadedBlockStates;
+        blocks.CreateBlockStates(loadedBlockStates);
+        blockStates = std::move(loadedBlockStates);
+        return true;
+    }
+
+    void ChunkStorage::WriterThread()
+    {
+        ThreadTracer tracer("chunk storage writer");
+
+        std::vector<u8> bytes;
+        while (true)
+        {
+            // Chunks stay queued until they're written, so they can still be loaded in the meantime.
+            std::shared_ptr<Chunk const> chunk;
+            {
+                std::unique_lock lock(m_QueuedSaveMutex);
+                m_QueuedSaveCondition.wait(lock, [this] { return not m_QueuedSaves.empty() or not m_Running; });
+                // Stop only once every queued save is written.
+                if (m_QueuedSaves.empty())
+                    break;
+                chunk = m_QueuedSaves.begin()->second;
+            }
+
+            ChunkPos chunkPos = chunk->GetPosition();
+            {
+                ENG_PROFILE_ZONE("ChunkStorage::Save");
+                SerializeChunk(*chunk, bytes);
+                if (auto regionFile = GetRegionFile(RegionFile::GetRegionPos(chunkPos), true))
+                {
+                    if (regionFile->Write(RegionFile::GetLocalChunkPos(chunkPos), bytes))
+                    {
+                        m_SavedChunkCounter.Add();
+                        m_SavedByteCounter.Add(bytes.size());
+                    }
+                }
+            }
+
+            // Chunks saved again while being written stay queued to be written again.
+            std::unique_lock lock(m_QueuedSaveMutex);
+            if (auto it = m_QueuedSaves.find(chunkPos); it != m_QueuedSaves.end() and it->second == chunk)
+                m_QueuedSaves.erase(it);
+            m_QueuedSaveGauge.Set(i64(m_QueuedSaves.size()));
+        }
+    }
+}
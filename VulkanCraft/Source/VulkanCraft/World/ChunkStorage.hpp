@@ -0,0 +1,70 @@
+#pragma once
+
+#include "VulkanCraft/World/BlockRegistry.hpp"
+#include "VulkanCraft/World/BlockStateRegistry.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkCodec.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include "VulkanCraft/World/RegionFile.hpp"
+#include <Engine.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    // Saves generated and edited chunks into region files in a directory, and loads them back.
+    // Saves are written by a writer thread, so they never block the caller, and loads are read
+    // straight out of the mapped region files. Can be used from any thread.
+    class ChunkStorage
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(ChunkStorage);
+    public:
+        ChunkStorage(BlockRegistry const& blocks, path const& directory);
+        // Finishes writing every queued save.
+        ~ChunkStorage();
+
+        ENG_NO_DISCARD bool Contains(ChunkPos chunkPos);
+        // Reads the block states of a saved chunk; returns true if it was read, or false if not.
+        // Chunks that can't be read are forgotten, so they're generated again.
+        bool LoadChunk(ChunkPos chunkPos, BlockStateRegistry& blockStates);
+        // Queues a chunk to be saved. Saving a chunk again before it's written replaces the queued save.
+        void SaveChunk(std::shared_ptr<Chunk const> chunk);
+    private:
+        // Returns the region file, or nullptr if it doesn't exist and create isn't set.
+        std::shared_ptr<RegionFile> GetRegionFile(ivec3 regionPos, bool create);
+
+        void SerializeChunk(Chunk const& chunk, std::vector<u8>& bytes) const;
+        bool DeserializeChunk(std::span<u8 const> bytes, BlockStateRegistry& blockStates) const;
+
+        void WriterThread();
+    private:
+        BlockRegistry const& m_Blocks; // non-owning
+        path m_Directory;
+
+        // Open region files, or nullptr for ones that don't exist yet, so they're only looked for once.
+        std::unordered_map<ivec3, std::shared_ptr<RegionFile>, ChunkPosHash> m_RegionFiles;
+        std::mutex m_RegionFileMutex;
+
+        // Chunks waiting for the writer thread.
+        std::unordered_map<ChunkPos, std::shared_ptr<Chunk const>, ChunkPosHash> m_QueuedSaves;
+        std::mutex m_QueuedSaveMutex;
+        std::condition_variable m_QueuedSaveCondition;
+        bool m_Running = true;
+
+        MetricCounter& m_LoadedChunkCounter = Metrics::GetCounter("chunk_storage.loaded_chunks");
+        MetricCounter& m_LoadedByteCounter = Metrics::GetCounter("chunk_storage.loaded_bytes");
+        MetricCounter& m_SavedChunkCounter = Metrics::GetCounter("chunk_storage.saved_chunks");
+        MetricCounter& m_SavedByteCounter = Metrics::GetCounter("chunk_storage.saved_bytes");
+        MetricGauge& m_QueuedSaveGauge = Metrics::GetGauge("chunk_storage.queued_saves");
+
+        // Declared last, so it stops before anything it uses is destroyed.
+        std::jthread m_WriterThread;
+    };
+}
@@ -0,0 +1,124 @@
+#include "ChunkStreamer.hpp"
+#include <algorithm>
+
+namespace vc
+{
+    ChunkStreamer::ChunkStreamer(u32 horizontalRenderDistance, u32 verticalRenderDistance)
+        : m_HorizontalRenderDistance(horizontalRenderDistance)
+        , m_VerticalRenderDistance(verticalRenderDistance)
+    {
+    }
+
+    void ChunkStreamer::SetRenderDistance(u32 horizontalRenderDistance, u32 verticalRenderDistance)
+    {
+        m_HorizontalRenderDistance = horizontalRenderDistance;
+        m_VerticalRenderDistance = verticalRenderDistance;
+    }
+
+    bool ChunkStreamer::Update(ChunkPos center, std::vector<ChunkPos>& loads, std::vector<ChunkPos>& unloads)
+    {
+        Cylinder desired
+        {
+            .Center = center,
+            .HorizontalRadius = i32(m_HorizontalRenderDistance),
+            .VerticalRadius = i32(m_VerticalRenderDistance),
+        };
+        if (desired.Center == m_Desired.Center and
+            desired.HorizontalRadius == m_Desired.HorizontalRadius and
+            desired.VerticalRadius == m_Desired.VerticalRadius)
+            return false;
+
+        ENG_PROFILE_ZONE("ChunkStreamer::Update");
+
+        Cylinder kept
+        {
+            .Center = center,
+            .HorizontalRadius = desired.HorizontalRadius + i32(UnloadMargin),
+            .VerticalRadius = desired.VerticalRadius + i32(UnloadMargin),
+        };
+
+        // Chunks that come back into view before leaving the margin are still loaded.
+        u64 firstLoad = loads.size();
+        Difference(desired, m_Desired, loads);
+        loads.erase(std::remove_if(loads.begin() + firstLoad, loads.end(), [this](ChunkPos chunkPos) { return not m_Loaded.insert(chunkPos).second; }), loads.end());
+        u64 firstUnload = unloads.size();
+        Difference(m_Kept, kept, unloads);
+        unloads.erase(std::remove_if(unloads.begin() + firstUnload, unloads.end(), [this](ChunkPos chunkPos) { return m_Loaded.erase(chunkPos) == 0; }), unloads.end());
+        m_Desired = desired;
+        m_Kept = kept;
+
+        // Load outward from the center, so the closest chunks are generated first.
+        auto distance2 = [center](ChunkPos chunkPos)
+        {
+            ivec3 offset = chunkPos - center;
+            return offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+        };
+        std::sort(loads.begin() + firstLoad, loads.end(), [&](ChunkPos lhs, ChunkPos rhs)
+        {
+            return distance2(lhs) < distance2(rhs);
+        });
+        return true;
+    }
+
+    bool ChunkStreamer::IsLoaded(ChunkPos chunkPos) const noexcept
+    {
+        return m_Loaded.contains(chunkPos);
+    }
+
+    u64 ChunkStreamer::GetMaxChunkCount(u32 horizontalRenderDistance, u32 verticalRenderDistance) noexcept
+    {
+        Cylinder cylinder
+        {
+            .HorizontalRadius = i32(horizontalRenderDistance + UnloadMargin),
+            .VerticalRadius = i32(verticalRenderDistance + UnloadMargin),
+        };
+        u64 columnCount = 0;
+        for (i32 z = -cylinder.HorizontalRadius; z <= cylinder.HorizontalRadius; z++)
+            for (i32 x = -cylinder.HorizontalRadius; x <= cylinder.HorizontalRadius; x++)
+                columnCount += cylinder.ContainsColumn(x, z);
+        return columnCount * u64(2 * cylinder.VerticalRadius + 1);
+    }
+
+    bool ChunkStreamer::Cylinder::ContainsColumn(i32 x, i32 z) const noexcept
+    {
+        i32 dx = x - Center.x;
+        i32 dz = z - Center.z;
+        return dx * dx + dz * dz <= HorizontalRadius * HorizontalRadius and HorizontalRadius >= 0;
+    }
+
+    bool ChunkStreamer::Cylinder::Contains(ChunkPos chunkPos) const noexcept
+    {
+        return ContainsColumn(chunkPos.x, chunkPos.z) and std::abs(chunkPos.y - Center.y) <= VerticalRadius;
+    }
+
+    void ChunkStreamer::Difference(Cylinder const& from, Cylinder const& to, std::vector<ChunkPos>& chunks)
+    {
+        // Only columns are visited; the chunks of a column are a range of heights, so the
+        // difference within a column is at most two ranges.
+        i32 fromMinY = from.Center.y - from.VerticalRadius;
+        i32 fromMaxY = from.Center.y + from.VerticalRadius;
+        i32 toMinY = to.Center.y - to.VerticalRadius;
+        i32 toMaxY = to.Center.y + to.VerticalRadius;
+
+        for (i32 z = from.Center.z - from.HorizontalRadius; z <= from.Center.z + from.HorizontalRadius; z++)
+        {
+            for (i32 x = from.Center.x - from.HorizontalRadius; x <= from.Center.x + from.HorizontalRadius; x++)
+            {
+                if (not from.ContainsColumn(x, z))
+                    continue;
+
+                if (not to.ContainsColumn(x, z))
+                {
+                    for (i32 y = fromMinY; y <= fromMaxY; y++)
+                        chunks.emplace_back(x, y, z);
+                    continue;
+                }
+
+                for (i32 y = fromMinY; y <= std::min(fromMaxY, toMinY - 1); y++)
+                    chunks.emplace_back(x, y, z);
+                for (i32 y = std::max(fromMinY, toMaxY + 1); y <= fromMaxY; y++)
+                    chunks.emplace_back(x, y, z);
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+#include <unordered_set>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    // Decides which chunks should be loaded around a center chunk.
+    // The desired chunks are a vertical cylinder, within the horizontal render distance
+    // of the center's column and the vertical render distance of its height.
+    // Only chunks that enter or leave the cylinder are visited when the center moves,
+    // so staying within the same chunk costs nothing.
+    class ChunkStreamer
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(ChunkStreamer);
+    public:
+        // Loaded chunks are only unloaded once they're this many chunks beyond the render distances,
+        // so moving back and forth across a chunk boundary doesn't reload the chunks on the edge.
+        static constexpr u32 UnloadMargin = 2;
+    public:
+        ChunkStreamer(u32 horizontalRenderDistance, u32 verticalRenderDistance);
+
+        // Takes effect on the next update.
+        void SetRenderDistance(u32 horizontalRenderDistance, u32 verticalRenderDistance);
+
+        // Moves the center, appending the chunks that became desired and aren't loaded to loads, nearest first,
+        // and the loaded chunks that left the unload margin to unloads. Returns true if anything changed.
+        bool Update(ChunkPos center, std::vector<ChunkPos>& loads, std::vector<ChunkPos>& unloads);
+
+        // Whether the chunk was loaded and hasn't been unloaded since.
+        ENG_NO_DISCARD bool IsLoaded(ChunkPos chunkPos) const noexcept;
+
+        // The most chunks that can be loaded at once with the given render distances, including the unload margin.
+        ENG_NO_DISCARD static u64 GetMaxChunkCount(u32 horizontalRenderDistance, u32 verticalRenderDistance) noexcept;
+    private:
+        struct Cylinder
+        {
+            ChunkPos Center{};
+            i32 HorizontalRadius = -1; // Negative when empty.
+            i32 VerticalRadius = -1;
+
+            ENG_NO_DISCARD bool ContainsColumn(i32 x, i32 z) const noexcept;
+            ENG_NO_DISCARD bool Contains(ChunkPos chunkPos) const noexcept;
+        };
+
+        // Appends the chunks in from that aren't in to.
+        static void Difference(Cylinder const& from, Cylinder const& to, std::vector<ChunkPos>& chunks);
+    private:
+        Cylinder m_Desired;
+        // The desired cylinder widened by the unload margin. Loaded chunks never leave it.
+        Cylinder m_Kept;
+        std::unordered_set<ChunkPos, ChunkPosHash> m_Loaded;
+        u32 m_HorizontalRenderDistance;
+        u32 m_VerticalRenderDistance;
+    };
+}
@@ -0,0 +1,121 @@
+#include "DefaultBlocks.hpp"
+#include "VulkanCraft/Rendering/BlockModel.hpp"
+
+namespace vc
+{
+    void RegisterDefaultBlocks(BlockRegistry& blocks)
+    {
+        // TODO: block model files using yaml-cpp
+
+        // air
+        {
+            blocks.CreateBlock("minecraft:air");
+        }
+
+        // bedrock
+        {
+            BlockID block = blocks.CreateBlock("minecraft:bedrock");
+            BlockModel& model = blocks.EmplaceComponent<BlockModel>(block);
+            model.SolidBits = 0b111111;
+            model.Left = TextureID(0);
+            model.Right = TextureID(0);
+            model.Bottom = TextureID(0);
+            model.Top = TextureID(0);
+            model.Back = TextureID(0);
+            model.Front = TextureID(0);
+        }
+
+        // stone
+        {
+            BlockID block = blocks.CreateBlock("minecraft:stone");
+            BlockModel& model = blocks.EmplaceComponent<BlockModel>(block);
+            model.SolidBits = 0b111111;
+            model.Left = TextureID(1);
+            model.Right = TextureID(1);
+            model.Bottom = TextureID(1);
+            model.Top = TextureID(1);
+            model.Back = TextureID(1);
+            model.Front = TextureID(1);
+        }
+
+        // dirt
+        {
+            BlockID block = blocks.CreateBlock("minecraft:dirt");
+            BlockModel& model = blocks.EmplaceComponent<BlockModel>(block);
+            model.SolidBits = 0b111111;
+            model.Left = TextureID(2);
+            model.Right = TextureID(2);
+            model.Bottom = TextureID(2);
+            model.Top = TextureID(2);
+            model.Back = TextureID(2);
+            model.Front = TextureID(2);
+        }
+
+        // grass
+        {
+            BlockID block = blocks.CreateBlock("minecraft:grass");
+            BlockModel& model = blocks.EmplaceComponent<BlockModel>(block);
+            model.SolidBits = 0b111111;
+            model.Left = TextureID(3);
+            model.Right = TextureID(3);
+            model.Bottom = TextureID(2);
+            model.Top = TextureID(4);
+            model.Back = TextureID(3);
+            model.Front = TextureID(3);
+        }
+
+        // cobblestone
+        {
+            BlockID block = blocks.CreateBlock("minecraft:cobblestone");
+            BlockModel& model = blocks.EmplaceComponent<BlockModel>(block);
+            model.SolidBits = 0b111111;
+            model.Left = TextureID(5);
+            model.Right = TextureID(5);
+            model.Bottom = TextureID(5);
+            model.Top = TextureID(5);
+            model.Back = TextureID(5);
+            model.Front = TextureID(5);
+        }
+
+        // oak log
+        {
+            BlockID block = blocks.CreateBlock("minecraft:oak_log");
+            BlockModel& model = blocks.EmplaceComponent<BlockModel>(block);
+            model.SolidBits = 0b111111;
+            model.Left = TextureID(6);
+            model.Right = TextureID(6);
+            model.Bottom = TextureID(7);
+            model.Top = TextureID(7);
+            model.Back = TextureID(6);
+            model.Front = TextureID(6);
+        }
+
+        // oak leaves
+        {
+            BlockID block = blocks.CreateBlock("minecraft:oak_leaves");
+            BlockModel& model = blocks.EmplaceComponent<BlockModel>(block);
+            model.SolidBits = 0b111111;
+            model.Layer = RenderLayer::Cutout;
+            model.Left = TextureID(8);
+            model.Right = TextureID(8);
+            model.Bottom = TextureID(8);
+            model.Top = TextureID(8);
+            model.Back = TextureID(8);
+            model.Front = TextureID(8);
+        }
+
+        // ice
+        {
+            BlockID block = blocks.CreateBlock("minecraft:ice");
+            BlockModel& model = blocks.EmplaceComponent<BlockModel>(block);
+            model.SolidBits = 0b111111;
+            model.Layer = RenderLayer::Translucent;
+            model.Left = TextureID(9);
+            model.Right = TextureID(9);
+            model.Bottom = TextureID(9);
+            model.Top = TextureID(9);
+            model.Back = TextureID(9);
+            model.Front = TextureID(9);
+        }
+    }
+}
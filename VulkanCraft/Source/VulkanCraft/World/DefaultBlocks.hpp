@@ -0,0 +1,10 @@
+#pragma once
+
+#include "VulkanCraft/World/BlockRegistry.hpp"
+
+namespace vc
+{
+    // Registers the built-in blocks and their models.
+    // Shared by the game and the headless tools so both generate identical worlds.
+    void RegisterDefaultBlocks(BlockRegistry& blocks);
+}
@@ -0,0 +1,197 @@
+#include "FeaturePlacer.hpp"
+#include "VulkanCraft/World/SeededRandom.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace vc
+{
+    // Trees are placed at most once per cell, so they don't grow into each other.
+    static constexpr i32 s_TreeCellSize = 8;
+    // Chance of a tree in each cell, per biome.
+    static constexpr auto s_TreeChances = std::to_array<f32>({0.25f, 0.6f, 0.0f});
+    static_assert(s_TreeChances.size() == Biome::_Count);
+    static constexpr u8 s_MinTreeHeight = 4;
+    static constexpr u8 s_MaxTreeHeight = 6;
+
+    // Ruins are placed at most once per region, and only on plains.
+    static constexpr f32 s_RuinChance = 0.3f;
+    static constexpr i32 s_RuinRadius = 3;
+    static constexpr u8 s_MaxRuinHeight = 3;
+
+    // How far any placement reaches from its origin horizontally. Origins are inside their region,
+    // so this keeps placements within the adjacent regions.
+    static constexpr i32 s_MaxPlacementReach = s_RuinRadius;
+    static_assert(s_MaxPlacementReach < FeaturePlacer::RegionBlockSize);
+
+    struct PlacementBounds
+    {
+        ivec3 Lower; // Inclusive, relative to the origin.
+        ivec3 Upper; // Inclusive, relative to the origin.
+    };
+
+    static PlacementBounds GetBounds(Placement const& placement)
+    {
+        switch (+placement.Type)
+        {
+            case PlacementType::Ruin: return {{-s_RuinRadius, -2, -s_RuinRadius}, {s_RuinRadius, placement.Size, s_RuinRadius}};
+            case PlacementType::Tree: return {{-2, -1, -2}, {2, placement.Size, 2}};
+        }
+        ENG_ASSERT(false, "Unknown placement type.");
+        return {};
+    }
+
+    FeaturePlacer::FeaturePlacer(BlockRegistry const& blocks, u64 seed)
+        : m_Seed(SeededRandom::SplitMix64(seed ^ 0xFEA7)) // Differs from other generators with the same seed.
+        , m_Air(blocks.GetBlock("minecraft:air"))
+        , m_Dirt(blocks.GetBlock("minecraft:dirt"))
+        , m_Grass(blocks.GetBlock("minecraft:grass"))
+        , m_Cobblestone(blocks.GetBlock("minecraft:cobblestone"))
+        , m_OakLog(blocks.GetBlock("minecraft:oak_log"))
+        , m_OakLeaves(blocks.GetBlock("minecraft:oak_leaves"))
+    {
+
+    }
+
+    void FeaturePlacer::PlaceRegion(ivec3 regionPos, GetTerrainColumnFunction const& getTerrainColumn, PlacementRegion& region) const
+    {
+        ENG_PROFILE_FUNCTION();
+
+        SeededRandom random{m_Seed ^ (u64(u32(regionPos.x)) << 32) ^ u64(u32(regionPos.z))};
+        random.NextU64(); // Spread the region position through the state before anything is drawn.
+
+        // Returns the surface and biome of a block column, relative to the region's origin.
+        auto getSurface = [&](i32 x, i32 z)
+        {
+            ChunkPos chunkPos{regionPos.x * RegionSize + x / i32(Chunk::Size), 0, regionPos.z * RegionSize + z / i32(Chunk::Size)};
+            auto column = getTerrainColumn(chunkPos);
+            u32 columnIndex = u32(x) % Chunk::Size + Chunk::Size * (u32(z) % Chunk::Size);
+            return std::pair{column->SurfaceHeights[columnIndex], column->Biomes[columnIndex]};
+        };
+
+        // Structures first, so features can keep clear of them.
+        if (random.NextF32() < s_RuinChance)
+        {
+            i32 x = s_RuinRadius + i32(random.NextU32() % u32(RegionBlockSize - 2 * s_RuinRadius));
+            i32 z = s_RuinRadius + i32(random.NextU32() % u32(RegionBlockSize - 2 * s_RuinRadius));
+            u8 height = u8(1 + random.NextU32() % s_MaxRuinHeight);
+            u32 seed = random.NextU32();
+            auto [surfaceHeight, biome] = getSurface(x, z);
+            if (biome == Biome::Plains)
+                region.Structures.push_back({{x, surfaceHeight + 1, z}, PlacementType::Ruin, height, seed});
+        }
+
+        for (i32 cellZ = 0; cellZ < RegionBlockSize; cellZ += s_TreeCellSize)
+        {
+            for (i32 cellX = 0; cellX < RegionBlockSize; cellX += s_TreeCellSize)
+            {
+                // Draw everything up front, so cells that don't get a tree use the same amount of randomness.
+                i32 x = cellX + i32(random.NextU32() % s_TreeCellSize);
+                i32 z = cellZ + i32(random.NextU32() % s_TreeCellSize);
+                f32 chance = random.NextF32();
+                u8 height = u8(s_MinTreeHeight + random.NextU32() % (s_MaxTreeHeight - s_MinTreeHeight + 1));
+                u32 seed = random.NextU32();
+
+                auto [surfaceHeight, biome] = getSurface(x, z);
+                if (chance >= s_TreeChances[biome.Index()])
+                    continue;
+
+                bool inStructure = std::ranges::any_of(region.Structures, [x, z](Placement const& structure)
+                {
+                    return std::abs(structure.Origin.x - x) <= s_RuinRadius + 2 and std::abs(structure.Origin.z - z) <= s_RuinRadius + 2;
+                });
+                if (not inStructure)
+                    region.Features.push_back({{x, surfaceHeight + 1, z}, PlacementType::Tree, height, seed});
+            }
+        }
+    }
+
+    void FeaturePlacer::Place(ChunkPos chunkPos, ivec3 regionPos, std::span<Placement const> placements, Blocks& blocks) const
+    {
+        // The region's origin relative to the chunk's.
+        ivec3 offset = ivec3{regionPos.x * RegionBlockSize, 0, regionPos.z * RegionBlockSize} - chunkPos * i32(Chunk::Size);
+
+        for (Placement const& placement : placements)
+        {
+            // Skip placements whose bounds don't touch the chunk.
+            ivec3 origin = placement.Origin + offset;
+            PlacementBounds bounds = GetBounds(placement);
+            if (glm::any(glm::greaterThanEqual(origin + bounds.Lower, ivec3(Chunk::Size))) or glm::any(glm::lessThan(origin + bounds.Upper, ivec3(0))))
+                continue;
+
+            switch (+placement.Type)
+            {
+                case PlacementType::Ruin: PlaceRuin(origin, placement, blocks); break;
+                case PlacementType::Tree: PlaceTree(origin, placement, blocks); break;
+            }
+        }
+    }
+
+    // Sets the block if it's in the chunk, and if it's air or replace is set.
+    static void SetBlock(FeaturePlacer::Blocks& blocks, BlockID air, ivec3 blockPos, BlockID blockID, bool replace)
+    {
+        if (glm::any(glm::lessThan(blockPos, ivec3(0))) or glm::any(glm::greaterThanEqual(blockPos, ivec3(Chunk::Size))))
+            return;
+        BlockID& block = blocks[Chunk::GetBlockIndex(blockPos)];
+        if (replace or block == air)
+            block = blockID;
+    }
+
+    void FeaturePlacer::PlaceRuin(ivec3 origin, Placement const& placement, Blocks& blocks) const
+    {
+        for (i32 z = -s_RuinRadius; z <= s_RuinRadius; z++)
+        {
+            for (i32 x = -s_RuinRadius; x <= s_RuinRadius; x++)
+            {
+                u32 hash = SeededRandom::Hash(x, 0, z, placement.Seed);
+                bool wall = std::abs(x) == s_RuinRadius or std::abs(z) == s_RuinRadius;
+                if (wall)
+                {
+                    // Walls are buried two blocks deep and crumble to different heights.
+                    i32 height = i32(hash % (placement.Size + 1u));
+                    for (i32 y = -2; y < height; y++)
+                        SetBlock(blocks, m_Air, origin + ivec3{x, y, z}, m_Cobblestone, true);
+                    for (i32 y = height; y <= placement.Size; y++)
+                        SetBlock(blocks, m_Air, origin + ivec3{x, y, z}, m_Air, true);
+                }
+                else
+                {
+                    // A patchy floor, with the terrain inside cleared out.
+                    if (hash % 3 != 0)
+                        SetBlock(blocks, m_Air, origin + ivec3{x, -1, z}, m_Cobblestone, true);
+                    for (i32 y = 0; y <= placement.Size; y++)
+                        SetBlock(blocks, m_Air, origin + ivec3{x, y, z}, m_Air, true);
+                }
+            }
+        }
+    }
+
+    void FeaturePlacer::PlaceTree(ivec3 origin, Placement const& placement, Blocks& blocks) const
+    {
+        i32 height = placement.Size;
+
+        // Grass doesn't grow under the trunk.
+        ivec3 below = origin - ivec3{0, 1, 0};
+        if (glm::all(glm::greaterThanEqual(below, ivec3(0))) and glm::all(glm::lessThan(below, ivec3(Chunk::Size))) and blocks[Chunk::GetBlockIndex(below)] == m_Grass)
+            blocks[Chunk::GetBlockIndex(below)] = m_Dirt;
+
+        // Two wide layers of leaves, then two narrow ones on top, with some corners missing.
+        for (i32 y = height - 3; y <= height; y++)
+        {
+            i32 radius = y < height - 1 ? 2 : 1;
+            for (i32 z = -radius; z <= radius; z++)
+            {
+                for (i32 x = -radius; x <= radius; x++)
+                {
+                    bool corner = std::abs(x) == radius and std::abs(z) == radius;
+                    if (corner and (y == height or SeededRandom::Hash(x, y, z, placement.Seed) % 2 == 0))
+                        continue;
+                    SetBlock(blocks, m_Air, origin + ivec3{x, y, z}, m_OakLeaves, false);
+                }
+            }
+        }
+
+        for (i32 y = 0; y < height; y++)
+            SetBlock(blocks, m_Air, origin + ivec3{0, y, 0}, m_OakLog, true);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "VulkanCraft/World/BlockRegistry.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include "VulkanCraft/World/TerrainNoise.hpp"
+#include <Engine.hpp>
+#include <array>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    ENG_DEFINE_BOUNDED_ENUM(
+        PlacementType, u8,
+
+        Ruin, // Structure: a crumbling ring of cobblestone walls.
+        Tree, // Feature: an oak tree.
+    );
+
+    // Something placed on the surface, which may span several chunks.
+    struct Placement
+    {
+        ivec3 Origin;       // Block position of the base's center, relative to the region's origin.
+        PlacementType Type;
+        u8 Size;            // e.g. a tree's trunk height.
+        u32 Seed;           // Randomizes the details, so every chunk places the same ones.
+    };
+
+    // Everything placed in a region.
+    struct PlacementRegion
+    {
+        std::vector<Placement> Structures;
+        std::vector<Placement> Features;
+    };
+
+    // Seeded placement of structures and features on the surface. Placements are decided a whole region
+    // of chunk columns at a time, from the seed and the region's terrain columns alone, and never reach
+    // further than one region from where they're placed. Each chunk only writes its own blocks of the
+    // placements around it, so they come out whole across chunk borders without the chunk ever needing
+    // its neighbours.
+    class FeaturePlacer
+    {
+    public:
+        static constexpr i32 RegionShift = 2;
+        static constexpr i32 RegionSize = 1 << RegionShift; // In chunks.
+        static constexpr i32 RegionBlockSize = RegionSize * i32(Chunk::Size);
+
+        // Per block in block index order.
+        using Blocks = std::array<BlockID, Chunk::Size3>;
+        using GetTerrainColumnFunction = std::function<std::shared_ptr<TerrainColumn const>(ChunkPos chunkPos)>;
+    public:
+        FeaturePlacer(BlockRegistry const& blocks, u64 seed);
+
+        // Returns the region the chunk is in. Regions are columns, so y is always 0.
+        static ivec3 GetRegionPos(ChunkPos chunkPos) noexcept { return {chunkPos.x >> RegionShift, 0, chunkPos.z >> RegionShift}; }
+
+        void PlaceRegion(ivec3 regionPos, GetTerrainColumnFunction const& getTerrainColumn, PlacementRegion& region) const;
+        // Writes the chunk's blocks of the placements. Only the regions adjacent
+        // to the chunk's region, including itself, can reach into it.
+        void Place(ChunkPos chunkPos, ivec3 regionPos, std::span<Placement const> placements, Blocks& blocks) const;
+    private:
+        void PlaceRuin(ivec3 origin, Placement const& placement, Blocks& blocks) const;
+        void PlaceTree(ivec3 origin, Placement const& placement, Blocks& blocks) const;
+    private:
+        u64 m_Seed;
+        BlockID m_Air;
+        BlockID m_Dirt;
+        BlockID m_Grass;
+        BlockID m_Cobblestone;
+        BlockID m_OakLog;
+        BlockID m_OakLeaves;
+    };
+}
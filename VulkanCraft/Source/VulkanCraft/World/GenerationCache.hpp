@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Engine.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+using namespace eng;
+
+namespace vc
+{
+    // Thread-safe cache of generated data shared between the chunks that use it, e.g. a column of chunks
+    // or a region of them. Values are generated on first use and evicted once they go unused for a while.
+    // Values are immutable and shared by reference, so evicting one that's still in use is always safe;
+    // at worst it's generated again.
+    template <typename KeyT, typename ValueT, typename HashT>
+    class GenerationCache
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(GenerationCache);
+    public:
+        GenerationCache() = default;
+
+        // Returns the value for the key, calling generate(key, value) to generate it if it isn't cached.
+        // Values are generated without the lock, so other keys aren't held up. Generation must be
+        // deterministic: if two threads generate the same key at once, the first one to finish is kept.
+        template <typename GenerateFunction>
+        std::shared_ptr<ValueT const> Get(KeyT key, u64 iteration, GenerateFunction&& generate)
+        {
+            {
+                std::unique_lock lock(m_Mutex);
+                if (auto it = m_Entries.find(key); it != m_Entries.end())
+                {
+                    it->second.LastUsedIteration = iteration;
+                    return it->second.Value;
+                }
+            }
+
+            auto value = std::make_shared<ValueT>();
+            generate(key, *value);
+
+            std::unique_lock lock(m_Mutex);
+            auto [it, inserted] = m_Entries.try_emplace(key, Entry{std::move(value)});
+            it->second.LastUsedIteration = iteration;
+            return it->second.Value;
+        }
+
+        // Evicts every value that's gone unused for more than maxAge iterations, and returns how many are left.
+        u64 EvictCold(u64 iteration, u64 maxAge)
+        {
+            std::unique_lock lock(m_Mutex);
+            std::erase_if(m_Entries, [iteration, maxAge](auto const& entry)
+            {
+                return entry.second.LastUsedIteration + maxAge < iteration;
+            });
+            return m_Entries.size();
+        }
+    private:
+        struct Entry
+        {
+            std::shared_ptr<ValueT const> Value;
+            u64 LastUsedIteration = 0;
+        };
+
+        std::unordered_map<KeyT, Entry, HashT> m_Entries;
+        std::mutex m_Mutex;
+    };
+}
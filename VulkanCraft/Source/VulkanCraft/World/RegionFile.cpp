@@ -0,0 +1,212 @@
+#include "RegionFile.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace vc
+{
+    RegionFile::RegionFile(path const& filepath)
+        : m_Filepath(filepath)
+    {
+
+    }
+
+    RegionFile::~RegionFile()
+    {
+
+    }
+
+    std::unique_ptr<RegionFile> RegionFile::Open(path const& filepath, bool create)
+    {
+        std::error_code error;
+        bool exists = std::filesystem::exists(filepath, error);
+        if (not exists and not create)
+            return nullptr;
+
+        if (not exists)
+        {
+            // Write a header with an empty index.
+            std::vector<u8> header(s_DataSectorOffset * SectorSize);
+            std::memcpy(header.data(), &s_Magic, sizeof(s_Magic));
+            std::memcpy(header.data() + sizeof(s_Magic), &s_Version, sizeof(s_Version));
+            std::filesystem::create_directories(filepath.parent_path(), error);
+            if (not WriteBinaryFile(filepath, header))
+            {
+                ENG_LOG_ERROR("Failed to create region file {}.", filepath.string());
+                return nullptr;
+            }
+        }
+
+        std::unique_ptr<RegionFile> regionFile(new RegionFile(filepath));
+        if (not regionFile->m_Mapping.Open(filepath))
+        {
+            ENG_LOG_ERROR("Failed to map region file {}.", filepath.string());
+            return nullptr;
+        }
+
+        // Check the header.
+        std::span<u8 const> data = regionFile->m_Mapping.GetData();
+        u32 magic = 0;
+        u32 version = 0;
+        if (data.size() >= s_DataSectorOffset * SectorSize)
+        {
+            std::memcpy(&magic, data.data(), sizeof(magic));
+            std::memcpy(&version, data.data() + sizeof(magic), sizeof(version));
+        }
+        if (magic != s_Magic or version != s_Version)
+        {
+            ENG_LOG_WARN("Region file {} has an invalid header or unsupported version {}.", filepath.string(), version);
+            return nullptr;
+        }
+
+        // Read the index and mark which sectors are used.
+        regionFile->m_Index.resize(Size3);
+        std::memcpy(regionFile->m_Index.data(), data.data() + s_IndexSectorOffset * SectorSize, Size3 * sizeof(IndexEntry));
+
+        u32 sectorCount = u32(data.size() / SectorSize);
+        regionFile->m_UsedSectors.assign(sectorCount, false);
+        std::fill_n(regionFile->m_UsedSectors.begin(), s_DataSectorOffset, true);
+        for (IndexEntry& entry : regionFile->m_Index)
+        {
+            if (not entry.SectorOffset)
+                continue;
+
+            u32 entrySectorCount = GetSectorCount(entry.ByteSize);
+            if (entry.SectorOffset < s_DataSectorOffset or u64(entry.SectorOffset) + entrySectorCount > sectorCount)
+            {
+                // Drop entries pointing outside the file, e.g. after a crash mid-write.
+                entry = {};
+                continue;
+            }
+            std::fill_n(regionFile->m_UsedSectors.begin() + entry.SectorOffset, entrySectorCount, true);
+        }
+
+        regionFile->m_File.open(filepath, std::ios::in | std::ios::out | std::ios::binary);
+        if (not regionFile->m_File.is_open())
+        {
+            ENG_LOG_ERROR("Failed to open region file {} for writing.", filepath.string());
+            return nullptr;
+        }
+        return regionFile;
+    }
+
+    bool RegionFile::Contains(uvec3 localChunkPos) const
+    {
+        std::shared_lock lock(m_Mutex);
+        return m_Index[GetIndex(localChunkPos)].SectorOffset != 0;
+    }
+
+    bool RegionFile::Read(uvec3 localChunkPos, std::function<bool(std::span<u8 const> bytes)> const& reader)
+    {
+        u32 index = GetIndex(localChunkPos);
+
+        std::shared_lock lock(m_Mutex);
+        IndexEntry entry = m_Index[index];
+        if (not entry.SectorOffset)
+            return false;
+
+        u64 offset = u64(entry.SectorOffset) * SectorSize;
+        if (offset + entry.ByteSize > m_Mapping.GetData().size())
+        {
+            // The chunk was appended after the file was mapped, so remap it.
+            lock.unlock();
+            {
+                std::unique_lock remapLock(m_Mutex);
+                if (offset + entry.ByteSize > m_Mapping.GetData().size())
+                    m_Mapping.Open(m_Filepath);
+            }
+            lock.lock();
+
+            // The chunk may have been rewritten in between.
+            entry = m_Index[index];
+            offset = u64(entry.SectorOffset) * SectorSize;
+            if (not entry.SectorOffset or offset + entry.ByteSize > m_Mapping.GetData().size())
+                return false;
+        }
+
+        return reader(m_Mapping.GetData().subspan(offset, entry.ByteSize));
+    }
+
+    bool RegionFile::Write(uvec3 localChunkPos, std::span<u8 const> bytes)
+    {
+        ENG_ASSERT(not bytes.empty(), "Chunks must have at least one byte.");
+        u32 index = GetIndex(localChunkPos);
+        u32 sectorCount = GetSectorCount(u32(bytes.size()));
+
+        u32 sectorOffset;
+        {
+            std::unique_lock lock(m_Mutex);
+            sectorOffset = AllocateSectors(sectorCount);
+        }
+
+        // Write the data outside the lock, since nothing points at its sectors yet.
+        // It's padded to whole sectors, so the file always ends on a sector boundary.
+        static constexpr std::array<char, SectorSize> padding{};
+        m_File.seekp(std::streamoff(sectorOffset) * SectorSize);
+        m_File.write(reinterpret_cast<char const*>(bytes.data()), std::streamsize(bytes.size()));
+        m_File.write(padding.data(), std::streamsize(u64(sectorCount) * SectorSize - bytes.size()));
+        m_File.flush();
+
+        std::unique_lock lock(m_Mutex);
+        if (not m_File)
+        {
+            m_File.clear();
+            FreeSectors(sectorOffset, sectorCount);
+            ENG_LOG_ERROR("Failed to write chunk to region file {}.", m_Filepath.string());
+            return false;
+        }
+
+        // Point the index at the new data, then free the old data.
+        IndexEntry previous = m_Index[index];
+        m_Index[index] = {sectorOffset, u32(bytes.size())};
+        bool written = WriteIndexEntry(index);
+        if (previous.SectorOffset)
+            FreeSectors(previous.SectorOffset, GetSectorCount(previous.ByteSize));
+        return written;
+    }
+
+    void RegionFile::Erase(uvec3 localChunkPos)
+    {
+        // Only forget it in memory, since the file is only written by the writing thread.
+        // Its sectors stay used, because the index in the file still points at them.
+        std::unique_lock lock(m_Mutex);
+        m_Index[GetIndex(localChunkPos)] = {};
+    }
+
+    u32 RegionFile::AllocateSectors(u32 count)
+    {
+        // Take the first run of free sectors that fits, or append to the file.
+        u32 runStart = s_DataSectorOffset;
+        for (u32 sector = s_DataSectorOffset; sector < m_UsedSectors.size(); sector++)
+        {
+            if (m_UsedSectors[sector])
+                runStart = sector + 1;
+            else if (sector + 1 - runStart == count)
+                break;
+        }
+
+        if (runStart + count > m_UsedSectors.size())
+            m_UsedSectors.resize(runStart + count, false);
+        std::fill_n(m_UsedSectors.begin() + runStart, count, true);
+        return runStart;
+    }
+
+    void RegionFile::FreeSectors(u32 offset, u32 count)
+    {
+        std::fill_n(m_UsedSectors.begin() + offset, count, false);
+    }
+
+    bool RegionFile::WriteIndexEntry(u32 index)
+    {
+        m_File.seekp(std::streamoff(s_IndexSectorOffset) * SectorSize + std::streamoff(index) * sizeof(IndexEntry));
+        m_File.write(reinterpret_cast<char const*>(&m_Index[index]), sizeof(IndexEntry));
+        m_File.flush();
+        if (not m_File)
+        {
+            m_File.clear();
+            ENG_LOG_ERROR("Failed to write index of region file {}.", m_Filepath.string());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+#include <bit>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    // File storing the chunks of a cubic region of the world.
+    //
+    // Layout, in sectors:
+    //  [0]      Magic and format version.
+    //  [1, 65)  Index of every chunk in the region: where its data starts, in sectors, and how many bytes it has.
+    //  [65, ..) Chunk data, each starting on a sector boundary.
+    //
+    // Chunks are read straight out of a memory mapping of the file. Rewritten chunks go to free
+    // sectors before the index points at them, so readers never see a partially written chunk.
+    // Any number of threads can read, but only one thread at a time may write.
+    class RegionFile
+    {
+        ENG_IMMOVABLE_UNCOPYABLE_CLASS(RegionFile);
+    public:
+        // In chunks.
+        static constexpr u32 Size = 32;
+        static constexpr u32 Size3 = Size * Size * Size;
+        static constexpr u32 SectorSize = 4096;
+
+        static ivec3 GetRegionPos(ChunkPos chunkPos) noexcept { return chunkPos >> std::countr_zero(Size); }
+        static uvec3 GetLocalChunkPos(ChunkPos chunkPos) noexcept { return uvec3(chunkPos & i32(Size - 1)); }
+    public:
+        // Opens a region file, creating it if it doesn't exist and create is set; returns nullptr if it can't be opened.
+        static std::unique_ptr<RegionFile> Open(path const& filepath, bool create);
+        ~RegionFile();
+
+        ENG_NO_DISCARD bool Contains(uvec3 localChunkPos) const;
+
+        // Calls reader with the stored bytes of a chunk, still mapped in the file, and returns what it returns.
+        // Returns false if the chunk isn't stored.
+        bool Read(uvec3 localChunkPos, std::function<bool(std::span<u8 const> bytes)> const& reader);
+
+        // Stores the bytes of a chunk, replacing any previous ones; returns true if they were written, or false if not.
+        bool Write(uvec3 localChunkPos, std::span<u8 const> bytes);
+        // Forgets a stored chunk that couldn't be read, until the region is reopened or the chunk is written again.
+        // Can be called from any thread.
+        void Erase(uvec3 localChunkPos);
+    private:
+        struct IndexEntry
+        {
+            u32 SectorOffset = 0; // 0 if the chunk isn't stored.
+            u32 ByteSize = 0;
+        };
+
+        static constexpr u32 s_Magic = 0x47524356; // "VCRG"
+        static constexpr u32 s_Version = 1;
+        static constexpr u32 s_IndexSectorOffset = 1;
+        static constexpr u32 s_DataSectorOffset = s_IndexSectorOffset + Size3 * sizeof(IndexEntry) / SectorSize;
+
+        static u32 GetIndex(uvec3 localChunkPos) noexcept { return localChunkPos.x + (localChunkPos.y + localChunkPos.z * Size) * Size; }
+        static u32 GetSectorCount(u32 byteSize) noexcept { return (byteSize + SectorSize - 1) / SectorSize; }
+
+        RegionFile(path const& filepath);
+
+        u32 AllocateSectors(u32 count);
+        void FreeSectors(u32 offset, u32 count);
+        bool WriteIndexEntry(u32 index);
+    private:
+        path m_Filepath;
+        std::fstream m_File; // Only used by the writing thread.
+
+        // Guards the index, used sectors and mapping; held shared while reading.
+        mutable std::shared_mutex m_Mutex;
+        std::vector<IndexEntry> m_Index;
+        std::vector<bool> m_UsedSectors;
+        MappedFile m_Mapping;
+    };
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Engine.hpp>
+
+using namespace eng;
+
+namespace vc
+{
+    // Random numbers for world generation, which only depend on the state they start from,
+    // so the same seed always generates the same world whichever thread generates it.
+    struct SeededRandom
+    {
+        u64 State;
+
+        u64 NextU64() noexcept { return State = SplitMix64(State); }
+        u32 NextU32() noexcept { return u32(NextU64() >> 32); }
+        // In [0, 1).
+        f32 NextF32() noexcept { return f32(NextU32() >> 8) * (1.0f / f32(1 << 24)); }
+        // In [-1, 1).
+        f32 NextSigned() noexcept { return NextF32() * 2.0f - 1.0f; }
+
+        static constexpr u64 SplitMix64(u64 x) noexcept
+        {
+            x += 0x9E3779B97F4A7C15;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+            return x ^ (x >> 31);
+        }
+
+        // Well mixed hash of an integer position.
+        static constexpr u32 Hash(i32 x, i32 y, i32 z, u32 seed) noexcept
+        {
+            u32 hash = seed ^ (u32(x) * 0x8DA6B343u) ^ (u32(y) * 0xD8163841u) ^ (u32(z) * 0xCB1AB31Fu);
+            hash ^= hash >> 15;
+            hash *= 0x2C1B3C6Du;
+            hash ^= hash >> 12;
+            hash *= 0x297A2D39u;
+            hash ^= hash >> 15;
+            return hash;
+        }
+    };
+}
@@ -0,0 +1,283 @@
+#include "TerrainNoise.hpp"
+#include "VulkanCraft/World/SeededRandom.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vc
+{
+    // Shape of the terrain, in blocks.
+    static constexpr f32 s_BaseHeight = 32.0f;
+    static constexpr f32 s_HeightAmplitude = 48.0f;
+    static constexpr f32 s_DetailAmplitude = 12.0f;
+    // Bounds how far the detail octaves can move the surface from the height, with room to spare.
+    static constexpr f32 s_MaxDetail = 2.0f * s_DetailAmplitude;
+    // Surfaces above this are bare mountains, and biome noise above the threshold is hills.
+    static constexpr i32 s_MountainHeight = 72;
+    static constexpr f32 s_HillsThreshold = 0.15f;
+    // Log2 of the first octave's period in blocks; each later octave halves the period and the amplitude.
+    static constexpr u32 s_HeightPeriodShift = 8;
+    static constexpr u32 s_DetailPeriodShift = 6;
+    static constexpr u32 s_BiomePeriodShift = 9;
+    static constexpr u32 s_CavePeriodShift = 5;
+    // Cave noise above this is carved; higher makes fewer, smaller caves.
+    static constexpr f32 s_CaveThreshold = 0.3f;
+
+    static constexpr u32 s_ColumnCount = u32(TerrainNoise::LatticeSize * TerrainNoise::LatticeSize);
+    static constexpr u32 s_PointCount = s_ColumnCount * u32(TerrainNoise::LatticeSize);
+    static constexpr u32 s_ColumnBatchCount = std::tuple_size_v<TerrainNoise::LatticeHeights> / TerrainNoise::LaneCount;
+    static constexpr u32 s_PointBatchCount = (s_PointCount + TerrainNoise::LaneCount - 1) / TerrainNoise::LaneCount;
+
+    using Lanes = std::array<f32, TerrainNoise::LaneCount>;
+    using IntLanes = std::array<i32, TerrainNoise::LaneCount>;
+    // Values of the lattice's points, indexed x + LatticeSize * (y + LatticeSize * z).
+    using Lattice = std::array<f32, s_PointBatchCount * TerrainNoise::LaneCount>;
+
+    // Dot product of the corner's pseudo-random gradient, with components in [-1, 1), and the offset from the corner.
+    static f32 Gradient(u32 hash, f32 x, f32 y, f32 z)
+    {
+        f32 gx = f32(i32(hash & 1023) - 512) * (1.0f / 512.0f);
+        f32 gy = f32(i32((hash >> 10) & 1023) - 512) * (1.0f / 512.0f);
+        f32 gz = f32(i32((hash >> 20) & 1023) - 512) * (1.0f / 512.0f);
+        return gx * x + gy * y + gz * z;
+    }
+
+    static f32 Fade(f32 t)
+    {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+
+    static f32 Lerp(f32 a, f32 b, f32 t)
+    {
+        return a + (b - a) * t;
+    }
+
+    // Adds an octave of gradient noise at each lane's block position; 2d noise uses y = 0.
+    // Positions are split into the integer noise cell and the exact position within it, so
+    // precision doesn't drop far from the origin.
+    static void AddNoise(IntLanes const& x, IntLanes const& y, IntLanes const& z, u32 periodShift, u32 seed, f32 amplitude, Lanes& values)
+    {
+        i32 mask = (1 << periodShift) - 1;
+        f32 scale = 1.0f / f32(1 << periodShift);
+        for (u32 lane = 0; lane < TerrainNoise::LaneCount; lane++)
+        {
+            i32 cx = x[lane] >> periodShift, cy = y[lane] >> periodShift, cz = z[lane] >> periodShift;
+            f32 fx = f32(x[lane] & mask) * scale, fy = f32(y[lane] & mask) * scale, fz = f32(z[lane] & mask) * scale;
+
+            f32 n000 = Gradient(SeededRandom::Hash(cx + 0, cy + 0, cz + 0, seed), fx - 0.0f, fy - 0.0f, fz - 0.0f);
+            f32 n100 = Gradient(SeededRandom::Hash(cx + 1, cy + 0, cz + 0, seed), fx - 1.0f, fy - 0.0f, fz - 0.0f);
+            f32 n010 = Gradient(SeededRandom::Hash(cx + 0, cy + 1, cz + 0, seed), fx - 0.0f, fy - 1.0f, fz - 0.0f);
+            f32 n110 = Gradient(SeededRandom::Hash(cx + 1, cy + 1, cz + 0, seed), fx - 1.0f, fy - 1.0f, fz - 0.0f);
+            f32 n001 = Gradient(SeededRandom::Hash(cx + 0, cy + 0, cz + 1, seed), fx - 0.0f, fy - 0.0f, fz - 1.0f);
+            f32 n101 = Gradient(SeededRandom::Hash(cx + 1, cy + 0, cz + 1, seed), fx - 1.0f, fy - 0.0f, fz - 1.0f);
+            f32 n011 = Gradient(SeededRandom::Hash(cx + 0, cy + 1, cz + 1, seed), fx - 0.0f, fy - 1.0f, fz - 1.0f);
+            f32 n111 = Gradient(SeededRandom::Hash(cx + 1, cy + 1, cz + 1, seed), fx - 1.0f, fy - 1.0f, fz - 1.0f);
+
+            f32 u = Fade(fx), v = Fade(fy), w = Fade(fz);
+            f32 n00 = Lerp(n000, n100, u), n10 = Lerp(n010, n110, u);
+            f32 n01 = Lerp(n001, n101, u), n11 = Lerp(n011, n111, u);
+            values[lane] += amplitude * Lerp(Lerp(n00, n10, v), Lerp(n01, n11, v), w);
+        }
+    }
+
+    // Trilinearly interpolates the lattice to every block, a row of x at a time.
+    static void InterpolateLattice(Lattice const& lattice, TerrainNoise::Densities& densities)
+    {
+        constexpr i32 LatticeSpacing = TerrainNoise::LatticeSpacing;
+        constexpr i32 LatticeSize = TerrainNoise::LatticeSize;
+        constexpr f32 scale = 1.0f / f32(LatticeSpacing);
+        for (u32 z = 0; z < Chunk::Size; z++)
+        {
+            u32 pz = z / LatticeSpacing;
+            f32 tz = f32(z % LatticeSpacing) * scale;
+            for (u32 y = 0; y < Chunk::Size; y++)
+            {
+                u32 py = y / LatticeSpacing;
+                f32 ty = f32(y % LatticeSpacing) * scale;
+
+                // Lattice values along the row's x, interpolated in y and z.
+                std::array<f32, LatticeSize> row;
+                for (u32 px = 0; px < u32(LatticeSize); px++)
+                {
+                    auto at = [&](u32 dy, u32 dz) { return lattice[px + LatticeSize * ((py + dy) + LatticeSize * (pz + dz))]; };
+                    row[px] = Lerp(Lerp(at(0, 0), at(1, 0), ty), Lerp(at(0, 1), at(1, 1), ty), tz);
+                }
+
+                for (u32 x = 0; x < Chunk::Size; x++)
+                    densities[Chunk::GetBlockIndex({x, y, z})] = Lerp(row[x / LatticeSpacing], row[x / LatticeSpacing + 1], f32(x % LatticeSpacing) * scale);
+            }
+        }
+    }
+
+    TerrainNoise::TerrainNoise(u64 seed)
+        : m_Seed(seed)
+    {
+        u64 state = seed;
+        for (u32& heightSeed : m_HeightSeeds)
+            heightSeed = u32(state = SeededRandom::SplitMix64(state));
+        for (u32& detailSeed : m_DetailSeeds)
+            detailSeed = u32(state = SeededRandom::SplitMix64(state));
+        for (u32& biomeSeed : m_BiomeSeeds)
+            biomeSeed = u32(state = SeededRandom::SplitMix64(state));
+        for (u32& caveSeed : m_CaveSeeds)
+            caveSeed = u32(state = SeededRandom::SplitMix64(state));
+    }
+
+    void TerrainNoise::GenerateColumn(ChunkPos chunkPos, TerrainColumn& column) const
+    {
+        ENG_PROFILE_FUNCTION();
+
+        ivec3 origin = chunkPos * i32(Chunk::Size);
+        GenerateLatticeHeights(chunkPos, column.LatticeHeights);
+
+        // Nothing is solid more than s_MaxDetail above the highest height, so scan down from
+        // there a chunk at a time until every block column has found its highest solid block.
+        // The densities are the stone map's, so the surface always matches it exactly.
+        f32 maxHeight = *std::ranges::max_element(column.LatticeHeights);
+        i32 chunkY = i32(std::floor((maxHeight + s_MaxDetail) / f32(Chunk::Size)));
+        column.SurfaceHeights.fill(std::numeric_limits<i32>::min());
+        u32 remainingCount = Chunk::Size2;
+        Densities densities;
+        for (; remainingCount > 0; chunkY--)
+        {
+            GenerateDensities({chunkPos.x, chunkY, chunkPos.z}, column.LatticeHeights, densities);
+            for (u32 i = 0; i < Chunk::Size2; i++)
+            {
+                if (column.SurfaceHeights[i] != std::numeric_limits<i32>::min())
+                    continue;
+                for (u32 y = Chunk::Size; y-- > 0;)
+                {
+                    if (densities[Chunk::GetBlockIndex({i % Chunk::Size, y, i / Chunk::Size})] > 0.0f)
+                    {
+                        column.SurfaceHeights[i] = chunkY * i32(Chunk::Size) + i32(y);
+                        remainingCount--;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Biomes, from low frequency noise and the surface height.
+        for (u32 batch = 0; batch < Chunk::Size2 / LaneCount; batch++)
+        {
+            IntLanes x, y{}, z;
+            for (u32 lane = 0; lane < LaneCount; lane++)
+            {
+                u32 i = batch * LaneCount + lane;
+                x[lane] = origin.x + i32(i % Chunk::Size);
+                z[lane] = origin.z + i32(i / Chunk::Size);
+            }
+
+            Lanes values{};
+            f32 amplitude = 1.0f;
+            for (u32 octave = 0; octave < BiomeOctaveCount; octave++, amplitude *= 0.5f)
+                AddNoise(x, y, z, s_BiomePeriodShift - octave, m_BiomeSeeds[octave], amplitude, values);
+
+            for (u32 lane = 0; lane < LaneCount; lane++)
+            {
+                u32 i = batch * LaneCount + lane;
+                if (column.SurfaceHeights[i] > s_MountainHeight)
+                    column.Biomes[i] = Biome::Mountains;
+                else if (values[lane] > s_HillsThreshold)
+                    column.Biomes[i] = Biome::Hills;
+                else
+                    column.Biomes[i] = Biome::Plains;
+            }
+        }
+    }
+
+    void TerrainNoise::GenerateDensities(ChunkPos chunkPos, Densities& densities) const
+    {
+        LatticeHeights latticeHeights;
+        GenerateLatticeHeights(chunkPos, latticeHeights);
+        GenerateDensities(chunkPos, latticeHeights, densities);
+    }
+
+    void TerrainNoise::GenerateLatticeHeights(ChunkPos chunkPos, LatticeHeights& heights) const
+    {
+        ivec3 origin = chunkPos * i32(Chunk::Size);
+
+        // Padding lanes past the end repeat earlier columns and are ignored.
+        for (u32 batch = 0; batch < s_ColumnBatchCount; batch++)
+        {
+            IntLanes x, y{}, z;
+            for (u32 lane = 0; lane < LaneCount; lane++)
+            {
+                u32 column = (batch * LaneCount + lane) % s_ColumnCount;
+                x[lane] = origin.x + i32(column) % LatticeSize * LatticeSpacing;
+                z[lane] = origin.z + i32(column) / LatticeSize * LatticeSpacing;
+            }
+
+            Lanes values{};
+            f32 amplitude = s_HeightAmplitude;
+            for (u32 octave = 0; octave < HeightOctaveCount; octave++, amplitude *= 0.5f)
+                AddNoise(x, y, z, s_HeightPeriodShift - octave, m_HeightSeeds[octave], amplitude, values);
+
+            for (u32 lane = 0; lane < LaneCount; lane++)
+                heights[batch * LaneCount + lane] = s_BaseHeight + values[lane];
+        }
+    }
+
+    void TerrainNoise::GenerateDensities(ChunkPos chunkPos, LatticeHeights const& heights, Densities& densities) const
+    {
+        ENG_PROFILE_FUNCTION();
+
+        ivec3 origin = chunkPos * i32(Chunk::Size);
+
+        Lattice lattice;
+        for (u32 batch = 0; batch < s_PointBatchCount; batch++)
+        {
+            IntLanes x, y, z;
+            Lanes values;
+            for (u32 lane = 0; lane < LaneCount; lane++)
+            {
+                u32 point = (batch * LaneCount + lane) % s_PointCount;
+                i32 px = i32(point) % LatticeSize, py = i32(point) / LatticeSize % LatticeSize, pz = i32(point) / (LatticeSize * LatticeSize);
+                x[lane] = origin.x + px * LatticeSpacing;
+                y[lane] = origin.y + py * LatticeSpacing;
+                z[lane] = origin.z + pz * LatticeSpacing;
+                values[lane] = heights[px + LatticeSize * pz] - f32(y[lane]);
+            }
+
+            f32 amplitude = s_DetailAmplitude;
+            for (u32 octave = 0; octave < DetailOctaveCount; octave++, amplitude *= 0.5f)
+                AddNoise(x, y, z, s_DetailPeriodShift - octave, m_DetailSeeds[octave], amplitude, values);
+
+            for (u32 lane = 0; lane < LaneCount; lane++)
+                lattice[batch * LaneCount + lane] = values[lane];
+        }
+
+        InterpolateLattice(lattice, densities);
+    }
+
+    void TerrainNoise::GenerateCaveDensities(ChunkPos chunkPos, Densities& caveDensities) const
+    {
+        ENG_PROFILE_FUNCTION();
+
+        ivec3 origin = chunkPos * i32(Chunk::Size);
+
+        Lattice lattice;
+        for (u32 batch = 0; batch < s_PointBatchCount; batch++)
+        {
+            IntLanes x, y, z;
+            for (u32 lane = 0; lane < LaneCount; lane++)
+            {
+                u32 point = (batch * LaneCount + lane) % s_PointCount;
+                x[lane] = origin.x + i32(point) % LatticeSize * LatticeSpacing;
+                y[lane] = origin.y + i32(point) / LatticeSize % LatticeSize * LatticeSpacing;
+                z[lane] = origin.z + i32(point) / (LatticeSize * LatticeSize) * LatticeSpacing;
+            }
+
+            Lanes values;
+            values.fill(-s_CaveThreshold);
+            f32 amplitude = 1.0f;
+            for (u32 octave = 0; octave < CaveOctaveCount; octave++, amplitude *= 0.5f)
+                AddNoise(x, y, z, s_CavePeriodShift - octave, m_CaveSeeds[octave], amplitude, values);
+
+            for (u32 lane = 0; lane < LaneCount; lane++)
+                lattice[batch * LaneCount + lane] = values[lane];
+        }
+
+        InterpolateLattice(lattice, caveDensities);
+    }
+}
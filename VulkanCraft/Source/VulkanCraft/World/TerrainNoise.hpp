@@ -0,0 +1,69 @@
+#pragma once
+
+#include "VulkanCraft/World/Biome.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkPos.hpp"
+#include <Engine.hpp>
+#include <array>
+
+using namespace eng;
+
+namespace vc
+{
+    struct TerrainColumn;
+
+    // Seeded density field of the terrain: rolling hills from 2d gradient noise, roughened by 3d
+    // gradient noise into overhangs. Noise is only sampled on a coarse lattice, in batches of
+    // LaneCount samples, and trilinearly interpolated to every block.
+    //
+    // Densities are computed from the seed and integer block positions alone, and every sample goes
+    // through the same fixed-width loop, so a chunk is bit-identical whichever thread generates it.
+    // Everything that only depends on x and z is generated once per column of chunks, see TerrainColumn.
+    class TerrainNoise
+    {
+    public:
+        static constexpr i32 LatticeSpacing = 4;
+        static constexpr i32 LatticeSize = i32(Chunk::Size) / LatticeSpacing + 1;
+        // Samples per batch; the batch loops have no remainder and no branches so they vectorize.
+        static constexpr u32 LaneCount = 8;
+
+        static constexpr u32 HeightOctaveCount = 4;
+        static constexpr u32 DetailOctaveCount = 3;
+        static constexpr u32 BiomeOctaveCount = 2;
+        static constexpr u32 CaveOctaveCount = 2;
+
+        // Per block in block index order; positive is solid.
+        using Densities = std::array<f32, Chunk::Size3>;
+        // Heights of the lattice's columns, indexed x + LatticeSize * z, padded to whole batches.
+        using LatticeHeights = std::array<f32, (LatticeSize * LatticeSize + LaneCount - 1) / LaneCount * LaneCount>;
+    public:
+        TerrainNoise(u64 seed);
+
+        // Only x and z of the chunk position are used.
+        void GenerateColumn(ChunkPos chunkPos, TerrainColumn& column) const;
+        void GenerateDensities(ChunkPos chunkPos, LatticeHeights const& latticeHeights, Densities& densities) const;
+        // Generates the lattice heights as well, so prefer the other overload when the column is shared.
+        void GenerateDensities(ChunkPos chunkPos, Densities& densities) const;
+        // Densities of noise caves, from 3d gradient noise; positive is carved.
+        void GenerateCaveDensities(ChunkPos chunkPos, Densities& caveDensities) const;
+
+        u64 GetSeed() const noexcept { return m_Seed; }
+    private:
+        void GenerateLatticeHeights(ChunkPos chunkPos, LatticeHeights& latticeHeights) const;
+    private:
+        u64 m_Seed;
+        std::array<u32, HeightOctaveCount> m_HeightSeeds;
+        std::array<u32, DetailOctaveCount> m_DetailSeeds;
+        std::array<u32, BiomeOctaveCount> m_BiomeSeeds;
+        std::array<u32, CaveOctaveCount> m_CaveSeeds;
+    };
+
+    // Terrain shared by every chunk in a column, generated once per column.
+    struct TerrainColumn
+    {
+        TerrainNoise::LatticeHeights LatticeHeights;
+        // Per block column, indexed x + Chunk::Size * z.
+        std::array<i32, Chunk::Size2> SurfaceHeights; // Y of the highest solid block.
+        std::array<Biome, Chunk::Size2> Biomes;
+    };
+}
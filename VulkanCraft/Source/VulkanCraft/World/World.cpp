@@ -1,54 +1,224 @@
 #include "World.hpp"
 #include "VulkanCraft/Rendering/BlockModel.hpp"
+#include <algorithm>
+#include <bit>
+#include <iterator>
 
 namespace vc
 {
-    World::World(BlockRegistry const& blocks)
+    World::World(BlockRegistry const& blocks, u32 horizontalRenderDistance, u32 verticalRenderDistance, ChunkStorage* chunkStorage)
         : m_Blocks(blocks)
+        , m_ChunkStorage(chunkStorage)
+        , m_Chunks(horizontalRenderDistance + ChunkStreamer::UnloadMargin, verticalRenderDistance + ChunkStreamer::UnloadMargin)
+        , m_ChunkStreamer(horizontalRenderDistance, verticalRenderDistance)
     {
 
     }
 
-    void World::OnUpdate(Timestep timestep, ChunkGenerator& chunkGenerator)
+    void World::OnUpdate(Timestep timestep, ChunkGenerator& chunkGenerator, vec3 cameraPosition)
     {
-        if (static bool loaded = false; not loaded)
+        ENG_PROFILE_ZONE("World::OnUpdate");
+
+        ApplyBlockEdits(chunkGenerator);
+
+        // Stream chunks around the camera.
+        ChunkPos cameraChunkPos = glm::floor(cameraPosition / f32(Chunk::Size));
+        if (m_ChunkStreamer.Update(cameraChunkPos, m_ChunkLoads, m_ChunkUnloads))
         {
-            loaded = true;
-            std::vector<ChunkPos> chunksToLoad;
-            chunksToLoad.reserve(16 * 16 * 16);
-            for (i32 z = -8; z < 8; z++)
-                for (i32 y = -8; y < 8; y++)
-                    for (i32 x = -8; x < 8; x++)
-                        chunksToLoad.emplace_back(x, y, z);
-            chunkGenerator.QueueChunkLoads(chunksToLoad);
+            for (ChunkPos chunkPos : m_ChunkUnloads)
+            {
+                if (m_Chunks.Erase(chunkPos))
+                    PublishChunkEvent(ChunkEventType::Removed, chunkPos);
+                m_MeshVersions.erase(chunkPos);
+            }
+
+            if (not m_ChunkUnloads.empty())
+                chunkGenerator.QueueChunkUnloads(m_ChunkUnloads);
+            if (not m_ChunkLoads.empty())
+                chunkGenerator.QueueChunkLoads(m_ChunkLoads);
+            m_ChunkLoads.clear();
+            m_ChunkUnloads.clear();
         }
 
         chunkGenerator.ConsumeGeneratedChunks([this](std::shared_ptr<Chunk>&& chunk)
         {
-            m_Chunks[chunk->GetPosition()] = std::move(chunk);
+            // Chunks that finish generating after being unloaded are dropped. A chunk reloaded
+            // quickly can arrive twice, from its first load and from the generator's cache, and the
+            // copy already loaded may have been edited since, so it's kept.
+            ChunkPos chunkPos = chunk->GetPosition();
+            if (m_ChunkStreamer.IsLoaded(chunkPos) and not m_Chunks.Contains(chunkPos))
+            {
+                m_Chunks.Insert(std::move(chunk));
+                PublishChunkEvent(ChunkEventType::Added, chunkPos);
+            }
         });
 
-        // TODO DEBUG TESTING:
-        // removes a chunk every second.
-        static float s_TotalTime = 0.0f;
-        s_TotalTime += timestep;
-        if (s_TotalTime >= 1.0f)
+        // A chunk is always queued before its mesh, but it can be queued after the chunks were
+        // consumed and before the meshes are, so meshes for loaded chunks wait for them.
+        // Meshes for chunks that are no longer loaded are stale and dropped.
+        auto publishMesh = [this](ChunkMeshData&& mesh)
+        {
+            // Drop meshes made before the latest edit of their chunk, or older than the one shown,
+            // e.g. a late generated mesh arriving after a remesh.
+            if (auto it = m_MeshVersions.find(mesh.ChunkPos); it != m_MeshVersions.end() and mesh.Version < it->second)
+                return;
+
+            if (m_Chunks.Contains(mesh.ChunkPos))
+            {
+                m_MeshVersions[mesh.ChunkPos] = mesh.Version;
+                PublishChunkEvent(ChunkEventType::Remeshed, mesh.ChunkPos, std::move(mesh));
+            }
+            else if (m_ChunkStreamer.IsLoaded(mesh.ChunkPos))
+                m_EarlyChunkMeshes.push_back(std::move(mesh));
+        };
+        for (auto& mesh : std::exchange(m_EarlyChunkMeshes, {}))
+            publishMesh(std::move(mesh));
+        chunkGenerator.ConsumeGeneratedChunkMeshes(publishMesh);
+
+        if (not m_PublishedChunkEvents.empty())
+        {
+            std::unique_lock lock(m_ChunkEventMutex);
+            if (m_ChunkEvents.empty())
+                std::swap(m_ChunkEvents, m_PublishedChunkEvents);
+            else
+                std::ranges::move(m_PublishedChunkEvents, std::back_inserter(m_ChunkEvents));
+        }
+        m_PublishedChunkEvents.clear();
+    }
+
+    void World::SetBlock(ivec3 blockPos, BlockID blockID)
+    {
+        std::unique_lock lock(m_BlockEditMutex);
+        m_QueuedBlockEdits.emplace_back(blockPos, blockID);
+    }
+
+    void World::ApplyBlockEdits(ChunkGenerator& chunkGenerator)
+    {
+        m_BlockEdits.clear();
+        {
+            std::unique_lock lock(m_BlockEditMutex);
+            std::swap(m_BlockEdits, m_QueuedBlockEdits);
+        }
+        if (m_BlockEdits.empty())
+            return;
+
+        ENG_PROFILE_ZONE("World::ApplyBlockEdits");
+
+        // Chunks are shared with the workers meshing them, so edited chunks are copied once
+        // and swapped in after all their edits are applied.
+        for (auto& edit : m_BlockEdits)
         {
-            s_TotalTime -= 1.0f;
-            if (not m_Chunks.empty())
+            ChunkPos chunkPos = edit.BlockPos >> i32(std::countr_zero(Chunk::Size));
+            uvec3 localBlockPos = edit.BlockPos & i32(Chunk::Size - 1);
+
+            auto& editedChunk = m_EditedChunks[chunkPos];
+            if (not editedChunk)
+            {
+                Chunk* chunk = m_Chunks.Get(chunkPos);
+                if (not chunk)
+                {
+                    m_EditedChunks.erase(chunkPos);
+                    continue;
+                }
+                editedChunk = std::make_shared<Chunk>(m_Blocks, BlockStateRegistry{chunk->GetBlockStates()}, chunkPos);
+            }
+            editedChunk->SetBlock(localBlockPos, edit.BlockID);
+
+            // Blocks on a chunk's boundary are also part of its neighbours' meshes.
+            m_DirtyChunks.insert(chunkPos);
+            for (i32 axis = 0; axis < 3; axis++)
             {
-                auto it = m_Chunks.begin();
-                ChunkPos chunkPos = it->second->GetPosition();
-                m_Chunks.erase(it);
-                chunkGenerator.QueueChunkUnloads(std::span{&chunkPos, 1});
+                ivec3 direction{};
+                direction[axis] = 1;
+                if (localBlockPos[axis] == 0)
+                    m_DirtyChunks.insert(chunkPos - direction);
+                if (localBlockPos[axis] == Chunk::Size - 1)
+                    m_DirtyChunks.insert(chunkPos + direction);
             }
         }
+
+        for (auto& [chunkPos, editedChunk] : m_EditedChunks)
+        {
+            if (m_ChunkStorage)
+                m_ChunkStorage->SaveChunk(editedChunk);
+            m_ChunkEdits.push_back(editedChunk);
+            m_Chunks.Insert(std::move(editedChunk));
+        }
+        m_EditedChunks.clear();
+
+        // Remesh the dirty chunks against the edited data. The old meshes stay visible until
+        // the new ones are uploaded.
+        static constexpr auto s_NeighbourOffsets = std::to_array<ivec3>({
+            {-1, 0, 0}, {+1, 0, 0}, {0, -1, 0}, {0, +1, 0}, {0, 0, -1}, {0, 0, +1},
+        });
+        for (ChunkPos chunkPos : m_DirtyChunks)
+        {
+            auto chunk = m_Chunks.GetShared(chunkPos);
+            if (not chunk)
+                continue;
+
+            auto& remesh = m_ChunkRemeshes.emplace_back();
+            remesh.Chunk = std::move(chunk);
+            for (u64 face = 0; face < s_NeighbourOffsets.size(); face++)
+                remesh.Neighbours[face] = m_Chunks.GetShared(chunkPos + s_NeighbourOffsets[face]);
+            remesh.Version = m_NextRemeshVersion++;
+            m_MeshVersions[chunkPos] = remesh.Version;
+        }
+        m_DirtyChunks.clear();
+
+        // The generator's cached copies of the edited chunks are what it meshes neighbours against.
+        if (not m_ChunkEdits.empty())
+            chunkGenerator.QueueChunkEdits(m_ChunkEdits);
+        m_ChunkEdits.clear();
+
+        if (not m_ChunkRemeshes.empty())
+            chunkGenerator.QueueChunkRemeshes(m_ChunkRemeshes);
+        m_ChunkRemeshes.clear();
+    }
+
+    void World::TakeChunkEvents(std::vector<ChunkEvent>& events)
+    {
+        events.clear();
+        std::unique_lock lock(m_ChunkEventMutex);
+        std::swap(events, m_ChunkEvents);
+    }
+
+    void World::PublishChunkEvent(ChunkEventType type, ChunkPos chunkPos, ChunkMeshData&& mesh)
+    {
+        m_PublishedChunkEvents.emplace_back(type, chunkPos, m_NextChunkEventSequence++, std::move(mesh));
+    }
+
+    BlockID World::GetBlock(ivec3 blockPos) const
+    {
+        return BlockQuery::GetBlock([this](ChunkPos chunkPos) { return GetChunk(chunkPos); }, blockPos);
+    }
+
+    std::optional<RaycastHit> World::Raycast(vec3 origin, vec3 direction, f32 maxDistance) const
+    {
+        ENG_PROFILE_FUNCTION();
+
+        return BlockQuery::Raycast([this](ChunkPos chunkPos) { return GetChunk(chunkPos); }, origin, direction, maxDistance,
+            [this](BlockID blockID) { return m_Blocks.HasComponent<BlockModel>(blockID); });
+    }
+
+    WorldSnapshot World::CreateSnapshot(ivec3 minBlockPos, ivec3 maxBlockPos) const
+    {
+        ENG_PROFILE_FUNCTION();
+
+        WorldSnapshot snapshot;
+        snapshot.m_MinChunkPos = BlockQuery::GetChunkPos(minBlockPos);
+        snapshot.m_Size = BlockQuery::GetChunkPos(maxBlockPos) - snapshot.m_MinChunkPos + 1;
+        snapshot.m_Chunks.reserve(snapshot.m_Size.x * snapshot.m_Size.y * snapshot.m_Size.z);
+        for (i32 z = 0; z < snapshot.m_Size.z; z++)
+            for (i32 y = 0; y < snapshot.m_Size.y; y++)
+                for (i32 x = 0; x < snapshot.m_Size.x; x++)
+                    snapshot.m_Chunks.push_back(m_Chunks.GetShared(snapshot.m_MinChunkPos + ivec3{x, y, z}));
+        return snapshot;
     }
 
-    Chunk* World::GetChunk(ChunkPos chunkPos)
+    void World::SetRenderDistance(u32 horizontalRenderDistance, u32 verticalRenderDistance)
     {
-        if (auto it = m_Chunks.find(chunkPos); it != m_Chunks.end())
-            return it->second.get();
-        return nullptr;
+        m_ChunkStreamer.SetRenderDistance(horizontalRenderDistance, verticalRenderDistance);
+        m_Chunks.Resize(horizontalRenderDistance + ChunkStreamer::UnloadMargin, verticalRenderDistance + ChunkStreamer::UnloadMargin);
     }
 }
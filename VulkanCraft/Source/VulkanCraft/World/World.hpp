@@ -1,10 +1,20 @@
 #pragma once
 
+#include "VulkanCraft/World/BlockQuery.hpp"
 #include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkEvent.hpp"
 #include "VulkanCraft/World/ChunkGenerator.hpp"
+#include "VulkanCraft/World/ChunkGrid.hpp"
+#include "VulkanCraft/World/ChunkStorage.hpp"
+#include "VulkanCraft/World/ChunkStreamer.hpp"
+#include "VulkanCraft/World/WorldSnapshot.hpp"
 #include <Engine.hpp>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 using namespace eng;
 
@@ -14,14 +24,86 @@ namespace vc
     {
         ENG_IMMOVABLE_UNCOPYABLE_CLASS(World);
     public:
-        World(BlockRegistry const& blocks);
+        // Edited chunks are saved to the given storage.
+        World(BlockRegistry const& blocks, u32 horizontalRenderDistance, u32 verticalRenderDistance, ChunkStorage* chunkStorage = nullptr);
 
-        void OnUpdate(Timestep timestep, ChunkGenerator& chunkGenerator);
+        // Streams chunks in and out around the camera as it crosses chunk boundaries.
+        void OnUpdate(Timestep timestep, ChunkGenerator& chunkGenerator, vec3 cameraPosition);
 
-        Chunk* GetChunk(ChunkPos chunkPos);
+        // Render distances are in chunks.
+        void SetRenderDistance(u32 horizontalRenderDistance, u32 verticalRenderDistance);
+
+        // Queues a block to be set at the given world position, in blocks. Edits are applied
+        // together at the start of the next update, and edits to unloaded chunks are ignored.
+        // Can be called from any thread.
+        void SetBlock(ivec3 blockPos, BlockID blockID);
+
+        // Swaps out every chunk event published since the last call, oldest first.
+        // The given vector is cleared and swapped in, so its allocation gets reused.
+        // Can be called from any thread.
+        void TakeChunkEvents(std::vector<ChunkEvent>& events);
+
+        // Returns the chunk at the given position, or nullptr if it isn't loaded.
+        Chunk* GetChunk(ChunkPos chunkPos) const noexcept { return m_Chunks.Get(chunkPos); }
+
+        // Block queries at world positions, in blocks, over the loaded chunks.
+        // Only to be used from the thread updating the world; use a snapshot from other threads.
+
+        // Returns the block at the given position, or void if its chunk isn't loaded.
+        ENG_NO_DISCARD BlockID GetBlock(ivec3 blockPos) const;
+        // Returns the first block with a model along the ray, if any within maxDistance.
+        ENG_NO_DISCARD std::optional<RaycastHit> Raycast(vec3 origin, vec3 direction, f32 maxDistance) const;
+        // Calls callback(ivec3 blockPos, BlockID) for every loaded block in the inclusive box.
+        template <typename Callback>
+        void ForEachBlock(ivec3 minBlockPos, ivec3 maxBlockPos, Callback const& callback) const
+        {
+            BlockQuery::ForEachBlock([this](ChunkPos chunkPos) { return GetChunk(chunkPos); }, minBlockPos, maxBlockPos, callback);
+        }
+
+        // Returns a snapshot of the loaded chunks overlapping the inclusive box, to be queried from other threads.
+        // Block edits made after taking it aren't visible in it.
+        ENG_NO_DISCARD WorldSnapshot CreateSnapshot(ivec3 minBlockPos, ivec3 maxBlockPos) const;
+    private:
+        struct BlockEdit
+        {
+            ivec3 BlockPos;
+            BlockID BlockID;
+        };
+    private:
+        void ApplyBlockEdits(ChunkGenerator& chunkGenerator);
+        void PublishChunkEvent(ChunkEventType type, ChunkPos chunkPos, ChunkMeshData&& mesh = {});
     private:
-        friend class WorldRenderer;
         BlockRegistry const& m_Blocks; // non-owning
-        std::unordered_map<ChunkPos, std::shared_ptr<Chunk>, ChunkPosHash> m_Chunks;
+        ChunkStorage* m_ChunkStorage;  // non-owning
+        ChunkGrid m_Chunks;
+
+        ChunkStreamer m_ChunkStreamer;
+        // Reused between updates to avoid reallocating.
+        std::vector<ChunkPos> m_ChunkLoads;
+        std::vector<ChunkPos> m_ChunkUnloads;
+
+        // Block edits waiting for the next update.
+        std::vector<BlockEdit> m_QueuedBlockEdits;
+        std::mutex m_BlockEditMutex;
+        // Reused between updates to avoid reallocating.
+        std::vector<BlockEdit> m_BlockEdits;
+        std::unordered_map<ChunkPos, std::shared_ptr<Chunk>, ChunkPosHash> m_EditedChunks;
+        std::unordered_set<ChunkPos, ChunkPosHash> m_DirtyChunks;
+        std::vector<ChunkGenerator::QueuedChunkRemeshData> m_ChunkRemeshes;
+        std::vector<std::shared_ptr<Chunk const>> m_ChunkEdits;
+        // The lowest mesh version each chunk still accepts: that of its latest remesh, or of the
+        // last mesh published for it. Older meshes are stale and dropped.
+        std::unordered_map<ChunkPos, u64, ChunkPosHash> m_MeshVersions;
+        u64 m_NextRemeshVersion = 1;
+
+        // Meshes that arrived before their chunk, waiting for it.
+        std::vector<ChunkMeshData> m_EarlyChunkMeshes;
+
+        // Chunk events published this update, handed over in one batch at the end of it.
+        std::vector<ChunkEvent> m_PublishedChunkEvents;
+        u64 m_NextChunkEventSequence = 0;
+        // Chunk events not yet taken.
+        std::vector<ChunkEvent> m_ChunkEvents;
+        std::mutex m_ChunkEventMutex;
     };
 }
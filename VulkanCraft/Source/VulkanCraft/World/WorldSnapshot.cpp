@@ -0,0 +1,17 @@
+#include "WorldSnapshot.hpp"
+
+namespace vc
+{
+    Chunk const* WorldSnapshot::GetChunk(ChunkPos chunkPos) const noexcept
+    {
+        ivec3 offset = chunkPos - m_MinChunkPos;
+        if (glm::any(glm::lessThan(offset, ivec3(0))) or glm::any(glm::greaterThanEqual(offset, m_Size)))
+            return nullptr;
+        return m_Chunks[offset.x + (offset.y + offset.z * m_Size.y) * m_Size.x].get();
+    }
+
+    BlockID WorldSnapshot::GetBlock(ivec3 blockPos) const
+    {
+        return BlockQuery::GetBlock(GetChunkFunction(), blockPos);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "VulkanCraft/World/BlockQuery.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include <Engine.hpp>
+#include <memory>
+#include <optional>
+#include <vector>
+
+using namespace eng;
+
+namespace vc
+{
+    // Immutable copy of the chunks in a region of the world at one point in time.
+    // Chunks are never modified once they're in the world, so a snapshot only shares them,
+    // and can be queried from any thread while the world keeps changing.
+    class WorldSnapshot
+    {
+    public:
+        WorldSnapshot() = default;
+
+        // Returns the chunk at the given position, or nullptr if it wasn't loaded or is outside the snapshot.
+        ENG_NO_DISCARD Chunk const* GetChunk(ChunkPos chunkPos) const noexcept;
+
+        ENG_NO_DISCARD BlockID GetBlock(ivec3 blockPos) const;
+        // Hits the first block for which isHit(BlockID) returns true.
+        template <typename IsHit>
+        ENG_NO_DISCARD std::optional<RaycastHit> Raycast(vec3 origin, vec3 direction, f32 maxDistance, IsHit const& isHit) const
+        {
+            return BlockQuery::Raycast(GetChunkFunction(), origin, direction, maxDistance, isHit);
+        }
+        template <typename Callback>
+        void ForEachBlock(ivec3 minBlockPos, ivec3 maxBlockPos, Callback const& callback) const
+        {
+            BlockQuery::ForEachBlock(GetChunkFunction(), minBlockPos, maxBlockPos, callback);
+        }
+    private:
+        friend class World;
+
+        auto GetChunkFunction() const noexcept { return [this](ChunkPos chunkPos) { return GetChunk(chunkPos); }; }
+    private:
+        ChunkPos m_MinChunkPos{};
+        ivec3 m_Size{};
+        std::vector<std::shared_ptr<Chunk const>> m_Chunks;
+    };
+}
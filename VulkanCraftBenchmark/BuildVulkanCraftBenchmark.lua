@@ -0,0 +1,87 @@
+project "VulkanCraftBenchmark"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++23"
+    staticruntime "Off"
+
+    prebuildcommands "%{RunPreBuild}"
+    targetdir "%{TargetDir}"
+    objdir "%{OBJDir}"
+
+    defines {
+        "GLFW_INCLUDE_NONE",
+        "GLM_FORCE_DEPTH_ZERO_TO_ONE",
+    }
+
+    files {
+        "Source/**.h",
+        "Source/**.c",
+        "Source/**.hpp",
+        "Source/**.cpp",
+        "Source/**.inl",
+        "Source/**.ixx",
+
+        -- Build the chunk pipeline straight from the game's sources so the benchmark
+        -- always measures the same code. Nothing here may require a window or a device.
+        "../VulkanCraft/Source/VulkanCraft/World/**.hpp",
+        "../VulkanCraft/Source/VulkanCraft/World/**.cpp",
+        "../VulkanCraft/Source/VulkanCraft/Rendering/BlockModel.hpp",
+        "../VulkanCraft/Source/VulkanCraft/Rendering/ChunkDrawPacking.hpp",
+        "../VulkanCraft/Source/VulkanCraft/Rendering/ChunkDrawPacking.cpp",
+        "../VulkanCraft/Source/VulkanCraft/Rendering/ChunkMeshData.hpp",
+        "../VulkanCraft/Source/VulkanCraft/Rendering/MeshType.hpp",
+        "../VulkanCraft/Source/VulkanCraft/Rendering/TextureID.hpp",
+    }
+
+    includedirs {
+        "Source/",
+        "%{IncludeDirs.vulkancraft}",
+        "%{IncludeDirs.engine}",
+        "%{IncludeDirs.entt}",
+        "%{IncludeDirs.glm}",
+        "%{IncludeDirs.spdlog}",
+        "%{IncludeDirs.vulkan}", -- Only for headers; nothing from the Vulkan SDK is linked.
+    }
+
+    links {
+        "Engine",
+    }
+
+    filter "system:windows"
+        systemversion "latest"
+        usestandardpreprocessor "On"
+        defines "ENG_SYSTEM_WINDOWS"
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        optimize "Debug"
+        symbols "Full"
+
+        defines {
+            "ENG_CONFIG_DEBUG",
+            "ENG_ENABLE_CONSOLE",
+            "ENG_ENABLE_VERIFYS",
+            "ENG_ENABLE_ASSERTS",
+            "ENG_ENABLE_PROFILING",
+        }
+
+    filter "configurations:Release"
+        runtime "Release"
+        optimize "On"
+        symbols "On"
+
+        defines {
+            "ENG_CONFIG_RELEASE",
+            "ENG_ENABLE_CONSOLE",
+            "ENG_ENABLE_VERIFYS",
+            "ENG_ENABLE_PROFILING",
+        }
+
+    filter "configurations:Dist"
+        runtime "Release"
+        optimize "Full"
+        symbols "Off"
+
+        defines {
+            "ENG_CONFIG_DIST",
+        }
@@ -0,0 +1,100 @@
+#include "BenchmarkUtils.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#if ENG_SYSTEM_WINDOWS
+    #include <Windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+namespace vcb
+{
+    BenchmarkArguments::BenchmarkArguments(std::span<char* const> arguments)
+    {
+        for (u64 i = 0; i + 1 < arguments.size(); i++)
+        {
+            small_string_view name = arguments[i];
+            if (name.starts_with("--"))
+                m_Values[small_string(name.substr(2))] = arguments[++i];
+        }
+    }
+
+    bool BenchmarkArguments::Get(small_string_view name, u64& value) const
+    {
+        auto it = m_Values.find(small_string(name));
+        if (it == m_Values.end())
+            return false;
+
+        small_string const& text = it->second;
+        u64 parsed = 0;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+        if (error != std::errc() or end != text.data() + text.size())
+        {
+            ENG_LOG_ERROR("Invalid value \"{}\" for --{}, expected an unsigned integer.", text, name);
+            return false;
+        }
+
+        value = parsed;
+        return true;
+    }
+
+    bool BenchmarkArguments::Get(small_string_view name, small_string& value) const
+    {
+        auto it = m_Values.find(small_string(name));
+        if (it == m_Values.end())
+            return false;
+
+        value = it->second;
+        return true;
+    }
+
+    LatencySummary SummarizeLatencies(std::span<f64> samples)
+    {
+        if (samples.empty())
+            return {};
+
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [samples](f64 fraction)
+        {
+            u64 rank = u64(std::ceil(fraction * f64(samples.size())));
+            return samples[std::clamp<u64>(rank, 1, samples.size()) - 1];
+        };
+
+        return LatencySummary
+        {
+            .Count = samples.size(),
+            .Mean = std::accumulate(samples.begin(), samples.end(), 0.0) / f64(samples.size()),
+            .P50 = percentile(0.50),
+            .P90 = percentile(0.90),
+            .P99 = percentile(0.99),
+            .Max = samples.back(),
+        };
+    }
+
+    void AppendLatencySummaryJson(string& json, LatencySummary const& summary)
+    {
+        fmt::format_to(std::back_inserter(json),
+            "{{\"count\": {}, \"mean_us\": {:.3f}, \"p50_us\": {:.3f}, \"p90_us\": {:.3f}, \"p99_us\": {:.3f}, \"max_us\": {:.3f}}}",
+            summary.Count, summary.Mean * 1e6, summary.P50 * 1e6, summary.P90 * 1e6, summary.P99 * 1e6, summary.Max * 1e6
+        );
+    }
+
+    u64 GetPeakResidentSetSize()
+    {
+#if ENG_SYSTEM_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.PeakWorkingSetSize;
+        return 0;
+#else
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+            return u64(usage.ru_maxrss) * 1024; // Reported in kilobytes.
+        return 0;
+#endif
+    }
+}
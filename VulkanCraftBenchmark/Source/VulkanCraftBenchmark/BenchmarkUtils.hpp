@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Engine.hpp>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace eng;
+
+namespace vcb
+{
+    // Parses "--name value" pairs from the command line.
+    class BenchmarkArguments
+    {
+    public:
+        BenchmarkArguments(std::span<char* const> arguments);
+
+        // Returns if the argument was given, in which case value is set.
+        // Logs and returns false if the argument was given but isn't a valid integer.
+        bool Get(small_string_view name, u64& value) const;
+        bool Get(small_string_view name, small_string& value) const;
+    private:
+        std::unordered_map<small_string, small_string> m_Values;
+    };
+
+    // Summary of a set of latency samples, in seconds.
+    struct LatencySummary
+    {
+        u64 Count = 0;
+        f64 Mean = 0.0;
+        f64 P50 = 0.0;
+        f64 P90 = 0.0;
+        f64 P99 = 0.0;
+        f64 Max = 0.0;
+    };
+
+    // Sorts the samples in place to find the percentiles (nearest rank).
+    LatencySummary SummarizeLatencies(std::span<f64> samples);
+
+    // Appends the summary to the json as an object, in microseconds.
+    void AppendLatencySummaryJson(string& json, LatencySummary const& summary);
+
+    // Returns the peak resident set size of this process in bytes, or 0 if it can't be queried.
+    u64 GetPeakResidentSetSize();
+}
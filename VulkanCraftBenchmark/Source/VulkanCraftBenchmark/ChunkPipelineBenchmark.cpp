@@ -0,0 +1,128 @@
+#include "ChunkPipelineBenchmark.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkGenerator.hpp"
+#include "VulkanCraft/World/DefaultBlocks.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+namespace vcb
+{
+    bool RunChunkPipelineBenchmark(BenchmarkArguments const& arguments, string& json)
+    {
+        using namespace vc;
+        using Clock = std::chrono::steady_clock;
+
+        u64 radius = 8;
+        u64 workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+        u64 batchSize = 16;
+        u64 seed = 0;
+        u64 timeout = 600;
+        arguments.Get("radius", radius);
+        arguments.Get("workers", workerCount);
+        arguments.Get("batch", batchSize);
+        arguments.Get("seed", seed);
+        arguments.Get("timeout", timeout);
+        radius = std::clamp<u64>(radius, 1, 64);
+        workerCount = std::clamp<u64>(workerCount, 1, 255);
+        batchSize = std::clamp<u64>(batchSize, 1, 255);
+
+        BlockRegistry blocks;
+        RegisterDefaultBlocks(blocks);
+
+        // Collect every stage's latency from the worker threads.
+        std::array<std::vector<f64>, ChunkGenerationStage::_Count> stageLatencies;
+        std::mutex stageLatencyMutex;
+        auto stageTimingCallback = [&](ChunkPos, ChunkGenerationStage stage, f64 seconds)
+        {
+            std::unique_lock lock(stageLatencyMutex);
+            stageLatencies[stage.Index()].push_back(seconds);
+        };
+
+        std::vector<ChunkPos> chunksToLoad;
+        {
+            i32 r = i32(radius);
+            chunksToLoad.reserve(u64(2 * r) * u64(2 * r) * u64(2 * r));
+            for (i32 z = -r; z < r; z++)
+                for (i32 y = -r; y < r; y++)
+                    for (i32 x = -r; x < r; x++)
+                        chunksToLoad.emplace_back(x, y, z);
+        }
+        u64 chunkCount = chunksToLoad.size();
+
+        ENG_LOG_INFO("Generating {} chunks with {} workers in batches of up to {}.", chunkCount, workerCount, batchSize);
+
+        // Hold onto the chunks like the world would, so peak memory is representative.
+        std::vector<std::shared_ptr<Chunk>> generatedChunks;
+        generatedChunks.reserve(chunkCount);
+        std::vector<f64> meshCompletionTimes;
+        meshCompletionTimes.reserve(chunkCount);
+        u64 quadCount = 0;
+
+        Clock::time_point startTime, endTime;
+        {
+            ChunkGenerator chunkGenerator(blocks, seed, u8(workerCount), stageTimingCallback, nullptr, u8(batchSize));
+
+            startTime = Clock::now();
+            Clock::time_point deadline = startTime + std::chrono::seconds(timeout);
+            chunkGenerator.QueueChunkLoads(chunksToLoad);
+
+            while (meshCompletionTimes.size() < chunkCount and Clock::now() < deadline)
+            {
+                chunkGenerator.ConsumeGeneratedChunks([&](std::shared_ptr<Chunk>&& chunk)
+                {
+                    generatedChunks.push_back(std::move(chunk));
+                });
+                chunkGenerator.ConsumeGeneratedChunkMeshes([&](ChunkMeshData&& chunkMeshData)
+                {
+                    // Every chunk is queued at the start, so this is when each mesh was done, not a per-chunk latency.
+                    std::chrono::duration<f64> completionTime = Clock::now() - startTime;
+                    meshCompletionTimes.push_back(completionTime.count());
+                    // Only the full detail quads, the other levels of detail repeat the same surfaces.
+                    for (RenderLayer layer : RenderLayers)
+                        for (MeshType type : MeshTypes)
+                            quadCount += chunkMeshData.GetQuads(type, 0, layer).size();
+                });
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            endTime = Clock::now();
+        }
+
+        bool finished = meshCompletionTimes.size() == chunkCount;
+        if (not finished)
+            ENG_LOG_ERROR("Timed out after {}s with {}/{} chunk meshes.", timeout, meshCompletionTimes.size(), chunkCount);
+
+        f64 seconds = std::chrono::duration<f64>(endTime - startTime).count();
+
+        auto out = std::back_inserter(json);
+        fmt::format_to(out, "{{\n");
+        fmt::format_to(out, "  \"benchmark\": \"pipeline\",\n");
+        fmt::format_to(out, "  \"radius\": {},\n", radius);
+        fmt::format_to(out, "  \"workers\": {},\n", workerCount);
+        fmt::format_to(out, "  \"batch\": {},\n", batchSize);
+        fmt::format_to(out, "  \"seed\": {},\n", seed);
+        fmt::format_to(out, "  \"finished\": {},\n", finished);
+        fmt::format_to(out, "  \"chunks_requested\": {},\n", chunkCount);
+        fmt::format_to(out, "  \"chunks_generated\": {},\n", generatedChunks.size());
+        fmt::format_to(out, "  \"meshes_generated\": {},\n", meshCompletionTimes.size());
+        fmt::format_to(out, "  \"quads\": {},\n", quadCount);
+        fmt::format_to(out, "  \"seconds\": {:.6f},\n", seconds);
+        fmt::format_to(out, "  \"chunks_per_second\": {:.3f},\n", f64(generatedChunks.size()) / seconds);
+        fmt::format_to(out, "  \"quads_per_second\": {:.3f},\n", f64(quadCount) / seconds);
+        fmt::format_to(out, "  \"peak_rss_bytes\": {},\n", GetPeakResidentSetSize());
+        fmt::format_to(out, "  \"mesh_completion_time\": ");
+        AppendLatencySummaryJson(json, SummarizeLatencies(meshCompletionTimes));
+        fmt::format_to(out, ",\n  \"stages\": {{\n");
+        for (ChunkGenerationStage stage : ChunkGenerationStages)
+        {
+            fmt::format_to(out, "    \"{}\": ", stage.Name());
+            AppendLatencySummaryJson(json, SummarizeLatencies(stageLatencies[stage.Index()]));
+            fmt::format_to(out, "{}\n", stage.Index() + 1 < ChunkGenerationStage::_Count ? "," : "");
+        }
+        fmt::format_to(out, "  }}\n}}\n");
+
+        return finished;
+    }
+}
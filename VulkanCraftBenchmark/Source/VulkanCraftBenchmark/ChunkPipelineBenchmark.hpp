@@ -0,0 +1,18 @@
+#pragma once
+
+#include "VulkanCraftBenchmark/BenchmarkUtils.hpp"
+
+namespace vcb
+{
+    // Drives ChunkGenerator over a cube of chunks without a window or a device and
+    // appends per-stage latency percentiles, throughput, and peak memory to the json.
+    // Returns false if the pipeline didn't finish before the timeout.
+    //
+    // Arguments:
+    //  --radius <chunks>   Loads chunks in [-radius, radius) on every axis (default 8).
+    //  --workers <count>   Worker thread count (default hardware concurrency).
+    //  --batch <count>     Most chunk stages a worker generates at once (default 16).
+    //  --seed <seed>       World seed (default 0).
+    //  --timeout <seconds> Gives up after this long (default 600).
+    bool RunChunkPipelineBenchmark(BenchmarkArguments const& arguments, string& json);
+}
@@ -0,0 +1,294 @@
+#include "KernelBenchmark.hpp"
+#include "VulkanCraft/Rendering/ChunkDrawPacking.hpp"
+#include "VulkanCraft/World/Chunk.hpp"
+#include "VulkanCraft/World/ChunkCodec.hpp"
+#include "VulkanCraft/World/ChunkMesher.hpp"
+#include "VulkanCraft/World/DefaultBlocks.hpp"
+#include "VulkanCraft/World/TerrainNoise.hpp"
+#include <glm/gtc/noise.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iterator>
+
+namespace vcb
+{
+    using namespace vc;
+    using Clock = std::chrono::steady_clock;
+
+    namespace
+    {
+        struct Pattern
+        {
+            string_view Name;
+            // Returns the block at the local block position.
+            std::function<BlockID(BlockRegistry const& blocks, ivec3 blockPos)> GetBlock;
+        };
+
+        BlockStateRegistry CreatePattern(BlockRegistry const& blocks, Pattern const& pattern)
+        {
+            BlockStateRegistry blockStates;
+            // IMPORTANT: always create blockstates in z->y->x index order.
+            for (u16 i = 0; i < Chunk::Size3; i++)
+            {
+                ivec3 blockPos = ivec3{i, i >> 4, i >> 8} & i32(Chunk::Size - 1);
+                blockStates.CreateBlockState(pattern.GetBlock(blocks, blockPos));
+            }
+            return blockStates;
+        }
+
+        f64 ElapsedNanoseconds(Clock::time_point start, Clock::time_point end)
+        {
+            return std::chrono::duration<f64, std::nano>(end - start).count();
+        }
+    }
+
+    void RunKernelBenchmark(BenchmarkArguments const& arguments, string& json)
+    {
+        u64 iterations = 1000;
+        u64 regionCount = 24576; // Six submeshes for each chunk in a radius 8 cube.
+        u64 seed = 0;
+        arguments.Get("iterations", iterations);
+        arguments.Get("regions", regionCount);
+        arguments.Get("seed", seed);
+        iterations = std::max<u64>(iterations, 1);
+
+        BlockRegistry blocks;
+        RegisterDefaultBlocks(blocks);
+
+        auto patterns = std::to_array<Pattern>({
+            {"empty", [](BlockRegistry const& blocks, ivec3)
+            {
+                return blocks.GetBlock("minecraft:air");
+            }},
+            {"full", [](BlockRegistry const& blocks, ivec3)
+            {
+                return blocks.GetBlock("minecraft:stone");
+            }},
+            // Worst case: every face is visible and no two neighbouring faces can merge.
+            {"checkerboard", [](BlockRegistry const& blocks, ivec3 blockPos)
+            {
+                static constexpr auto s_BlockNames = std::to_array<small_string_view>({
+                    "minecraft:stone", "minecraft:dirt", "minecraft:grass", "minecraft:cobblestone",
+                });
+                i32 xyz = blockPos.x + blockPos.y + blockPos.z;
+                if ((xyz & 1) != 0)
+                    return blocks.GetBlock("minecraft:air");
+                return blocks.GetBlock(s_BlockNames[(xyz >> 1) & 3]);
+            }},
+            // Rolling hills with a layer of dirt and grass.
+            {"terrain", [](BlockRegistry const& blocks, ivec3 blockPos)
+            {
+                f32 height = 8.0f + 6.0f * glm::simplex(vec2(blockPos.x, blockPos.z) / 24.0f);
+                f32 depth = height - f32(blockPos.y);
+                if (depth < 0.0f)
+                    return blocks.GetBlock("minecraft:air");
+                if (depth < 1.0f)
+                    return blocks.GetBlock("minecraft:grass");
+                if (depth < 4.0f)
+                    return blocks.GetBlock("minecraft:dirt");
+                return blocks.GetBlock("minecraft:stone");
+            }},
+            // Solid stone carved out by 3d noise.
+            {"caves", [](BlockRegistry const& blocks, ivec3 blockPos)
+            {
+                if (glm::simplex(vec3(blockPos) / 8.0f) > 0.3f)
+                    return blocks.GetBlock("minecraft:air");
+                return blocks.GetBlock("minecraft:stone");
+            }},
+        });
+
+        auto out = std::back_inserter(json);
+        fmt::format_to(out, "{{\n");
+        fmt::format_to(out, "  \"benchmark\": \"kernels\",\n");
+        fmt::format_to(out, "  \"iterations\": {},\n", iterations);
+        fmt::format_to(out, "  \"patterns\": {{\n");
+
+        for (u64 patternIndex = 0; patternIndex < patterns.size(); patternIndex++)
+        {
+            Pattern const& pattern = patterns[patternIndex];
+            BlockStateRegistry blockStates = CreatePattern(blocks, pattern);
+            // Surround the chunk with copies of itself so the edges are realistic.
+            ChunkMesher::Neighbours neighbours;
+            neighbours.fill(&blockStates);
+
+            f64 faceMaskTime = 0.0;
+            f64 edgeTime = 0.0;
+            f64 cullTime = 0.0;
+            f64 planeTime = 0.0;
+            f64 mergeTime = 0.0;
+            f64 packTime = 0.0;
+            u64 quadCount = 0;
+            u64 checksum = 0;
+
+            // The patterns are all opaque, so only the first render layer's masks are meshed.
+            std::vector<u32> faceSolidMasks(ChunkMesher::LayerFaceMaskCount);
+            auto opaqueMasks = std::span(faceSolidMasks).first(ChunkMesher::FaceMaskCount);
+            ChunkMesher::GreedyMeshingPlanes greedyMeshingPlanes;
+            std::vector<std::pair<TextureID, ChunkMesher::GreedyQuad>> quads;
+            std::vector<uvec2> packedQuads;
+            quads.reserve(Chunk::Size3 * ChunkMesher::FaceCount);
+            packedQuads.reserve(Chunk::Size3 * ChunkMesher::FaceCount);
+
+            for (u64 i = 0; i < iterations; i++)
+            {
+                std::ranges::fill(faceSolidMasks, 0);
+                greedyMeshingPlanes.clear();
+                quads.clear();
+                packedQuads.clear();
+
+                Clock::time_point t0 = Clock::now();
+                ChunkMesher::BuildFaceMasks(blocks, blockStates, faceSolidMasks);
+                Clock::time_point t1 = Clock::now();
+                ChunkMesher::InsertChunkEdges(blocks, neighbours, opaqueMasks);
+                Clock::time_point t2 = Clock::now();
+                ChunkMesher::CullFaces(opaqueMasks);
+                Clock::time_point t3 = Clock::now();
+                ChunkMesher::BuildGreedyMeshingPlanes(blocks, blockStates, opaqueMasks, greedyMeshingPlanes);
+                Clock::time_point t4 = Clock::now();
+                ChunkMesher::GreedyMerge(greedyMeshingPlanes, [&quads](u8, TextureID textureID, ChunkMesher::GreedyQuad quad)
+                {
+                    quads.emplace_back(textureID, quad);
+                });
+                Clock::time_point t5 = Clock::now();
+                for (auto& [textureID, quad] : quads)
+                    packedQuads.push_back(ChunkMesher::PackQuad(textureID, quad));
+                Clock::time_point t6 = Clock::now();
+
+                faceMaskTime += ElapsedNanoseconds(t0, t1);
+                edgeTime += ElapsedNanoseconds(t1, t2);
+                cullTime += ElapsedNanoseconds(t2, t3);
+                planeTime += ElapsedNanoseconds(t3, t4);
+                mergeTime += ElapsedNanoseconds(t4, t5);
+                packTime += ElapsedNanoseconds(t5, t6);
+                quadCount = packedQuads.size();
+                for (uvec2 packedQuad : packedQuads)
+                    checksum += packedQuad.x ^ packedQuad.y;
+            }
+
+            // The whole mesher including its allocations, as the worker threads run it.
+            f64 totalTime = 0.0;
+            {
+                Clock::time_point start = Clock::now();
+                for (u64 i = 0; i < iterations; i++)
+                {
+                    ChunkMeshData chunkMeshData = ChunkMesher::GenerateMesh(blocks, {}, blockStates, neighbours);
+                    checksum += chunkMeshData.GetQuads(MeshType::Top).size();
+                }
+                totalTime = ElapsedNanoseconds(start, Clock::now());
+            }
+
+            // Chunk compression, with throughput in MB of palette indices.
+            f64 encodeTime = 0.0;
+            f64 decodeTime = 0.0;
+            u64 compressedSize = 0;
+            bool decoded = true;
+            {
+                PalettedBlocks blocks;
+                blocks.Assign(blockStates);
+                PalettedBlocks decodedBlocks;
+                decodedBlocks.Palette = blocks.Palette;
+                std::vector<u8> bytes;
+
+                Clock::time_point start = Clock::now();
+                for (u64 i = 0; i < iterations; i++)
+                {
+                    bytes.clear();
+                    ChunkCodec::Encode(blocks, bytes);
+                }
+                encodeTime = ElapsedNanoseconds(start, Clock::now());
+
+                start = Clock::now();
+                for (u64 i = 0; i < iterations; i++)
+                    decoded &= ChunkCodec::Decode(bytes, decodedBlocks);
+                decodeTime = ElapsedNanoseconds(start, Clock::now());
+
+                compressedSize = bytes.size();
+                decoded &= decodedBlocks.Indices == blocks.Indices;
+            }
+            f64 uncompressedSize = f64(sizeof(PalettedBlocks::Indices));
+
+            f64 n = f64(iterations);
+            fmt::format_to(out, "    \"{}\": {{\n", pattern.Name);
+            fmt::format_to(out, "      \"quads\": {},\n", quadCount);
+            fmt::format_to(out, "      \"face_masks_ns_per_chunk\": {:.1f},\n", faceMaskTime / n);
+            fmt::format_to(out, "      \"chunk_edges_ns_per_chunk\": {:.1f},\n", edgeTime / n);
+            fmt::format_to(out, "      \"face_culling_ns_per_chunk\": {:.1f},\n", cullTime / n);
+            fmt::format_to(out, "      \"greedy_planes_ns_per_chunk\": {:.1f},\n", planeTime / n);
+            fmt::format_to(out, "      \"greedy_merge_ns_per_chunk\": {:.1f},\n", mergeTime / n);
+            fmt::format_to(out, "      \"pack_quads_ns_per_chunk\": {:.1f},\n", packTime / n);
+            fmt::format_to(out, "      \"generate_mesh_ns_per_chunk\": {:.1f},\n", totalTime / n);
+            fmt::format_to(out, "      \"compressed_bytes\": {},\n", compressedSize);
+            fmt::format_to(out, "      \"compression_ratio\": {:.1f},\n", uncompressedSize / f64(std::max<u64>(compressedSize, 1)));
+            fmt::format_to(out, "      \"encode_mb_per_s\": {:.1f},\n", uncompressedSize * n / encodeTime * 1e3);
+            fmt::format_to(out, "      \"decode_mb_per_s\": {:.1f},\n", uncompressedSize * n / decodeTime * 1e3);
+            fmt::format_to(out, "      \"decode_matches\": {},\n", decoded);
+            fmt::format_to(out, "      \"checksum\": {}\n", checksum);
+            fmt::format_to(out, "    }}{}\n", patternIndex + 1 < patterns.size() ? "," : "");
+        }
+        fmt::format_to(out, "  }},\n");
+
+        // Terrain densities, over a column of chunks through the surface so both solid and empty chunks are timed.
+        {
+            TerrainNoise terrainNoise(seed);
+            TerrainNoise::Densities densities;
+            u64 solidCount = 0;
+
+            Clock::time_point start = Clock::now();
+            for (u64 i = 0; i < iterations; i++)
+            {
+                terrainNoise.GenerateDensities({i32(i % 7), i32(i % 8) - 2, i32(i % 5)}, densities);
+                solidCount += std::ranges::count_if(densities, [](f32 density) { return density > 0.0f; });
+            }
+            f64 time = ElapsedNanoseconds(start, Clock::now());
+
+            fmt::format_to(out, "  \"terrain_noise\": {{\n");
+            fmt::format_to(out, "    \"seed\": {},\n", seed);
+            fmt::format_to(out, "    \"ns_per_chunk\": {:.1f},\n", time / f64(iterations));
+            fmt::format_to(out, "    \"solid_fraction\": {:.3f}\n", f64(solidCount) / (f64(iterations) * Chunk::Size3));
+            fmt::format_to(out, "  }},\n");
+        }
+
+        // Draw data packing, over regions laid out like a loaded cube of chunks.
+        {
+            std::vector<ChunkSubmeshRegion> regions;
+            regions.reserve(regionCount);
+            for (u32 i = 0; i < regionCount; i++)
+            {
+                u32 chunkIndex = i / MeshType::_Count;
+                ChunkPos chunkPos = ivec3(i32(chunkIndex), i32(chunkIndex >> 4), i32(chunkIndex >> 8)) & 15;
+                regions.push_back({
+                    .ChunkPos = chunkPos - 8,
+                    .FirstInstance = i * 64,
+                    .InstanceCount = 64,
+                    .Type = MeshType(MeshType::_Begin + i % MeshType::_Count),
+                });
+            }
+
+            std::vector<uvec2> storageData(regionCount);
+            std::vector<VkDrawIndirectCommand> indirectData(regionCount);
+
+            Clock::time_point t0 = Clock::now();
+            for (u64 i = 0; i < iterations; i++)
+                ChunkDrawPacking::PackStorageData(regions, storageData);
+            Clock::time_point t1 = Clock::now();
+            for (u64 i = 0; i < iterations; i++)
+                ChunkDrawPacking::PackIndirectData(regions, indirectData);
+            Clock::time_point t2 = Clock::now();
+
+            u64 checksum = 0;
+            for (u64 i = 0; i < regionCount; i++)
+                checksum += storageData[i].x ^ storageData[i].y ^ indirectData[i].firstInstance;
+
+            f64 n = f64(iterations) * f64(std::max<u64>(regionCount, 1));
+            fmt::format_to(out, "  \"draw_packing\": {{\n");
+            fmt::format_to(out, "    \"regions\": {},\n", regionCount);
+            fmt::format_to(out, "    \"storage_ns_per_region\": {:.2f},\n", ElapsedNanoseconds(t0, t1) / n);
+            fmt::format_to(out, "    \"indirect_ns_per_region\": {:.2f},\n", ElapsedNanoseconds(t1, t2) / n);
+            fmt::format_to(out, "    \"checksum\": {}\n", checksum);
+            fmt::format_to(out, "  }}\n");
+        }
+
+        fmt::format_to(out, "}}\n");
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "VulkanCraftBenchmark/BenchmarkUtils.hpp"
+
+namespace vcb
+{
+    // Times each ChunkMesher kernel and WorldRenderer's draw data packing in isolation
+    // on synthetic chunks, and appends ns/chunk and quads emitted per pattern to the json,
+    // along with ChunkCodec's compression ratio and MB/s per pattern, and TerrainNoise's ns/chunk.
+    //
+    // Arguments:
+    //  --iterations <count> Times each kernel runs per pattern (default 1000).
+    //  --regions <count>    Submesh regions to pack draw data for (default 24576).
+    //  --seed <seed>        Terrain seed (default 0).
+    void RunKernelBenchmark(BenchmarkArguments const& arguments, string& json);
+}
@@ -0,0 +1,57 @@
+#include "VulkanCraftBenchmark/BenchmarkUtils.hpp"
+#include "VulkanCraftBenchmark/ChunkPipelineBenchmark.hpp"
+#include "VulkanCraftBenchmark/KernelBenchmark.hpp"
+
+// Headless benchmarks for the chunk pipeline; needs neither a window nor a device.
+//
+// Usage: VulkanCraftBenchmark [--benchmark pipeline|kernels] [--output <file>] [--trace <file>] [benchmark arguments...]
+// Results are written as json to the output file, or stdout if none is given.
+// If profiling is enabled, --trace also writes a Chrome trace of the run.
+int main(int argc, char** argv)
+{
+    using namespace vcb;
+
+    // Keep the log quiet so it neither skews the results nor clutters the json on stdout.
+    LogInfo logInfo
+    {
+        .EngineLoggingLevel = spdlog::level::warn,
+        .ClientLoggingLevel = spdlog::level::warn,
+        .LogFileName = "VulkanCraftBenchmark.log",
+    };
+    LogScope logScope(logInfo);
+
+    BenchmarkArguments arguments(std::span(argv, argc).subspan(1));
+
+    small_string benchmark = "pipeline";
+    arguments.Get("benchmark", benchmark);
+
+    string json;
+    bool succeeded = true;
+    if (benchmark == "pipeline")
+        succeeded = RunChunkPipelineBenchmark(arguments, json);
+    else if (benchmark == "kernels")
+        RunKernelBenchmark(arguments, json);
+    else
+    {
+        ENG_LOG_ERROR("Unknown benchmark \"{}\", expected pipeline or kernels.", benchmark);
+        return 1;
+    }
+
+#if ENG_ENABLE_PROFILING
+    if (small_string trace; arguments.Get("trace", trace))
+        Profiler::WriteChromeTrace(trace);
+#endif
+
+    if (small_string output; arguments.Get("output", output))
+    {
+        if (not WriteFile(output, json))
+        {
+            ENG_LOG_ERROR("Failed to write results to \"{}\".", output);
+            return 1;
+        }
+    }
+    else
+        fmt::print("{}", json);
+
+    return succeeded ? 0 : 1;
+}